@@ -44,11 +44,50 @@
 #include <fstream>
 #include <algorithm>
 #include <vector>
-#include <deque>
+#include <iterator>
+#include <map>
 #include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <exception>
+#if !defined(WITHOUT_SRECORD_THREADS)
+#include <thread>
+#include <atomic>
+#endif
 #if(__cplusplus >= 201700L)
 #include <optional>
-#include <cstdint>
+#include <string_view>
+#if defined(__has_include)
+  #if __has_include(<memory_resource>)
+    #include <memory_resource>
+    #define SRECORD_WITH_PMR
+  #endif
+#endif
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SRECORD_WITH_MMAP
+#endif
+#if !defined(WITHOUT_SRECORD_SIMD)
+  #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #include <emmintrin.h>
+    #define SRECORD_WITH_SSE2
+  #elif defined(__aarch64__) && defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define SRECORD_WITH_NEON
+  #endif
+  #if defined(__SSE4_2__)
+    #include <nmmintrin.h>
+    #define SRECORD_WITH_SSE42
+  #elif defined(__ARM_FEATURE_CRC32)
+    #include <arm_acle.h>
+    #define SRECORD_WITH_ARM_CRC32
+  #endif
 #endif
 
 #ifdef WITH_SRECORD_DEBUG
@@ -58,6 +97,17 @@
   #define SRECORD_DEBUG(X)
 #endif
 
+#ifdef WITH_SRECORD_STATISTICS
+  #include <chrono>
+  #define SRECORD_STATISTICS(...) { __VA_ARGS__; }
+  #define SRECORD_STATISTICS_TIMER(NS) const statistics_timer srecord_statistics_timer_(NS)
+  #define SRECORD_STATISTICS_BLOCKS(REC, ADDED) const block_statistics srecord_block_statistics_(REC, ADDED)
+#else
+  #define SRECORD_STATISTICS(...)
+  #define SRECORD_STATISTICS_TIMER(NS)
+  #define SRECORD_STATISTICS_BLOCKS(REC, ADDED)
+#endif
+
 namespace sw { namespace detail {
 
 template <typename ValueType, typename RandomAccessValueContainerType=std::vector<ValueType> >
@@ -78,6 +128,14 @@ public:
    */
   using data_type = RandomAccessValueContainerType;
 
+  /**
+   * Allocator of the data containers, rebound for the block
+   * container. Blocks and temporary containers of an instance
+   * are allocated with the allocator of the instance, e.g. a
+   * `std::pmr` memory resource (see `sw::pmr::srecord`).
+   */
+  using allocator_type = typename data_type::allocator_type;
+
   /**
    * Type for sizes.
    */
@@ -126,6 +184,13 @@ public:
     e_validate_blocks_unordered,
     e_validate_overlapping_blocks,
     e_load_open_failed,
+    e_compose_buffer_too_small,
+    e_snapshot_write_failed,
+    e_snapshot_invalid,
+    e_parse_line_not_starting_with_colon,
+    e_parse_missing_eof,
+    e_binary_write_failed,
+    e_load_failed,
   } error_type;
 
   /**
@@ -138,12 +203,78 @@ public:
   {
   public:
 
+    /**
+     * Allocator of the block data (enables allocator propagation
+     * from the block container).
+     */
+    using allocator_type = typename data_type::allocator_type;
+
     /**
      * c'tor
      */
     explicit block_type() : address_(0), bytes_()
     { }
 
+    /**
+     * c'tor
+     */
+    explicit block_type(const allocator_type& alloc) : address_(0), bytes_(alloc)
+    { }
+
+    /**
+     * c'tor
+     */
+    explicit block_type(address_type adr, const allocator_type& alloc) : address_(adr), bytes_(alloc)
+    { }
+
+    /**
+     * c'tor
+     */
+    explicit block_type(address_type adr, const data_type& data, const allocator_type& alloc) : address_(adr), bytes_(data, alloc)
+    { }
+
+    /**
+     * c'tor (allocator extended copy)
+     */
+    block_type(const block_type& blk, const allocator_type& alloc) : address_(blk.address_), bytes_(blk.bytes_, alloc)
+    { }
+
+    /**
+     * c'tor (allocator extended move)
+     */
+    block_type(block_type&& blk, const allocator_type& alloc) : address_(blk.address_), bytes_(std::move(blk.bytes_), alloc)
+    { blk.digests_valid_ = 0; }
+
+    /**
+     * c'tor (copy)
+     */
+    block_type(const block_type&) = default;
+
+    /**
+     * c'tor (move), the moved-from block has no cached digests.
+     */
+    block_type(block_type&& blk) noexcept(std::is_nothrow_move_constructible<data_type>::value)
+      : address_(blk.address_), bytes_(std::move(blk.bytes_)), digests_valid_(blk.digests_valid_)
+    { std::copy(blk.digests_, blk.digests_+digest_count, digests_); blk.digests_valid_ = 0; }
+
+    /**
+     * Assignment (copy)
+     */
+    block_type& operator=(const block_type&) = default;
+
+    /**
+     * Assignment (move), the moved-from block has no cached digests.
+     */
+    block_type& operator=(block_type&& blk) noexcept(std::is_nothrow_move_assignable<data_type>::value)
+    {
+      address_ = blk.address_;
+      bytes_ = std::move(blk.bytes_);
+      std::copy(blk.digests_, blk.digests_+digest_count, digests_);
+      digests_valid_ = blk.digests_valid_;
+      blk.digests_valid_ = 0;
+      return *this;
+    }
+
     /**
      * c'tor
      */
@@ -213,25 +344,55 @@ public:
     /**
      * Returns a r/a reference to the block byte data.
      * If this block changes, the size changes implicitly,
-     * too.
+     * too. Invalidates the cached digests of the block.
      * @return data_type&
      */
     inline data_type& bytes()
-    { return bytes_; }
+    { digests_valid_ = 0; return bytes_; }
 
     /**
      * Sets new data. Implicitly changes the size().
      * @param const data_type& dat
      */
     inline void bytes(const data_type& dat)
-    { bytes_ = dat; }
+    { digests_valid_ = 0; bytes_ = dat; }
 
     /**
      * Sets new data (rvalue). Implicitly changes the size().
      * @param data_type&& dat
      */
     inline void bytes(data_type&& dat)
-    { bytes_ = dat; }
+    { digests_valid_ = 0; bytes_ = std::move(dat); }
+
+    /**
+     * Returns true and sets `digest` if a digest of the block data
+     * with the given index (see `crc32()`, `crc32c()` and `hash64()`
+     * of the record) is cached. Non-const access to the block data
+     * invalidates cached digests. As a retained `bytes()` reference
+     * can modify the data anytime, the record does not use cached
+     * digests after its mutable `blocks()` was called.
+     * @param unsigned index
+     * @param std::uint64_t& digest
+     * @return bool
+     */
+    inline bool cached_digest(unsigned index, std::uint64_t& digest) const noexcept
+    {
+      if((index >= digest_count) || !(digests_valid_ & (1u << index))) return false;
+      digest = digests_[index];
+      return true;
+    }
+
+    /**
+     * Caches a digest of the current block data.
+     * @param unsigned index
+     * @param std::uint64_t digest
+     */
+    inline void cache_digest(unsigned index, std::uint64_t digest) const noexcept
+    {
+      if(index >= digest_count) return;
+      digests_[index] = digest;
+      digests_valid_ |= (unsigned char)(1u << index);
+    }
 
   public:
 
@@ -264,10 +425,18 @@ public:
      */
     inline void swap(block_type& blk)
     {
+      std::swap(digests_, blk.digests_);
+      std::swap(digests_valid_, blk.digests_valid_);
       address_type a = blk.sadr();
       blk.sadr(sadr());
       sadr(a);
-      bytes_.swap(blk.bytes_);
+      if(bytes_.get_allocator() == blk.bytes_.get_allocator()) {
+        bytes_.swap(blk.bytes_);
+      } else {
+        data_type tmp(std::move(bytes_));
+        bytes_ = std::move(blk.bytes_);
+        blk.bytes_ = std::move(tmp);
+      }
     }
 
     /**
@@ -275,7 +444,7 @@ public:
      * @return voir
      */
     inline void clear()
-    { data_type().swap(bytes_); }
+    { digests_valid_ = 0; data_type(bytes_.get_allocator()).swap(bytes_); }
 
   public:
 
@@ -299,7 +468,7 @@ public:
      */
     inline block_type get_range(address_type start_address, address_type end_address) const
     {
-      block_type ret;
+      block_type ret(bytes_.get_allocator());
       if(start_address >= end_address) return ret;
       if(start_address < sadr()) start_address = sadr();
       ret.sadr(start_address);
@@ -307,8 +476,7 @@ public:
       if(start_address >= end_address) return ret;
       start_address -= sadr();
       end_address -= sadr();
-      ret.bytes().reserve(end_address);
-      while(start_address < end_address) ret.bytes().push_back(bytes_[start_address++]);
+      ret.bytes().assign(bytes_.begin() + size_type(start_address), bytes_.begin() + size_type(end_address));
       return ret;
     }
 
@@ -318,7 +486,7 @@ public:
      * @param address_type start_address
      * @param address_type end_address
      */
-    inline bool in_range(address_type start_address, address_type end_address)
+    inline bool in_range(address_type start_address, address_type end_address) const noexcept
     { return (end_address >= start_address) && (!(start_address >= eadr() || end_address <= sadr())); }
 
   public:
@@ -331,70 +499,478 @@ public:
      */
     void dump(std::ostream& os, unsigned align=16) const
     {
-      align &= (~0x0001);
+      align &= (~0x0001u);
       if(align < 4) align = 4;
-      address_type adr = sadr();
       if(!bytes_.size()) {
         os << "(empty block)";
         return;
       }
-      address_type prefix = adr % align;
-      if(!prefix) {
-        os << "<" << numtohex(adr, 4) << "> ";
-      } else {
-        address_type eadr = adr;
-        adr -= prefix;
-        prefix = adr;
-        os << "<" << numtohex(adr, 4) << "> ";
-        while(adr < eadr) {
-          os << "  ";
-          if(!(adr & 0x01) && (adr != prefix)) os << ' ';
-          ++adr;
-        }
-        if(!(adr & 0x01) && (adr != prefix)) os << ' ';
-      }
-      for(auto b: bytes_) {
-        os << numtohex(b, 1);
-        ++adr;
-        if(!(adr & 0x01)) os << ' ';
-        if(!(adr % align)) {
-          if(adr != eadr()) {
-            os << std::endl << "<" << numtohex(adr, 4) << "> ";
-          }
-        }
+      {
+        output_buffer out(os);
+        dump_lines(out, sadr(), bytes_.begin(), bytes_.end(), align, 0, false);
       }
-      os << std::endl;
+      os.flush();
     }
 
   private:
 
+    static constexpr unsigned digest_count = 3;
+
     address_type address_;    ///< The start address.
     data_type bytes_;         ///< The buffer.
+    mutable std::uint64_t digests_[digest_count] = {0,0,0}; ///< Cached digests of the data.
+    mutable unsigned char digests_valid_ = 0;  ///< Bit mask of valid cached digests.
   };
 
   /**
    * Collection of blocks in this record
    */
-  using block_container_type = std::vector<block_type>;
+  using block_container_type = std::vector<block_type, typename std::allocator_traits<allocator_type>::template rebind_alloc<block_type>>;
+
+  /**
+   * Contiguous address range of a `view_type`: Either refers to the
+   * data of a block (no copy), or is an unassigned range, which reads
+   * as the fill value of the view.
+   */
+  class span_type
+  {
+  public:
+
+    using iterator = typename data_type::const_iterator;
+
+    explicit span_type() : sadr_(0), size_(0), fill_(true), value_(), data_()
+    {}
+
+    explicit span_type(address_type sadr, size_type size, iterator data) : sadr_(sadr), size_(size),
+      fill_(false), value_(), data_(data)
+    {}
+
+    explicit span_type(address_type sadr, size_type size, value_type fill_value) : sadr_(sadr), size_(size),
+      fill_(true), value_(fill_value), data_()
+    {}
+
+    /**
+     * Start address of the span.
+     * @return address_type
+     */
+    address_type sadr() const noexcept
+    { return sadr_; }
+
+    /**
+     * End address of the span (one position behind the last byte).
+     * @return address_type
+     */
+    address_type eadr() const noexcept
+    { return sadr_ + size_; }
+
+    /**
+     * Number of bytes in the span.
+     * @return size_type
+     */
+    size_type size() const noexcept
+    { return size_; }
+
+    /**
+     * True if the span is an unassigned (fill) range.
+     * @return bool
+     */
+    bool fill() const noexcept
+    { return fill_; }
+
+    /**
+     * Fill value of an unassigned range.
+     * @return value_type
+     */
+    value_type value() const noexcept
+    { return value_; }
+
+    /**
+     * Data of an assigned range (only valid if `!fill()`).
+     * @return iterator
+     */
+    iterator begin() const
+    { return data_; }
+
+    /**
+     * Data end of an assigned range (only valid if `!fill()`).
+     * @return iterator
+     */
+    iterator end() const
+    { return data_ + size_; }
+
+    /**
+     * Value at index `i` (relative to `sadr()`), `value()` for fill spans.
+     * @param size_type i
+     * @return value_type
+     */
+    value_type operator[](size_type i) const
+    { return fill_ ? value_ : value_type(data_[i]); }
+
+  private:
+
+    address_type sadr_;
+    size_type size_;
+    bool fill_;
+    value_type value_;
+    iterator data_;
+  };
+
+  /**
+   * Non-owning, read-only view of an address range, see `view()`. Iterates
+   * ordered `span_type`s that cover the whole range. No data are copied,
+   * the view is invalidated by any modification of the record.
+   */
+  class view_type
+  {
+  public:
+
+    class const_iterator
+    {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = span_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const span_type*;
+      using reference = const span_type&;
+
+      explicit const_iterator() : view_(nullptr), block_(0), span_()
+      {}
+
+      explicit const_iterator(const view_type* view, address_type adr) : view_(view), block_(0), span_()
+      {
+        if(adr >= view_->eadr_) {
+          span_ = span_type(view_->eadr_, 0, view_->value_);
+        } else {
+          block_ = view_->record_->view_block_index(adr);
+          span_ = view_->record_->view_span(adr, view_->eadr_, view_->value_, block_);
+        }
+      }
+
+      reference operator*() const noexcept
+      { return span_; }
+
+      pointer operator->() const noexcept
+      { return &span_; }
+
+      const_iterator& operator++()
+      {
+        if(span_.eadr() >= view_->eadr_) {
+          span_ = span_type(view_->eadr_, 0, view_->value_);
+        } else {
+          span_ = view_->record_->view_span(span_.eadr(), view_->eadr_, view_->value_, block_);
+        }
+        return *this;
+      }
+
+      const_iterator operator++(int)
+      { const_iterator it = *this; ++(*this); return it; }
+
+      bool operator==(const const_iterator& it) const noexcept
+      { return (view_ == it.view_) && (span_.sadr() == it.span_.sadr()) && (span_.size() == it.span_.size()); }
+
+      bool operator!=(const const_iterator& it) const noexcept
+      { return !(*this == it); }
+
+    private:
+
+      const view_type* view_;
+      size_type block_;
+      span_type span_;
+    };
+
+    explicit view_type(const basic_srecord& record, address_type start_address, address_type end_address, value_type fill_value) :
+      record_(&record), sadr_(start_address), eadr_((end_address > start_address) ? end_address : start_address),
+      value_(fill_value)
+    {}
+
+    /**
+     * Start address of the view.
+     * @return address_type
+     */
+    address_type sadr() const noexcept
+    { return sadr_; }
+
+    /**
+     * End address of the view.
+     * @return address_type
+     */
+    address_type eadr() const noexcept
+    { return eadr_; }
+
+    /**
+     * Number of bytes in the view range.
+     * @return size_type
+     */
+    size_type size() const noexcept
+    { return size_type(eadr_ - sadr_); }
+
+    /**
+     * True if the view range is empty.
+     * @return bool
+     */
+    bool empty() const noexcept
+    { return eadr_ == sadr_; }
+
+    /**
+     * True if the whole range is assigned (no fill spans).
+     * @return bool
+     */
+    bool assigned() const
+    {
+      for(const auto& span: *this) {
+        if(span.fill()) return false;
+      }
+      return true;
+    }
+
+    /**
+     * Copies the range to `out`, fill spans included.
+     * @param OutputIterator out
+     * @return OutputIterator
+     */
+    template <typename OutputIterator>
+    OutputIterator copy(OutputIterator out) const
+    {
+      for(const auto& span: *this) {
+        out = span.fill() ? std::fill_n(out, span.size(), span.value()) : std::copy(span.begin(), span.end(), out);
+      }
+      return out;
+    }
+
+    const_iterator begin() const
+    { return const_iterator(this, sadr_); }
+
+    const_iterator end() const
+    { return const_iterator(this, eadr_); }
+
+  private:
+
+    const basic_srecord* record_;
+    address_type sadr_, eadr_;
+    value_type value_;
+  };
+
+  /**
+   * Counters and timings collected if compiled with `WITH_SRECORD_STATISTICS`.
+   * Timings are steady clock nanoseconds, where `decode` comprises the
+   * hex decoding and checksum verification of the lines, and `analyse`
+   * the record analysis and block stitching. Memory mapped files are
+   * read while decoding, `io` is the time to read files in `load()`.
+   */
+  struct statistics_type
+  {
+    struct timings_type
+    {
+      std::uint64_t io = 0;           ///< Reading files.
+      std::uint64_t decode = 0;       ///< Line decoding (parallel parsing: wall time of all chunks).
+      std::uint64_t analyse = 0;      ///< Record analysis and block stitching.
+      std::uint64_t validate = 0;     ///< `validate()`.
+      std::uint64_t compose = 0;      ///< `compose()`, including validation.
+      std::uint64_t merge = 0;        ///< `merge()`.
+      std::uint64_t set_range = 0;    ///< `set_range()`.
+    };
+
+    std::uint64_t lines[10] = {0,0,0,0,0,0,0,0,0,0}; ///< Parsed lines by record type S0 to S9.
+    std::uint64_t bytes_decoded = 0;      ///< Data bytes of parsed data records.
+    std::uint64_t bytes_emitted = 0;      ///< Characters composed.
+    std::uint64_t blocks_created = 0;     ///< Blocks created by parsing, or added by `set_range()`.
+    std::uint64_t blocks_coalesced = 0;   ///< Records or blocks joined with existing blocks.
+    std::uint64_t allocations = 0;        ///< Block data allocations.
+    std::uint64_t reallocations = 0;      ///< Block data reallocations (capacity growth).
+    timings_type timings;                 ///< Timings.
+
+    statistics_type& operator+=(const statistics_type& s) noexcept
+    {
+      for(unsigned i=0; i<10; ++i) lines[i] += s.lines[i];
+      bytes_decoded += s.bytes_decoded;
+      bytes_emitted += s.bytes_emitted;
+      blocks_created += s.blocks_created;
+      blocks_coalesced += s.blocks_coalesced;
+      allocations += s.allocations;
+      reallocations += s.reallocations;
+      timings.io += s.timings.io;
+      timings.decode += s.timings.decode;
+      timings.analyse += s.timings.analyse;
+      timings.validate += s.timings.validate;
+      timings.compose += s.timings.compose;
+      timings.merge += s.timings.merge;
+      timings.set_range += s.timings.set_range;
+      return *this;
+    }
+  };
 
 private:
 
   /**
-   * Type for each connected data block.
+   * Decoded record line. The data bytes are held in a fixed buffer,
+   * so that parsing does not allocate per line.
    */
   struct line_type
   {
-    explicit line_type() : type(type_undefined), address(0), bytes() {}
-    void clear() { type=0; address=0; bytes.clear(); }
-    record_type_type type;
-    address_type address;
-    data_type bytes;
+    explicit line_type() noexcept : type(0), address(0), offset(0), size(0) {}
+    const unsigned char* data() const noexcept { return buffer + offset; }
+    unsigned type;                  ///< Record type (S0 to S9), not limited to `record_type_type`.
+    address_type address;           ///< Address field value.
+    size_type offset;               ///< Index of the first data byte in `buffer`.
+    size_type size;                 ///< Number of data bytes.
+    unsigned char buffer[256+8];    ///< Decoded count, address, data and checksum (+ SIMD slack).
   };
 
   /**
-   * Type for all lines.
+   * Parser state, collected record by record.
    */
-  using line_container_type = std::deque<line_type>;
+  struct parse_state_type
+  {
+    explicit parse_state_type() noexcept : records(0), count(0), spec_count(0), found_s0(false),
+      missing_s0(false), have_type(false), type(type_undefined), have_start_address(false),
+      start_line(0), start_type(0), error(e_ok), error_line(0)
+    {}
+    unsigned long records;        ///< Number of analysed records.
+    long count;                   ///< Number of data records, checked against S5/S6.
+    long spec_count;              ///< Data record count specified by S5/S6.
+    bool found_s0;                ///< S0 header record seen.
+    bool missing_s0;              ///< The first record is not an S0 header.
+    bool have_type;               ///< Data record type determined (first S0/S1/S2/S3 after the header).
+    record_type_type type;        ///< Data record type (S1/S2/S3).
+    bool have_start_address;      ///< S7/S8/S9 seen.
+    unsigned long start_line;     ///< Line of the first S7/S8/S9 before the data type was known.
+    unsigned start_type;          ///< Record type of that line.
+    error_type error;             ///< First record analysis error ...
+    unsigned long error_line;     ///< ... and its line.
+  };
+
+  /**
+   * Chunk of a buffer decoded by `parse_chunk()`. Only records that
+   * can be stitched without replaying the sequential analysis are
+   * accepted, everything else marks the chunk as irregular.
+   */
+  struct parse_chunk_type
+  {
+    explicit parse_chunk_type() noexcept : begin(nullptr), end(nullptr), lines(0), regular(true),
+      leading_s0(false), type(type_undefined), count(0), specs(0), spec_count(0), starts(0),
+      start_type(0), start_after_data(false), start_address(0)
+    {}
+    const char* begin;            ///< First character of the chunk (line start).
+    const char* end;              ///< End of the chunk (after a newline or buffer end).
+    unsigned long lines;          ///< Number of lines in the chunk.
+    bool regular;                 ///< No irregularity found.
+    bool leading_s0;              ///< The first record of the chunk is an S0 header.
+    data_type header;             ///< Header data of that S0.
+    record_type_type type;        ///< Data record type of the chunk.
+    long count;                   ///< Number of data records.
+    unsigned specs;               ///< Number of S5/S6 records ...
+    long spec_count;              ///< ... and the specified count.
+    unsigned starts;              ///< Number of S7/S8/S9 records ...
+    unsigned start_type;          ///< ... their record type,
+    bool start_after_data;        ///< ... if a data record preceded it in the chunk,
+    address_type start_address;   ///< ... and the start address.
+    block_container_type blocks;  ///< Ordered, non-overlapping data blocks.
+    #ifdef WITH_SRECORD_STATISTICS
+    statistics_type statistics;   ///< Statistics of the chunk.
+    #endif
+  };
+
+  /**
+   * Output layout of `compose()`: all line sizes and positions are
+   * determined by the blocks and the data line length.
+   */
+  struct compose_layout_type
+  {
+    explicit compose_layout_type() noexcept : data_line_length(0), address_size(0), header_chars(0), trailer_chars(0)
+    {}
+    size_type data_line_length;           ///< Data bytes per full data line.
+    unsigned address_size;                ///< Address field size of the data lines.
+    size_type header_chars;               ///< Characters of the S0 line.
+    size_type trailer_chars;              ///< Characters of the S5/S6 and S7/S8/S9 lines.
+    std::vector<unsigned long> lines;     ///< Number of data lines before block i (size: blocks+1).
+    std::vector<size_type> chars;         ///< Number of data line characters before block i (size: blocks+1).
+
+    unsigned long data_lines() const noexcept
+    { return lines.back(); }
+
+    size_type line_chars() const noexcept
+    { return record_chars(address_size, data_line_length); }
+
+    size_type size() const noexcept
+    { return header_chars + chars.back() + trailer_chars; }
+
+    /**
+     * Character offset of a data line, relative to the first data line.
+     */
+    size_type offset(unsigned long line) const noexcept
+    {
+      const size_type i = size_type(std::upper_bound(lines.begin(), lines.end(), line) - lines.begin()) - 1;
+      return chars[i] + size_type(line - lines[i]) * line_chars();
+    }
+  };
+
+  /**
+   * Queued modification of a `transaction_type`.
+   */
+  struct edit_type
+  {
+    address_type sadr;      ///< Start address.
+    address_type eadr;      ///< End address.
+    bool remove;            ///< Range removal, otherwise `data` is written.
+    data_type data;         ///< Data to write at `sadr`.
+  };
+
+  /**
+   * Prepared search pattern of `find()`, `find_all()` and `count()`:
+   * Masked pattern bytes, the Horspool shift table, and a fixed byte
+   * of the pattern used to locate candidates with `memchr()`.
+   * A mask size mismatch results in an empty pattern (no matches).
+   */
+  struct search_pattern_type
+  {
+    explicit search_pattern_type(const data_type& sequence, const data_type* mask) :
+      size(sequence.size()), prefilter(false), anchor(0), bytes(), masks(), shift()
+    {
+      if(mask && (mask->size() != size)) size = 0;
+      if(!size) return;
+      bytes.resize(size);
+      masks.resize(size, 0xff);
+      for(size_type j=0; j<size; ++j) {
+        if(mask) masks[j] = static_cast<unsigned char>((*mask)[j]);
+        bytes[j] = static_cast<unsigned char>(sequence[j]) & masks[j];
+      }
+      // Prefilter byte: a fixed byte, preferably none of the usual fill values.
+      for(size_type j=0; j<size; ++j) {
+        if(masks[j] != 0xff) continue;
+        if((!prefilter) || ((bytes[anchor] == 0x00 || bytes[anchor] == 0xff) && (bytes[j] != 0x00 && bytes[j] != 0xff))) {
+          anchor = j;
+          prefilter = true;
+        }
+      }
+      for(size_type c=0; c<256; ++c) shift[c] = size;
+      for(size_type j=0; j+1<size; ++j) {
+        if(masks[j] == 0xff) {
+          shift[bytes[j]] = size-1-j;
+        } else {
+          for(size_type c=0; c<256; ++c) {
+            if((c & masks[j]) == bytes[j]) shift[c] = size-1-j;
+          }
+        }
+      }
+    }
+
+    template <typename Iterator>
+    bool matches(Iterator it) const
+    {
+      for(size_type j=0; j<size; ++j, ++it) {
+        if((static_cast<unsigned char>(*it) & masks[j]) != bytes[j]) return false;
+      }
+      return true;
+    }
+
+    size_type size;                     ///< Pattern length, 0 for invalid patterns.
+    bool prefilter;                     ///< Locate candidates via the `anchor` byte.
+    size_type anchor;                   ///< Index of the prefilter byte.
+    std::vector<unsigned char> bytes;   ///< Pattern bytes, masked.
+    std::vector<unsigned char> masks;   ///< Byte masks, 0xff: exact, 0x00: wildcard.
+    size_type shift[256];               ///< Horspool shift by the last window byte.
+  };
 
 public:
 
@@ -403,7 +979,15 @@ public:
    */
   explicit basic_srecord() : error_(e_ok), type_(type_undefined), start_address_(0),
           header_(), blocks_(), parser_line_(0), error_address_(0), default_value_(0x00),
-          strict_parsing_(false)
+          strict_parsing_(false), normalized_(true), blocks_exposed_(false), data_size_(0)
+  { }
+
+  /**
+   * c'tor, blocks and header allocated with `alloc`.
+   */
+  explicit basic_srecord(const allocator_type& alloc) : error_(e_ok), type_(type_undefined), start_address_(0),
+          header_(alloc), blocks_(alloc), parser_line_(0), error_address_(0), default_value_(0x00),
+          strict_parsing_(false), normalized_(true), blocks_exposed_(false), data_size_(0)
   { }
 
   /**
@@ -411,7 +995,7 @@ public:
    */
   explicit inline basic_srecord(std::istream& is) : error_(e_ok), type_(type_undefined),
           start_address_(0), header_(), blocks_(), parser_line_(0), error_address_(0),
-          default_value_(0x00), strict_parsing_(false)
+          default_value_(0x00), strict_parsing_(false), normalized_(true), blocks_exposed_(false), data_size_(0)
   { parse(is); }
 
   /**
@@ -419,32 +1003,101 @@ public:
    */
   explicit inline basic_srecord(const std::string& s) : error_(e_ok), type_(type_undefined),
           start_address_(0), header_(), blocks_(), parser_line_(0), error_address_(0),
-          default_value_(0x00), strict_parsing_(false)
+          default_value_(0x00), strict_parsing_(false), normalized_(true), blocks_exposed_(false), data_size_(0)
   { parse(s); }
 
   /**
-   * d'tor
+   * c'tor (copy)
    */
-  ~basic_srecord()
-  { clear(); }
+  basic_srecord(const basic_srecord& o)
+    : error_(o.error_), type_(o.type_), start_address_(o.start_address_), header_(o.header_),
+      blocks_(o.blocks_), parser_line_(o.parser_line_), error_address_(o.error_address_),
+      default_value_(o.default_value_), strict_parsing_(o.strict_parsing_), normalized_(o.known_normalized()),
+      blocks_exposed_(false), data_size_(o.data_size_)
+      #ifdef WITH_SRECORD_STATISTICS
+      , statistics_(o.statistics_)
+      #endif
+  { if(o.blocks_exposed_) update_normalized(); }
 
-public:
+  /**
+   * c'tor (move), the moved-from instance is cleared.
+   */
+  basic_srecord(basic_srecord&& o) noexcept(std::is_nothrow_move_constructible<block_container_type>::value
+    && std::is_nothrow_move_constructible<data_type>::value)
+    : error_(o.error_), type_(o.type_), start_address_(o.start_address_), header_(std::move(o.header_)),
+      blocks_(std::move(o.blocks_)), parser_line_(o.parser_line_), error_address_(o.error_address_),
+      default_value_(o.default_value_), strict_parsing_(o.strict_parsing_), normalized_(o.known_normalized()),
+      blocks_exposed_(false), data_size_(o.data_size_)
+      #ifdef WITH_SRECORD_STATISTICS
+      , statistics_(o.statistics_)
+      #endif
+  { if(o.blocks_exposed_) update_normalized(); o.clear(); }
 
   /**
-   * Clears all instance variables, resets the error.
+   * Assignment (copy)
    */
-  inline void clear()
+  basic_srecord& operator=(const basic_srecord& o)
   {
-    type_=type_undefined; start_address_=0; blocks_.clear(); header_.clear();
-    error_ = e_ok; parser_line_ = 0; error_address_ = 0;
+    if(&o == this) return *this;
+    error_ = o.error_; type_ = o.type_; start_address_ = o.start_address_;
+    header_ = o.header_; blocks_ = o.blocks_;
+    parser_line_ = o.parser_line_; error_address_ = o.error_address_; default_value_ = o.default_value_;
+    strict_parsing_ = o.strict_parsing_; normalized_ = o.known_normalized(); data_size_ = o.data_size_;
+    #ifdef WITH_SRECORD_STATISTICS
+    statistics_ = o.statistics_;
+    #endif
+    if(o.blocks_exposed_) update_normalized();
+    return *this;
   }
 
   /**
-   * Returns a copy of the current error message.
-   * @return std::string
+   * Assignment (move), the moved-from instance is cleared.
    */
-  inline std::string error_message() const
-  { return strerr(error_); }
+  basic_srecord& operator=(basic_srecord&& o)
+  {
+    if(&o == this) return *this;
+    error_ = o.error_; type_ = o.type_; start_address_ = o.start_address_;
+    header_ = std::move(o.header_); blocks_ = std::move(o.blocks_);
+    parser_line_ = o.parser_line_; error_address_ = o.error_address_; default_value_ = o.default_value_;
+    strict_parsing_ = o.strict_parsing_; normalized_ = o.known_normalized(); data_size_ = o.data_size_;
+    #ifdef WITH_SRECORD_STATISTICS
+    statistics_ = o.statistics_;
+    #endif
+    if(o.blocks_exposed_) update_normalized();
+    o.clear();
+    return *this;
+  }
+
+  /**
+   * d'tor
+   */
+  ~basic_srecord()
+  { clear(); }
+
+public:
+
+  /**
+   * Returns the allocator of this instance.
+   * @return allocator_type
+   */
+  inline allocator_type get_allocator() const
+  { return header_.get_allocator(); }
+
+  /**
+   * Clears all instance variables, resets the error.
+   */
+  inline void clear()
+  {
+    type_=type_undefined; start_address_=0; blocks_.clear(); header_.clear();
+    error_ = e_ok; parser_line_ = 0; error_address_ = 0; normalized_ = true; blocks_exposed_ = false; data_size_ = 0;
+  }
+
+  /**
+   * Returns a copy of the current error message.
+   * @return std::string
+   */
+  inline std::string error_message() const
+  { return strerr(error_); }
 
   /**
    * Returns a the current error code.
@@ -501,10 +1154,33 @@ public:
 
   /**
    * Returns a random access reference to the record blocks.
+   * As the blocks may be modified arbitrarily through this reference,
+   * the instance does not trust its block ordering and cached size
+   * until the next modifying method re-checks them (O(n) once), const
+   * address lookups are linear until then. Modifications via the
+   * reference are only allowed until that next modifying method call,
+   * afterwards `blocks()` must be called again. Prefer the const
+   * accessor for reading, and `edit_blocks()` for scoped modifications.
    * @return block_container_type&
    */
   inline block_container_type& blocks()
-  { return blocks_; }
+  { blocks_exposed_ = true; data_size_ = data_size_unknown; return blocks_; }
+
+  /**
+   * Calls `fn(block_container_type&)` to modify the blocks, and re-checks
+   * the block ordering afterwards. In contrast to the mutable `blocks()`,
+   * the fast address lookups stay enabled, hence, `fn` must not retain
+   * the reference.
+   * @param EditFunction&& fn
+   * @return basic_srecord&
+   */
+  template <typename EditFunction>
+  basic_srecord& edit_blocks(EditFunction&& fn)
+  {
+    fn(blocks_);
+    update_normalized();
+    return *this;
+  }
 
   /**
    * Returns a const reference to the record blocks.
@@ -533,6 +1209,18 @@ public:
   inline address_type eadr() const
   { return blocks_.empty() ? 0 : blocks_.back().eadr(); }
 
+  /**
+   * Returns the total number of data bytes in all blocks. The size is
+   * cached, maintained by `set_range()` and `remove_range()`, and
+   * recounted by the other modifying methods. After the mutable `blocks()`
+   * was called, it is recounted on every call until the next modifying
+   * method. This method does not write the instance, so that concurrent
+   * const access is safe.
+   * @return size_type
+   */
+  inline size_type size() const noexcept
+  { return ((data_size_ != data_size_unknown) && (!blocks_exposed_)) ? data_size_ : count_size(); }
+
   /**
    * Returns the type (specifying the address width).
    * @return record_type_type
@@ -621,6 +1309,27 @@ public:
   inline address_type error_address() const
   { return error_address_; }
 
+  /**
+   * Returns the statistics of `parse()`/`load()`, `compose()`, `merge()` and
+   * `set_range()` since construction or `reset_statistics()`, not affected
+   * by `clear()`. All zero if not compiled with `WITH_SRECORD_STATISTICS`.
+   * @return statistics_type
+   */
+  inline statistics_type statistics() const noexcept
+  {
+    #ifdef WITH_SRECORD_STATISTICS
+    return statistics_;
+    #else
+    return statistics_type();
+    #endif
+  }
+
+  /**
+   * Resets the statistics.
+   */
+  inline void reset_statistics() noexcept
+  { SRECORD_STATISTICS(statistics_ = statistics_type()) }
+
 public:
 
   /**
@@ -629,7 +1338,7 @@ public:
    * @return bool
    */
   inline bool parse(const std::string& data)
-  { std::istringstream ss(data); return parse(ss, true); }
+  { return parse(data.data(), data.data()+data.size()); }
 
   /**
    * Parse a string.
@@ -637,7 +1346,173 @@ public:
    * @return bool
    */
   inline bool parse(std::string&& data)
-  { std::istringstream ss(std::move(data)); return parse(ss, true); }
+  { return parse(data.data(), data.data()+data.size()); }
+
+  /**
+   * Parse a null terminated c-string.
+   * @param const char* data
+   * @return bool
+   */
+  inline bool parse(const char* data)
+  { return parse(data, data ? (data+std::strlen(data)) : data); }
+
+  /**
+   * Parses a contiguous character buffer. The record boundaries
+   * are scanned directly in the buffer, no line copies are made.
+   * All lines to the end of the buffer are parsed (like a single
+   * file stream), except a second S0 header, which terminates the
+   * record.
+   *
+   * @param const char* begin
+   * @param const char* end
+   * @return bool
+   */
+  inline bool parse(const char* begin, const char* end)
+  { return parse_buffer(begin, end, true); }
+
+  #if(__cplusplus >= 201700L)
+  /**
+   * Parses a contiguous character buffer.
+   * @see bool parse(const char* begin, const char* end)
+   * @param std::string_view data
+   * @return bool
+   */
+  inline bool parse(std::string_view data)
+  { return parse(data.data(), data.data()+data.size()); }
+  #endif
+
+  /**
+   * Parses Intel HEX (I8HEX/I16HEX/I32HEX) from a contiguous character
+   * buffer into the blocks of this instance. Data records (00) are offset
+   * by the last extended segment (02) or extended linear (04) address,
+   * start address records (03: CS*16+IP, 05: EIP) set the start address.
+   * Data offsets after a segment address wrap within the 64KiB segment.
+   * Parsing ends at the end of file record (01), which is required with
+   * strict parsing. The record type (S1/S2/S3) is set according to the
+   * address range, so that the data can be composed as S-record, too.
+   * Like `parse()`, line or decode errors leave an empty record with the
+   * error details.
+   *
+   * @param const char* begin
+   * @param const char* end
+   * @return bool
+   */
+  bool parse_ihex(const char* begin, const char* end)
+  {
+    clear();
+    line_type rec;
+    address_type base = 0;
+    bool segmented = false;
+    bool eof = false;
+    const char* pos = begin;
+    const auto fail = [this](error_type e) { discard_parsed(); return error(e); };
+    const auto append = [this](address_type adr, const unsigned char* first, const unsigned char* last) {
+      if(first == last) return;
+      if(blocks_.empty() || (blocks_.back().eadr() != adr)) {
+        blocks_.push_back(block_type(adr, get_allocator()));
+      }
+      blocks_.back().bytes().insert(blocks_.back().bytes().end(), first, last);
+    };
+    {
+      SRECORD_STATISTICS_TIMER(statistics_.timings.decode);
+      while((pos < end) && (!eof)) {
+        const char* line_end = static_cast<const char*>(std::memchr(pos, '\n', size_type(end-pos)));
+        if(!line_end) line_end = end;
+        const char* const s = skip_space(pos, line_end);
+        pos = (line_end < end) ? (line_end+1) : end;
+        ++parser_line_;
+        if(s == line_end) continue;
+        if(*s != ':') return fail(e_parse_line_not_starting_with_colon);
+        const error_type e = decode_ihex_line(s+1, line_end, rec);
+        if(e != e_ok) return fail(e);
+        const unsigned char* const d = rec.data();
+        switch(rec.type) {
+          case 0x00: {
+            // I16HEX: (segment base + (offset mod 64KiB)).
+            const size_type n = (segmented && (rec.address+rec.size > 0x10000u)) ? size_type(0x10000u-rec.address) : rec.size;
+            append(base+rec.address, d, d+n);
+            append(base, d+n, d+rec.size);
+            SRECORD_STATISTICS(statistics_.bytes_decoded += rec.size)
+            break;
+          }
+          case 0x01:
+            eof = true;
+            break;
+          case 0x02:
+          case 0x04:
+            if(rec.size != 2) return fail(e_parse_invalid_line_length);
+            segmented = (rec.type == 0x02);
+            base = ((address_type(d[0]) << 8) | address_type(d[1])) << (segmented ? 4 : 16);
+            break;
+          case 0x03:
+            if(rec.size != 4) return fail(e_parse_invalid_line_length);
+            start_address_ = (((address_type(d[0]) << 8) | address_type(d[1])) << 4) + ((address_type(d[2]) << 8) | address_type(d[3]));
+            break;
+          case 0x05:
+            if(rec.size != 4) return fail(e_parse_invalid_line_length);
+            start_address_ = (address_type(d[0]) << 24) | (address_type(d[1]) << 16) | (address_type(d[2]) << 8) | address_type(d[3]);
+            break;
+          default:
+            return fail(e_parse_invalid_record_type);
+        }
+      }
+    }
+    if((!eof) && strict_parsing()) return error(e_parse_missing_eof);
+    reorder(blocks_);
+    connect_adjacent_blocks();
+    update_normalized();
+    return validate(false);
+  }
+
+  /**
+   * Parses Intel HEX from a string.
+   * @see bool parse_ihex(const char* begin, const char* end)
+   * @param const std::string& data
+   * @return bool
+   */
+  inline bool parse_ihex(const std::string& data)
+  { return parse_ihex(data.data(), data.data()+data.size()); }
+
+  /**
+   * Parses a contiguous character buffer like `parse(begin, end)`, but
+   * decodes the lines on multiple threads. The buffer is split at line
+   * boundaries, each chunk is decoded into chunk-local blocks, which are
+   * then stitched in address order. The result, including errors and
+   * `parser_line()`, is identical to the sequential parse: Inputs that
+   * cannot be stitched directly (e.g. on errors, unordered data records
+   * or multiple S0) are parsed again sequentially. Small buffers are
+   * always parsed sequentially. `threads==0` selects the number of
+   * hardware threads.
+   *
+   * @param const char* begin
+   * @param const char* end
+   * @param unsigned threads
+   * @return bool
+   */
+  inline bool parse_parallel(const char* begin, const char* end, unsigned threads=0)
+  { return parse_buffer_parallel(begin, end, threads); }
+
+  /**
+   * Parses a string on multiple threads.
+   * @see bool parse_parallel(const char* begin, const char* end, unsigned threads)
+   * @param const std::string& data
+   * @param unsigned threads
+   * @return bool
+   */
+  inline bool parse_parallel(const std::string& data, unsigned threads=0)
+  { return parse_parallel(data.data(), data.data()+data.size(), threads); }
+
+  #if(__cplusplus >= 201700L)
+  /**
+   * Parses a contiguous character buffer on multiple threads.
+   * @see bool parse_parallel(const char* begin, const char* end, unsigned threads)
+   * @param std::string_view data
+   * @param unsigned threads
+   * @return bool
+   */
+  inline bool parse_parallel(std::string_view data, unsigned threads=0)
+  { return parse_parallel(data.data(), data.data()+data.size(), threads); }
+  #endif
 
   /**
    * Parses an input stream.
@@ -652,41 +1527,28 @@ public:
   {
     clear();
     std::string line;
-    bool found_s0 = false;
-    line_container_type line_block;
+    parse_state_type state;
+    line_type rec;
     while(std::getline(is, line)) {
       ++parser_line_;
-      std::string s;
-      for(auto e:line) {
-        if(!::isspace(e)) s += e;
-      }
-      if(s.empty()) continue;
-      if((!single_file_stream) && (s[0] != 'S' && s[0] != 's')) {
+      const char* const line_end = line.data() + line.size();
+      const char* const s = skip_space(line.data(), line_end);
+      if(s == line_end) continue;
+      if(((!single_file_stream) && (*s != 'S' && *s != 's')) || (
+        parse_line(s, line_end, rec) && (!parse_record(state, rec))
+      )) {
+        // Not part of this record, or the next S0 --> put back for the next.
         auto i = line.length();
         is.putback('\n');
         while(i) is.putback(line[--i]);
         break;
-      }
-      line_type rec;
-      if(!parse_line(std::move(s), rec)) {
+      } else if(!good()) {
         break;
-      } else if(rec.type == 0) {
-        if(found_s0) {
-          // That's already the next S0 --> put back for the next.
-          auto i = line.length();
-          is.putback('\n');
-          while(i) is.putback(line[--i]);
-          break;
-        } else {
-          line_block.push_back(rec);
-          found_s0 = true;
-        }
-      } else {
-        line_block.push_back(rec);
       }
     }
-    parse_analyze_block(line_block);
-    reorder(blocks());
+    parse_finish(state);
+    reorder(blocks_);
+    update_normalized();
     return good() && validate(strict_parsing());
   }
 
@@ -699,99 +1561,31 @@ public:
    */
   bool compose(std::ostream& os, size_type line_length=0)
   {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.compose);
     if(!good() || !validate()) return false;
-    size_type data_line_length = 64;
+    const size_type data_line_length = compose_data_line_length(line_length);
+    const unsigned address_size = unsigned(type_)+1;
+    output_buffer out(os);
+    // Header, padded to 12 bytes, address field zero.
     {
-      const size_type frame_size = (2+2+(2*(1+type()))+2); // Sx+len+(adr)+(no data bytes)+cksum
-      const size_type min_line_length = (frame_size+8);  // frame + min 4 data bytes.
-      if(line_length == 0) line_length = frame_size + 64;
-      else if(line_length > 92) line_length = 92;
-      else if(line_length < min_line_length) line_length = min_line_length;
-      data_line_length = (line_length-frame_size)/2;
-    }
-    // Header
-    {
-      std::deque<typename data_type::value_type> bin;
-      for(auto e: header_) bin.push_back(e);
-      while(bin.size() < 12) bin.push_back(0);
-      bin.push_front(0);
-      bin.push_front(0);
-      if(type_ > 1) bin.push_front(0);
-      if(type_ > 2) bin.push_front(0);
-      bin.push_front(bin.size()+1);
-      bin.push_back(cksum(bin));
-      os << "S0" << tohex(bin) << std::endl;
+      const size_type padding = (header_.size() < 12) ? (12-header_.size()) : 0;
+      write_record(out, 0, 0, address_size, header_.begin(), header_.size(), padding);
     }
     // Data
     unsigned long line_data_count = 0;
-    {
-      record_type_type type = type_;
-      for(const block_type& block: blocks_) {
-        std::deque<typename data_type::value_type> bin;
-        const data_type& bytes = block.bytes();
-        typename data_type::size_type sz = bytes.size();
-        address_type address = block.sadr();
-        unsigned i = 0;
-        while(i < sz) {
-          // Get one line, either to max chars or until no bytes left in the block binary data.
-          for(unsigned data_bytes = 0; (data_bytes < data_line_length) && (i < sz); ++data_bytes, ++i) {
-            bin.push_back(bytes[i]);
-          }
-          // Prepend address, update address
-          // Append checksum over address and binary data
-          // Prepend count/length
-          {
-            unsigned line_sz = bin.size();
-            bin.push_front((address>>0) & 0xff);
-            bin.push_front((address>>8) & 0xff);
-            if(type > 1) bin.push_front((address>>16) & 0xff);
-            if(type > 2) bin.push_front((address>>24) & 0xff);
-            address += line_sz;
-            bin.push_front(bin.size()+1);
-            bin.push_back(cksum(bin));
-          }
-          // Prepend type, out
-          {
-            std::string line = "S";
-            line.reserve(2*data_line_length+18);
-            line += ('0'+type);
-            line += tohex(bin);
-            os << line << std::endl;
-            bin.clear();
-            ++line_data_count;
-          }
-        }
-      }
+    switch(address_size) {
+      case 2:  line_data_count = write_data_records<2>(out, data_line_length); break;
+      case 3:  line_data_count = write_data_records<3>(out, data_line_length); break;
+      default: line_data_count = write_data_records<4>(out, data_line_length); break;
     }
     // Data line count
-    {
-      std::deque<typename data_type::value_type> bin;
-      bin.push_front((line_data_count>>0) & 0xff);
-      bin.push_front((line_data_count>>8) & 0xff);
-      line_data_count >>= 16;
-      if(line_data_count) bin.push_front(line_data_count & 0xff);
-      line_data_count >>= 8;
-      if(line_data_count) return error(e_compose_max_number_of_data_lines_exceeded);
-      bin.push_front(bin.size()+1);
-      bin.push_back(cksum(bin));
-      std::string s = bin.size() == 4 ? "S5" : "S6";
-      s += tohex(bin);
-      os << s << std::endl;
-    }
+    if(line_data_count > 0xffffffu) return error(e_compose_max_number_of_data_lines_exceeded);
+    write_record(out, (line_data_count > 0xffffu) ? 6u : 5u, address_type(line_data_count), (line_data_count > 0xffffu) ? 3u : 2u, header_.begin(), 0);
     // Start address (termination)
-    {
-      std::deque<typename data_type::value_type> bin;
-      bin.push_front((start_address_>>0) & 0xff);
-      bin.push_front((start_address_>>8) & 0xff);
-      if(type_ > 1) bin.push_front((start_address_>>16) & 0xff);
-      if(type_ > 2) bin.push_front((start_address_>>24) & 0xff);
-      bin.push_front(bin.size()+1);
-      bin.push_back(cksum(bin));
-      std::string s = "S";
-      s += ('0'+(10-type_));
-      s += tohex(bin);
-      os << s << std::endl;
-    }
+    write_record(out, 10u-unsigned(type_), start_address_, address_size, header_.begin(), 0);
+    out.flush();
+    os.flush();
+    SRECORD_STATISTICS(statistics_.bytes_emitted += out.written())
     return true;
   }
 
@@ -803,1096 +1597,5980 @@ public:
    * @return std::string
    */
   std::string compose(size_type line_length=0)
-  { std::stringstream ss; return compose(ss, line_length) ? (ss.str()) : (std::string()); }
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.compose);
+    compose_layout_type layout;
+    if(!compose_layout(layout, line_length)) return std::string();
+    SRECORD_STATISTICS(statistics_.bytes_emitted += layout.size())
+    std::string s(layout.size(), '\0');
+    char* const data = render_header(&s[0], layout);
+    render_trailer(render_data_lines(data, layout, 0, layout.data_lines()), layout);
+    return s;
+  }
 
   /**
-   * Human readable dump to a defined ostream.
-   * @param std::ostream&
+   * Composes the data as Intel HEX: Data records (00), extended linear
+   * address records (04) where the upper 16 address bits change, a start
+   * linear address record (05) if the start address is nonzero, and the
+   * end of file record (01). `line_length` is the number of characters
+   * per data line (0: default of 16 data bytes per line, at most 255).
+   * Only the 32 bit address range is checked, the S-record type is not
+   * relevant. Returns success.
+   *
+   * @param std::ostream& os
+   * @param size_type line_length
+   * @return bool
    */
-  inline void dump(std::ostream& os) const
+  bool compose_ihex(std::ostream& os, size_type line_length=0)
   {
-    os << "srec {" << std::endl;
-    os << " data type: ";
-    if(type() == 0) {
-      os << "(auto/not set)";
-    } else if(type() > 0 && type() < 4) {
-      os << "S" << (int) type();
-    } else {
-      os << "(invalid)";
+    SRECORD_STATISTICS_TIMER(statistics_.timings.compose);
+    if(!good()) return false;
+    if(blocks_.empty()) return error(e_validate_no_binary_data);
+    for(const block_type& block: blocks_) {
+      if(block.eadr() > 0x100000000ull) return error(e_validate_record_range_exceeded);
     }
-    os << std::endl;
-    os << " blocks: [" << std::endl;
-    for(const block_type& e: blocks()) {
-      std::string s;
-      {
-        std::ostringstream ss;
-        e.dump(ss);
-        s = ss.str();
-      }
-      std::istringstream ss(s);
-      s.clear();
-      while(std::getline(ss, s)) {
-        if(s.empty()) continue;
-        os << "    " << s << std::endl;
+    const size_type data_line_length = (!line_length) ? 16 :
+      std::min(size_type(255), std::max(size_type(4), (line_length - std::min(line_length, ihex_frame_chars-1))/2));
+    output_buffer out(os);
+    address_type upper = 0; // Upper 16 address bits of the last 04 record.
+    for(const block_type& block: blocks_) {
+      address_type address = block.sadr();
+      auto data = search_data(block.bytes());
+      size_type remaining = block.size();
+      while(remaining) {
+        if((address >> 16) != upper) {
+          upper = address >> 16;
+          const unsigned char ela[2] = { static_cast<unsigned char>(upper >> 8), static_cast<unsigned char>(upper) };
+          out.commit(render_ihex_record(out.reserve(ihex_frame_chars+4), 0x04, 0, ela, 2));
+        }
+        const size_type n = std::min(std::min(remaining, data_line_length), size_type(0x10000u - (address & 0xffffu)));
+        out.commit(render_ihex_record(out.reserve(ihex_frame_chars+2*n), 0x00, unsigned(address & 0xffffu), data, n));
+        data += n;
+        address += address_type(n);
+        remaining -= n;
       }
-      os << std::endl;
     }
-    os << " ]" << std::endl;
-    os << "}" << std::endl;
+    if(start_address_) {
+      const unsigned char sla[4] = {
+        static_cast<unsigned char>(start_address_ >> 24), static_cast<unsigned char>(start_address_ >> 16),
+        static_cast<unsigned char>(start_address_ >> 8), static_cast<unsigned char>(start_address_)
+      };
+      out.commit(render_ihex_record(out.reserve(ihex_frame_chars+8), 0x05, 0, sla, 4));
+    }
+    out.commit(render_ihex_record(out.reserve(ihex_frame_chars), 0x01, 0, static_cast<const unsigned char*>(nullptr), 0));
+    out.flush();
+    os.flush();
+    SRECORD_STATISTICS(statistics_.bytes_emitted += out.written())
+    return true;
   }
 
   /**
-   * Human readable string dump.
+   * Composes the data as Intel HEX to a string. Returns an empty
+   * string on error.
+   * @see bool compose_ihex(std::ostream& os, size_type line_length)
+   * @param size_type line_length
    * @return std::string
    */
-  inline std::string dump() const
-  { std::stringstream ss; dump(ss); return ss.str(); }
-
-  /**
-   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
-   * Returns success, that is: The file path is not empty,
-   * opening the file succeeded, parsing succeeded, and
-   * file whole file was read (only contains S-Record data
-   * and no comments or the like). If parsing fails, the
-   * error is set in the instance, otherwise there was a
-   * file input error.
-   *
-   * @param std::string file_path
-   * @param basic_srecord& srec
-   * @return bool
-   */
-  static inline bool load(std::string file_path, basic_srecord& srec)
-  { return load(file_path.c_str(), srec); }
-
-  /**
-   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
-   * Returns success, that is: The file path is not empty,
-   * opening the file succeeded, parsing succeeded, and
-   * file whole file was read (only contains S-Record data
-   * and no comments or the like). If parsing fails, the
-   * error is set in the instance, otherwise there was a
-   * file input error.
-   *
-   * @param const char* file_path
-   * @param basic_srecord& srec
-   * @return bool
-   */
-  static inline bool load(const char* file_path, basic_srecord& srec)
+  std::string compose_ihex(size_type line_length=0)
   {
-    srec.clear();
-    if(!file_path || !file_path[0]) return false;
-    std::ifstream fs(file_path);
-    if((!fs.good()) || (!srec.parse(fs, true))) return false;
-    return fs.eof();
+    std::ostringstream os;
+    return compose_ihex(os, line_length) ? os.str() : std::string();
   }
 
   /**
-   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
-   * Returns a basic_srecord object containing the parsed data.
-   * On file stream error or parse error, the `error()` of the
-   * instance is set accordingly.
+   * Returns the exact number of characters that `compose()` writes
+   * with the given line length, or 0 if the record cannot be composed
+   * (the error is set accordingly).
    *
-   * @param const char* file_path
-   * @return basic_srecord
+   * @param size_type line_length
+   * @return size_type
    */
-  static inline basic_srecord load(const char* file_path)
+  size_type compose_size(size_type line_length=0)
   {
-    basic_srecord srec;
-    if(!file_path || !file_path[0]) { srec.error(e_load_open_failed); return srec; }
-    std::ifstream fs(file_path);
-    if(!fs.good()) { srec.error(e_load_open_failed); return srec; }
-    srec.parse(fs, true);
-    return srec;
+    compose_layout_type layout;
+    return compose_layout(layout, line_length) ? layout.size() : 0;
   }
 
   /**
-   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
-   * Returns a basic_srecord object containing the parsed data.
-   * On file stream error or parse error, the `error()` of the
-   * instance is set accordingly.
+   * Recomposes a srec file like `compose()`, but renders the data lines
+   * on multiple threads. The output is identical to `compose()`, except
+   * that nothing is written if the number of data lines exceeds the S5/S6
+   * range. `threads==0` selects the number of hardware threads.
    *
-   * @param std::string file_path
-   * @return basic_srecord
-   */
-  static inline basic_srecord load(std::string file_path)
-  { return load(file_path.c_str()); }
-
-  /**
-   * Checks if the current "image" saved in the
-   * instance is ok. If no address width type is set,
-   * it sets this type implicitly to the minimum possible
-   * address type (means S1/S2/S3).
-   * @param bool strict =true
+   * @param std::ostream& os
+   * @param size_type line_length
+   * @param unsigned threads
    * @return bool
    */
-  bool validate(bool strict=true)
+  bool compose_parallel(std::ostream& os, size_type line_length=0, unsigned threads=0)
   {
-    if(!good()) return false;
-    // Check/set address type
+    SRECORD_STATISTICS_TIMER(statistics_.timings.compose);
+    compose_layout_type layout;
+    if(!compose_layout(layout, line_length)) return false;
+    SRECORD_STATISTICS(statistics_.bytes_emitted += layout.size())
     {
-      record_type_type type = type_s1_16bit;
-      for(block_type& block: blocks_) {
-        if(block.eadr() > 0x100000000ull) { return error(e_validate_record_range_exceeded); }
-        if(block.eadr() > 0x001000000ull) { type = type_s3_32bit; break; }
-        if(block.eadr() > 0x000010000ull) { type = type_s2_24bit;        }
-      }
-      if(type_ == type_undefined) {
-        type_ = type;
-      } else if(type_ < type) {
-        if(strict) {
-          return error(e_validate_record_type_to_small);
-        } else {
-          type_ = type;
-        }
-      }
+      std::string s(layout.header_chars, '\0');
+      render_header(&s[0], layout);
+      os.write(s.data(), std::streamsize(s.size()));
     }
-    // Variable checks
+    // Slices of some MiB, rendered in rounds to limit the memory usage.
     {
-      if((type_ < type_s1_16bit) || (type_ > type_s3_32bit)) {
-        return error(e_validate_record_type_to_small);
-      }
-      if(blocks_.empty()) {
-        return error(e_validate_no_binary_data);
+      #if !defined(WITHOUT_SRECORD_THREADS)
+      if(!threads) threads = std::thread::hardware_concurrency();
+      #endif
+      if(!threads) threads = 1;
+      const unsigned long lines = layout.data_lines();
+      const unsigned long slice_lines = (unsigned long)((size_type(4)<<20) / layout.line_chars()) + 1;
+      const unsigned long slices = (lines + slice_lines - 1) / slice_lines;
+      std::vector<std::string> buffers(size_type((slices < 2ul*threads) ? slices : 2ul*threads));
+      for(unsigned long first=0; first < slices; first += buffers.size()) {
+        const size_type n = size_type(((slices-first) < buffers.size()) ? (slices-first) : buffers.size());
+        run_parallel(n, threads, [&](size_type i) {
+          const unsigned long first_line = (first+i) * slice_lines;
+          const unsigned long last_line = ((first_line + slice_lines) < lines) ? (first_line + slice_lines) : lines;
+          std::string& buffer = buffers[i];
+          buffer.resize(layout.offset(last_line) - layout.offset(first_line));
+          render_data_lines(&buffer[0], layout, first_line, last_line);
+        });
+        for(size_type i=0; i<n; ++i) os.write(buffers[i].data(), std::streamsize(buffers[i].size()));
       }
     }
-    // Block range check, note: blocks are ordered by address
-    // when parsing or modifying. We only check that here.
     {
-      for(size_type i=1; i<blocks_.size(); ++i) {
-        if(blocks_[i].sadr() < blocks_[i-1].sadr()) {
-          error_address_ = blocks_[i].sadr();
-          return error(e_validate_blocks_unordered);
-        } else if(blocks_[i-1].sadr() + blocks_[i-1].size() > blocks_[i].sadr()) {
-          error_address_ = blocks_[i].sadr();
-          return error(e_validate_overlapping_blocks);
-        }
-      }
+      std::string s(layout.trailer_chars, '\0');
+      render_trailer(&s[0], layout);
+      os.write(s.data(), std::streamsize(s.size()));
     }
+    os.flush();
     return true;
   }
 
   /**
-   * Returns an ordered container of blocks that are in the
-   * specified range.
+   * Recomposes a srec file into a character buffer, which must have
+   * room for at least `compose_size(line_length)` characters, e.g. a
+   * memory mapped output file. The data lines are rendered on multiple
+   * threads at their precomputed offsets. The buffer content after the
+   * composed characters is not modified.
    *
-   * @param address_type start_address
-   * @param address_type end_address
-   * @return block_container_type
+   * @param char* begin
+   * @param char* end
+   * @param size_type line_length
+   * @param unsigned threads
+   * @return bool
    */
-  inline block_container_type get_ranges(address_type start_address, address_type end_address) const
+  bool compose_parallel(char* begin, char* end, size_type line_length=0, unsigned threads=0)
   {
-    block_container_type blocks;
-    if(start_address >= end_address) return blocks;
-    for(auto& e: blocks_) {
-      block_type blk = e.get_range(start_address, end_address);
-      if(!blk.empty()) blocks.push_back(std::move(blk));
-    }
-    reorder(blocks);
-    return blocks;
+    SRECORD_STATISTICS_TIMER(statistics_.timings.compose);
+    compose_layout_type layout;
+    if(!compose_layout(layout, line_length)) return false;
+    if((!begin) || (end < begin) || (size_type(end-begin) < layout.size())) return error(e_compose_buffer_too_small);
+    SRECORD_STATISTICS(statistics_.bytes_emitted += layout.size())
+    char* const data = render_header(begin, layout);
+    const unsigned long lines = layout.data_lines();
+    const unsigned long slice_lines = (unsigned long)((size_type(1)<<20) / layout.line_chars()) + 1;
+    const unsigned long slices = (lines + slice_lines - 1) / slice_lines;
+    run_parallel(size_type(slices), threads, [&](size_type i) {
+      const unsigned long first_line = i * slice_lines;
+      const unsigned long last_line = ((first_line + slice_lines) < lines) ? (first_line + slice_lines) : lines;
+      render_data_lines(data + layout.offset(first_line), layout, first_line, last_line);
+    });
+    render_trailer(data + layout.offset(lines), layout);
+    return true;
   }
 
   /**
-   * Returns a range that starts at the address `start_address` and
-   * ends just before `end_address`. Unassigned memory ranges are
-   * filled with the value `fill_value`;
-   * @param address_type start_address
-   * @param address_type end_address
-   * @param value_type fill_value
-   * @return block_type
+   * Composed record, as yielded by the `records()` iterators: Record
+   * type, address field and data of the record, and the rendered line
+   * including the newline. The line characters are valid until the
+   * iterator is incremented or destroyed.
+   */
+  struct record_line_type
+  {
+    unsigned type;                                ///< Record type, 0 to 9.
+    address_type address;                         ///< Address field (S5/S6: data record count).
+    typename data_type::const_iterator data;      ///< Data of S0 and S1/S2/S3 records ...
+    size_type size;                               ///< ... and its number of values.
+    const char* chars;                            ///< Rendered line, including the newline ...
+    size_type length;                             ///< ... and its number of characters.
+
+    /**
+     * Returns a copy of the rendered line.
+     * @return std::string
+     */
+    std::string str() const
+    { return std::string(chars, length); }
+
+    #if(__cplusplus >= 201700L)
+    /**
+     * Returns a view of the rendered line.
+     * @return std::string_view
+     */
+    std::string_view view() const noexcept
+    { return std::string_view(chars, length); }
+    #endif
+  };
+
+  /**
+   * Range of the composed records returned by `records()`. The iterators
+   * render the record lines on demand into an iterator-owned line buffer,
+   * so that the memory usage does not depend on the image size. The record
+   * must not be modified while iterating.
+   */
+  class record_range_type
+  {
+  public:
+
+    class const_iterator
+    {
+    public:
+
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = record_line_type;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const record_line_type*;
+      using reference = const record_line_type&;
+
+      explicit const_iterator() noexcept : range_(nullptr), line_(0), block_(0), offset_(0), buffer_(), rec_()
+      {}
+
+      const_iterator(const const_iterator& o) : range_(o.range_), line_(o.line_), block_(o.block_),
+        offset_(o.offset_), buffer_(o.buffer_), rec_(o.rec_)
+      { rec_.chars = buffer_.data(); }
+
+      const_iterator& operator=(const const_iterator& o)
+      {
+        if(&o == this) return *this;
+        range_ = o.range_; line_ = o.line_; block_ = o.block_; offset_ = o.offset_;
+        buffer_ = o.buffer_; rec_ = o.rec_; rec_.chars = buffer_.data();
+        return *this;
+      }
+
+      reference operator*() const noexcept
+      { return rec_; }
+
+      pointer operator->() const noexcept
+      { return &rec_; }
+
+      const_iterator& operator++()
+      { ++line_; render(); return *this; }
+
+      const_iterator operator++(int)
+      { const_iterator it(*this); ++(*this); return it; }
+
+      bool operator==(const const_iterator& o) const noexcept
+      { return line_ == o.line_; }
+
+      bool operator!=(const const_iterator& o) const noexcept
+      { return line_ != o.line_; }
+
+    private:
+
+      friend class record_range_type;
+
+      explicit const_iterator(const record_range_type& range, unsigned long line) : range_(&range), line_(line),
+        block_(0), offset_(0), buffer_(), rec_()
+      {
+        if(line_ >= range.size()) return;
+        const basic_srecord& r = *range.record_;
+        const size_type header_size = (r.header_.size() < 12) ? 12 : r.header_.size();
+        buffer_.resize(record_chars(range.address_size_, std::max(header_size, range.data_line_length_)));
+        render();
+      }
+
+      /**
+       * Renders the record of the current line index: S0, the data
+       * records, S5/S6, and S7/S8/S9.
+       */
+      void render()
+      {
+        const record_range_type& range = *range_;
+        const basic_srecord& r = *range.record_;
+        if(line_ >= range.size()) return;
+        char* const p = &buffer_[0];
+        char* e = p;
+        rec_.data = r.header_.begin();
+        rec_.size = 0;
+        if(line_ == 0) {
+          const size_type padding = (r.header_.size() < 12) ? (12-r.header_.size()) : 0;
+          rec_.type = 0;
+          rec_.address = 0;
+          rec_.size = r.header_.size();
+          e = render_record(p, 0, 0, range.address_size_, r.header_.begin(), r.header_.size(), padding);
+        } else if(line_ <= range.data_lines_) {
+          if(line_ > 1) offset_ += range.data_line_length_;
+          while(offset_ >= r.blocks_[block_].size()) { ++block_; offset_ = 0; }
+          const block_type& block = r.blocks_[block_];
+          const size_type n = std::min(range.data_line_length_, block.size()-offset_);
+          rec_.type = unsigned(r.type_);
+          rec_.address = block.sadr() + address_type(offset_);
+          rec_.data = block.bytes().begin() + std::ptrdiff_t(offset_);
+          rec_.size = n;
+          e = range.render_data_(p, rec_.address, rec_.data, n);
+        } else if(line_ == range.data_lines_+1) {
+          const unsigned long count = range.data_lines_;
+          rec_.type = (count > 0xffffu) ? 6u : 5u;
+          rec_.address = address_type(count);
+          e = render_record(p, rec_.type, rec_.address, (count > 0xffffu) ? 3u : 2u, r.header_.begin(), 0);
+        } else {
+          rec_.type = 10u-unsigned(r.type_);
+          rec_.address = r.start_address_;
+          e = render_record(p, rec_.type, rec_.address, range.address_size_, r.header_.begin(), 0);
+        }
+        rec_.chars = p;
+        rec_.length = size_type(e-p);
+      }
+
+      const record_range_type* range_;
+      unsigned long line_;
+      size_type block_, offset_;
+      std::string buffer_;
+      record_line_type rec_;
+    };
+
+    /**
+     * Iterator of the S0 record, equal to `end()` if the record could
+     * not be composed.
+     * @return const_iterator
+     */
+    const_iterator begin() const
+    { return const_iterator(*this, 0); }
+
+    const_iterator end() const
+    { return const_iterator(*this, size()); }
+
+    /**
+     * Number of records, 0 if the record could not be composed.
+     * @return unsigned long
+     */
+    unsigned long size() const noexcept
+    { return record_ ? (data_lines_+3) : 0; }
+
+    bool empty() const noexcept
+    { return size() == 0; }
+
+  private:
+
+    friend class basic_srecord;
+
+    using render_function_type = char* (*)(char*, address_type, typename data_type::const_iterator, size_type);
+
+    explicit record_range_type() noexcept : record_(nullptr), data_line_length_(0), address_size_(0), data_lines_(0),
+      render_data_(nullptr)
+    {}
+
+    const basic_srecord* record_;
+    size_type data_line_length_;
+    unsigned address_size_;
+    unsigned long data_lines_;
+    render_function_type render_data_;
+  };
+
+  /**
+   * Returns a forward range over the composed records (S0, data records,
+   * S5/S6, S7/S8/S9) with the given line length, which are rendered one
+   * by one while iterating, e.g. to send them over a serial line. The
+   * range is empty if the record cannot be composed (the error is set
+   * accordingly). The output is identical to `compose()`.
+   *
+   * @param size_type line_length
+   * @return record_range_type
+   */
+  record_range_type records(size_type line_length=0)
+  {
+    record_range_type range;
+    if(!good() || !validate()) return range;
+    const size_type dll = compose_data_line_length(line_length);
+    unsigned long lines = 0;
+    for(const block_type& block: blocks_) lines += (unsigned long)((block.size() + dll - 1) / dll);
+    if(lines > 0xffffffu) { error(e_compose_max_number_of_data_lines_exceeded); return range; }
+    range.record_ = this;
+    range.data_line_length_ = dll;
+    range.address_size_ = unsigned(type_)+1;
+    range.data_lines_ = lines;
+    switch(range.address_size_) {
+      case 2:  range.render_data_ = &record_kernel<2>::template render_data<typename data_type::const_iterator>; break;
+      case 3:  range.render_data_ = &record_kernel<3>::template render_data<typename data_type::const_iterator>; break;
+      default: range.render_data_ = &record_kernel<4>::template render_data<typename data_type::const_iterator>; break;
+    }
+    return range;
+  }
+
+  /**
+   * Human readable dump to a defined ostream.
+   * @param std::ostream&
+   */
+  inline void dump(std::ostream& os) const
+  { dump(os, 0, std::numeric_limits<address_type>::max()); }
+
+  /**
+   * Human readable dump of the address range `start_address` to
+   * `end_address` (exclusive) to a defined ostream. The block lines
+   * show `align` values per line (even, at least 4), indented with
+   * `indent` spaces, optionally followed by an ASCII column.
+   * @param std::ostream& os
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param unsigned align
+   * @param unsigned indent
+   * @param bool ascii
+   */
+  void dump(std::ostream& os, address_type start_address, address_type end_address, unsigned align=16,
+            unsigned indent=4, bool ascii=false) const
+  {
+    align &= (~0x0001u);
+    if(align < 4) align = 4;
+    {
+      output_buffer out(os);
+      std::string text("srec {\n data type: ");
+      if(type() == 0) {
+        text += "(auto/not set)";
+      } else if(type() > 0 && type() < 4) {
+        text += 'S';
+        text += char('0' + int(type()));
+      } else {
+        text += "(invalid)";
+      }
+      text += "\n blocks: [\n";
+      out.write(text.data(), text.size());
+      const std::string empty_block = std::string(indent, ' ') + "(empty block)\n";
+      const bool normalized = known_normalized();
+      for(size_type i = normalized ? block_index_ending_after(start_address) : 0; i < blocks_.size(); ++i) {
+        const block_type& e = blocks_[i];
+        if(normalized && (e.sadr() >= end_address)) break;
+        if(e.empty()) {
+          if((e.sadr() < start_address) || (e.sadr() >= end_address)) continue;
+          out.write(empty_block.data(), empty_block.size());
+        } else {
+          const address_type sadr = std::max(e.sadr(), start_address);
+          const address_type eadr = std::min(e.eadr(), end_address);
+          if(sadr >= eadr) continue;
+          const auto data = e.bytes().begin() + std::ptrdiff_t(sadr - e.sadr());
+          dump_lines(out, sadr, data, data + std::ptrdiff_t(eadr - sadr), align, indent, ascii);
+        }
+        out.write("\n", 1);
+      }
+      out.write(" ]\n}\n", 5);
+    }
+    os.flush();
+  }
+
+  /**
+   * Human readable string dump.
+   * @return std::string
+   */
+  inline std::string dump() const
+  { std::stringstream ss; dump(ss); return ss.str(); }
+
+  /**
+   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
+   * Returns success, that is: The file path is not empty,
+   * opening the file succeeded, parsing succeeded, and
+   * file whole file was read (only contains S-Record data
+   * and no comments or the like). If parsing fails, the
+   * error is set in the instance, otherwise there was a
+   * file input error.
+   *
+   * @param std::string file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static inline bool load(std::string file_path, basic_srecord& srec)
+  { return load(file_path.c_str(), srec); }
+
+  /**
+   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
+   * Returns success, that is: The file path is not empty,
+   * opening the file succeeded, parsing succeeded, and
+   * file whole file was read (only contains S-Record data
+   * and no comments or the like). If parsing fails, the
+   * error is set in the instance, otherwise there was a
+   * file input error.
+   *
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static inline bool load(const char* file_path, basic_srecord& srec)
+  {
+    srec.clear();
+    if(!file_path || !file_path[0]) return false;
+    std::string data;
+    {
+      SRECORD_STATISTICS_TIMER(srec.statistics_.timings.io);
+      if(!read_file(file_path, data)) return false;
+    }
+    const char* p = data.data();
+    const char* const end = data.data() + data.size();
+    if(!srec.parse_buffer(p, end, true)) return false;
+    return p == end;
+  }
+
+  /**
+   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
+   * Returns a basic_srecord object containing the parsed data.
+   * On file stream error or parse error, the `error()` of the
+   * instance is set accordingly.
+   *
+   * @param const char* file_path
+   * @return basic_srecord
+   */
+  static inline basic_srecord load(const char* file_path)
+  {
+    basic_srecord srec;
+    if(!file_path || !file_path[0]) { srec.error(e_load_open_failed); return srec; }
+    std::string data;
+    {
+      SRECORD_STATISTICS_TIMER(srec.statistics_.timings.io);
+      if(!read_file(file_path, data)) { srec.error(e_load_open_failed); return srec; }
+    }
+    const char* p = data.data();
+    srec.parse_buffer(p, data.data()+data.size(), true);
+    return srec;
+  }
+
+  /**
+   * Loads an S-record file (.srec/.s19/.s28/.s37 ...).
+   * Returns a basic_srecord object containing the parsed data.
+   * On file stream error or parse error, the `error()` of the
+   * instance is set accordingly.
+   *
+   * @param std::string file_path
+   * @return basic_srecord
+   */
+  static inline basic_srecord load(std::string file_path)
+  { return load(file_path.c_str()); }
+
+  /**
+   * Loads an S-record file like `load()`, but memory-maps the file
+   * instead of reading it, so that the parser works directly on the
+   * mapped pages. On platforms without mmap support, the file is
+   * read into memory as in `load()`.
+   *
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static inline bool load_mapped(const char* file_path, basic_srecord& srec)
+  {
+    srec.clear();
+    if(!file_path || !file_path[0]) return false;
+    mapped_file file(file_path);
+    if(!file.good()) return false;
+    const char* p = file.begin();
+    if(!srec.parse_buffer(p, file.end(), true)) return false;
+    return p == file.end();
+  }
+
+  /**
+   * Loads an S-record file like `load()`, but memory-maps the file.
+   * @see bool load_mapped(const char* file_path, basic_srecord& srec)
+   * @param std::string file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static inline bool load_mapped(std::string file_path, basic_srecord& srec)
+  { return load_mapped(file_path.c_str(), srec); }
+
+  /**
+   * Loads an S-record file via memory mapping, returns a basic_srecord
+   * object containing the parsed data. On file error or parse error,
+   * the `error()` of the instance is set accordingly.
+   *
+   * @param const char* file_path
+   * @return basic_srecord
+   */
+  static inline basic_srecord load_mapped(const char* file_path)
+  {
+    basic_srecord srec;
+    load_mapped_record(file_path, srec);
+    return srec;
+  }
+
+  /**
+   * Loads an S-record file via memory mapping.
+   * @see basic_srecord load_mapped(const char* file_path)
+   * @param std::string file_path
+   * @return basic_srecord
+   */
+  static inline basic_srecord load_mapped(std::string file_path)
+  { return load_mapped(file_path.c_str()); }
+
+  /**
+   * Loads an S-record file like `load_mapped()`, and parses the
+   * mapped file using `parse_parallel()`.
+   *
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   * @param unsigned threads
+   * @return bool
+   */
+  static inline bool load_parallel(const char* file_path, basic_srecord& srec, unsigned threads=0)
+  {
+    srec.clear();
+    if(!file_path || !file_path[0]) return false;
+    mapped_file file(file_path);
+    if(!file.good()) return false;
+    const char* p = file.begin();
+    if(!srec.parse_buffer_parallel(p, file.end(), threads)) return false;
+    return p == file.end();
+  }
+
+  /**
+   * Loads an S-record file using `parse_parallel()`.
+   * @see bool load_parallel(const char* file_path, basic_srecord& srec, unsigned threads)
+   * @param std::string file_path
+   * @param basic_srecord& srec
+   * @param unsigned threads
+   * @return bool
+   */
+  static inline bool load_parallel(std::string file_path, basic_srecord& srec, unsigned threads=0)
+  { return load_parallel(file_path.c_str(), srec, threads); }
+
+  /**
+   * Loads multiple S-record files concurrently using `threads` threads
+   * (0: hardware concurrency), each file like `load_mapped(file_path)`.
+   * The threads pull the files one by one from a shared queue, largest
+   * files first, so that a huge file does not hold up the smaller ones.
+   * Returns one record per path, in the order of `paths`, each with its
+   * own `error()` and `parser_line()`.
+   *
+   * @param const std::vector<std::string>& paths
+   * @param unsigned threads
+   * @return std::vector<basic_srecord>
+   */
+  static inline std::vector<basic_srecord> load_many(const std::vector<std::string>& paths, unsigned threads=0)
+  { return load_many(paths, threads, [](size_type, const basic_srecord&){}); }
+
+  /**
+   * Loads multiple S-record files concurrently like `load_many(paths, threads)`,
+   * and calls `on_loaded(index, record)` as soon as the file `paths[index]`
+   * is loaded. The callback is invoked from the loading threads, possibly
+   * concurrently for different files. A file whose loading throws (e.g.
+   * `std::bad_alloc`) yields an empty record with the error `e_load_failed`.
+   * If the callback throws, the remaining files are still loaded, and the
+   * exception of the first path index is rethrown afterwards.
+   *
+   * @tparam typename Callback
+   * @param const std::vector<std::string>& paths
+   * @param unsigned threads
+   * @param Callback&& on_loaded
+   * @return std::vector<basic_srecord>
+   */
+  template <typename Callback>
+  static std::vector<basic_srecord> load_many(const std::vector<std::string>& paths, unsigned threads, Callback&& on_loaded)
+  {
+    std::vector<basic_srecord> records(paths.size());
+    std::vector<std::pair<std::uint64_t, size_type>> order;
+    order.reserve(paths.size());
+    for(size_type i=0; i<paths.size(); ++i) order.push_back(std::make_pair(file_size(paths[i].c_str()), i));
+    std::stable_sort(order.begin(), order.end(),
+      [](const std::pair<std::uint64_t, size_type>& a, const std::pair<std::uint64_t, size_type>& b){ return a.first > b.first; }
+    );
+    std::vector<std::exception_ptr> thrown(paths.size());
+    run_parallel(order.size(), threads, [&](size_type k) {
+      const size_type i = order[k].second;
+      try {
+        load_mapped_record(paths[i].c_str(), records[i]);
+      } catch(...) {
+        records[i].clear();
+        records[i].error(e_load_failed);
+      }
+      try {
+        on_loaded(i, static_cast<const basic_srecord&>(records[i]));
+      } catch(...) {
+        thrown[i] = std::current_exception();
+      }
+    });
+    for(const std::exception_ptr& e: thrown) {
+      if(e) std::rethrow_exception(e);
+    }
+    return records;
+  }
+
+  /**
+   * Saves a binary snapshot of the record: Header, type, start address,
+   * default value and the block table, followed by the raw block data,
+   * each aligned to 64 bytes. `source_hash` can be used to store the
+   * `source_hash()` of the S-record file the instance was loaded from,
+   * 0 means none. Returns success, the `error()` is set on failure.
+   *
+   * @param const char* file_path
+   * @param std::uint64_t source_hash
+   * @return bool
+   */
+  bool save_snapshot(const char* file_path, std::uint64_t source_hash=0)
+  {
+    if(!file_path || !file_path[0]) return error(e_snapshot_write_failed);
+    std::string head(snapshot_header_size, '\0');
+    std::memcpy(&head[0], snapshot_magic(), 8);
+    put_le(&head[8], snapshot_version, 4);
+    put_le(&head[12], std::uint64_t(type_), 4);
+    put_le(&head[16], start_address_, 8);
+    put_le(&head[24], source_hash, 8);
+    put_le(&head[32], std::uint64_t(source_hash ? 1u : 0u), 4);
+    put_le(&head[36], std::uint64_t(static_cast<unsigned char>(default_value_)), 4);
+    put_le(&head[40], std::uint64_t(header_.size()), 8);
+    put_le(&head[48], std::uint64_t(blocks_.size()), 8);
+    for(const auto c: header_) head.push_back(char(static_cast<unsigned char>(c)));
+    head.resize(snapshot_align(head.size(), 8), '\0');
+    const size_type table = head.size();
+    head.resize(table + 24*blocks_.size(), '\0');
+    std::uint64_t offset = snapshot_align(head.size(), snapshot_data_alignment);
+    for(size_type i=0; i<blocks_.size(); ++i) {
+      put_le(&head[table + 24*i +  0], blocks_[i].sadr(), 8);
+      put_le(&head[table + 24*i +  8], std::uint64_t(blocks_[i].size()), 8);
+      put_le(&head[table + 24*i + 16], offset, 8);
+      offset = snapshot_align(offset + blocks_[i].size(), snapshot_data_alignment);
+    }
+    std::ofstream fs(file_path, std::ios::out|std::ios::binary|std::ios::trunc);
+    if(!fs.good()) return error(e_snapshot_write_failed);
+    fs.write(head.data(), std::streamsize(head.size()));
+    std::uint64_t pos = head.size();
+    static const char padding[snapshot_data_alignment] = {0};
+    for(const auto& block: blocks_) {
+      const std::uint64_t aligned = snapshot_align(pos, snapshot_data_alignment);
+      fs.write(padding, std::streamsize(aligned-pos));
+      write_values(fs, search_data(block.bytes()), block.size());
+      pos = aligned + block.size();
+    }
+    fs.flush();
+    return fs.good() || error(e_snapshot_write_failed);
+  }
+
+  /**
+   * Saves a binary snapshot of the record.
+   * @see bool save_snapshot(const char* file_path, std::uint64_t source_hash)
+   * @param std::string file_path
+   * @param std::uint64_t source_hash
+   * @return bool
+   */
+  bool save_snapshot(std::string file_path, std::uint64_t source_hash=0)
+  { return save_snapshot(file_path.c_str(), source_hash); }
+
+  /**
+   * Loads a snapshot saved with `save_snapshot()`. The file is
+   * memory-mapped where supported, and each block is copied in one
+   * piece. Returns success, the `error()` of `srec` is set on failure.
+   *
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static bool load_snapshot(const char* file_path, basic_srecord& srec)
+  {
+    srec.clear();
+    if(!file_path || !file_path[0]) return srec.error(e_load_open_failed);
+    mapped_file file(file_path);
+    if(!file.good()) return srec.error(e_load_open_failed);
+    const char* const p = file.begin();
+    const std::uint64_t size = std::uint64_t(file.end() - file.begin());
+    if((size < snapshot_header_size) || (std::memcmp(p, snapshot_magic(), 8) != 0)) return srec.error(e_snapshot_invalid);
+    if(get_le(p+8, 4) != snapshot_version) return srec.error(e_snapshot_invalid);
+    const std::uint64_t type = get_le(p+12, 4);
+    const std::uint64_t header_size = get_le(p+40, 8);
+    const std::uint64_t count = get_le(p+48, 8);
+    if((type > type_s3_32bit) || (header_size > size) || (count > size/24)) return srec.error(e_snapshot_invalid);
+    const std::uint64_t table = snapshot_align(snapshot_header_size + header_size, 8);
+    if(table + 24*count > size) return srec.error(e_snapshot_invalid);
+    srec.type_ = record_type_type(type);
+    srec.start_address_ = get_le(p+16, 8);
+    srec.default_value_ = value_type(get_le(p+36, 4));
+    const unsigned char* const u = reinterpret_cast<const unsigned char*>(p);
+    srec.header_.assign(u + snapshot_header_size, u + snapshot_header_size + size_type(header_size));
+    srec.blocks_.reserve(size_type(count));
+    for(std::uint64_t i=0; i<count; ++i) {
+      const char* const entry = p + table + 24*i;
+      const std::uint64_t sadr = get_le(entry, 8), n = get_le(entry+8, 8), offset = get_le(entry+16, 8);
+      if((offset < table + 24*count) || (offset > size) || (n > size-offset)) {
+        srec.clear();
+        return srec.error(e_snapshot_invalid);
+      }
+      srec.blocks_.push_back(block_type(sadr, data_type(u+offset, u+offset+n, srec.get_allocator())));
+    }
+    srec.update_normalized();
+    return true;
+  }
+
+  /**
+   * Loads a snapshot saved with `save_snapshot()`.
+   * @see bool load_snapshot(const char* file_path, basic_srecord& srec)
+   * @param std::string file_path
+   * @param basic_srecord& srec
+   * @return bool
+   */
+  static bool load_snapshot(std::string file_path, basic_srecord& srec)
+  { return load_snapshot(file_path.c_str(), srec); }
+
+  /**
+   * Loads a snapshot, RAII variant. The `error()` of the returned
+   * instance is set on failure.
+   * @param const char* file_path
+   * @return basic_srecord
+   */
+  static basic_srecord load_snapshot(const char* file_path)
+  {
+    basic_srecord srec;
+    load_snapshot(file_path, srec);
+    return srec;
+  }
+
+  /**
+   * Loads a snapshot, RAII variant.
+   * @param std::string file_path
+   * @return basic_srecord
+   */
+  static basic_srecord load_snapshot(std::string file_path)
+  { return load_snapshot(file_path.c_str()); }
+
+  /**
+   * Loads a raw binary file as one block at `base_address`. The file is
+   * memory-mapped where supported and copied into the block in one piece.
+   * Returns success, the `error()` of `srec` is set on failure.
+   *
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   * @param address_type base_address
+   * @return bool
+   */
+  static bool load_binary(const char* file_path, basic_srecord& srec, address_type base_address=0)
+  {
+    srec.clear();
+    if(!file_path || !file_path[0]) return srec.error(e_load_open_failed);
+    SRECORD_STATISTICS_TIMER(srec.statistics_.timings.io);
+    mapped_file file(file_path);
+    if(!file.good()) return srec.error(e_load_open_failed);
+    const size_type size = size_type(file.end() - file.begin());
+    if(!size) return true;
+    if((base_address > 0x100000000ull) || (std::uint64_t(size) > (0x100000000ull - base_address))) {
+      return srec.error(e_validate_record_range_exceeded);
+    }
+    const unsigned char* const u = reinterpret_cast<const unsigned char*>(file.begin());
+    block_type block(base_address, srec.get_allocator());
+    block.bytes().assign(u, u+size);
+    srec.blocks_.push_back(std::move(block));
+    srec.data_size_ = size;
+    return srec.validate(false);
+  }
+
+  /**
+   * Loads a raw binary file as one block at `base_address`.
+   * @see bool load_binary(const char* file_path, basic_srecord& srec, address_type base_address)
+   * @param std::string file_path
+   * @param basic_srecord& srec
+   * @param address_type base_address
+   * @return bool
+   */
+  static bool load_binary(std::string file_path, basic_srecord& srec, address_type base_address=0)
+  { return load_binary(file_path.c_str(), srec, base_address); }
+
+  /**
+   * Loads a raw binary file, RAII variant. The `error()` of the returned
+   * instance is set on failure.
+   * @param const char* file_path
+   * @param address_type base_address
+   * @return basic_srecord
+   */
+  static basic_srecord load_binary(const char* file_path, address_type base_address=0)
+  {
+    basic_srecord srec;
+    load_binary(file_path, srec, base_address);
+    return srec;
+  }
+
+  /**
+   * Loads a raw binary file, RAII variant.
+   * @param std::string file_path
+   * @param address_type base_address
+   * @return basic_srecord
+   */
+  static basic_srecord load_binary(std::string file_path, address_type base_address=0)
+  { return load_binary(file_path.c_str(), base_address); }
+
+  /**
+   * Saves the range from `start_address` to just before `end_address`
+   * as raw binary file, unassigned addresses are written as the
+   * `default_value()`. Block data is written directly, without copies.
+   * Returns success, the `error()` is set on failure.
+   *
+   * @param const char* file_path
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return bool
+   */
+  bool save_binary(const char* file_path, address_type start_address, address_type end_address)
+  {
+    if(!file_path || !file_path[0]) return error(e_binary_write_failed);
+    std::ofstream fs(file_path, std::ios::out|std::ios::binary|std::ios::trunc);
+    if(!fs.good()) return error(e_binary_write_failed);
+    if(start_address < end_address) {
+      char fill[4096];
+      std::memset(fill, static_cast<unsigned char>(default_value_), sizeof(fill));
+      for(const auto& span: view(start_address, end_address)) {
+        if(!span.fill()) {
+          write_values(fs, span_data(span), span.size());
+          continue;
+        }
+        for(size_type n = span.size(); n;) {
+          const size_type k = std::min(n, sizeof(fill));
+          fs.write(fill, std::streamsize(k));
+          n -= k;
+        }
+      }
+    }
+    fs.flush();
+    return fs.good() || error(e_binary_write_failed);
+  }
+
+  /**
+   * Saves the whole data range (`sadr()` to `eadr()`) as raw binary file.
+   * @param const char* file_path
+   * @return bool
+   */
+  bool save_binary(const char* file_path)
+  { return save_binary(file_path, sadr(), eadr()); }
+
+  /**
+   * Saves a range as raw binary file.
+   * @see bool save_binary(const char* file_path, address_type start_address, address_type end_address)
+   * @param std::string file_path
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return bool
+   */
+  bool save_binary(std::string file_path, address_type start_address, address_type end_address)
+  { return save_binary(file_path.c_str(), start_address, end_address); }
+
+  /**
+   * Saves the whole data range as raw binary file.
+   * @param std::string file_path
+   * @return bool
+   */
+  bool save_binary(std::string file_path)
+  { return save_binary(file_path.c_str()); }
+
+  /**
+   * 64 bit content hash of S-record source data, as stored in snapshots
+   * to detect outdated snapshot files. Four interleaved multiply-xorshift
+   * lanes over native 64 bit words, so that hashing is significantly
+   * faster than parsing. Not a cryptographic hash.
+   * @param const char* begin
+   * @param const char* end
+   * @return std::uint64_t
+   */
+  static std::uint64_t source_hash(const char* begin, const char* end) noexcept
+  {
+    constexpr std::uint64_t k = 0x9e3779b97f4a7c15ull;
+    if(end < begin) end = begin;
+    std::uint64_t h[4] = { k, k^1u, k^2u, k^3u }, t = std::uint64_t(end-begin) * k;
+    for(; end-begin >= 32; begin += 32) {
+      for(unsigned i=0; i<4; ++i) {
+        std::uint64_t w;
+        std::memcpy(&w, begin+8*i, sizeof(w));
+        h[i] = (h[i] ^ w) * k;
+        h[i] ^= h[i] >> 29;
+      }
+    }
+    for(; begin < end; ++begin) t = (t ^ std::uint64_t(static_cast<unsigned char>(*begin))) * 0x100000001b3ull;
+    for(unsigned i=0; i<4; ++i) { t = (t ^ h[i]) * k; t ^= t >> 32; }
+    return t;
+  }
+
+  /**
+   * Content hash of a file, see `source_hash(const char*, const char*)`.
+   * Returns false if the file could not be read.
+   * @param const char* file_path
+   * @param std::uint64_t& hash
+   * @return bool
+   */
+  static bool source_hash(const char* file_path, std::uint64_t& hash)
+  {
+    if(!file_path || !file_path[0]) return false;
+    mapped_file file(file_path);
+    if(!file.good()) return false;
+    hash = source_hash(file.begin(), file.end());
+    return true;
+  }
+
+  /**
+   * Returns true if the snapshot file has a source hash matching the
+   * current content of the S-record file `source_path`, without parsing
+   * the S-record.
+   * @param const char* snapshot_path
+   * @param const char* source_path
+   * @return bool
+   */
+  static bool snapshot_matches(const char* snapshot_path, const char* source_path)
+  {
+    if(!snapshot_path || !snapshot_path[0]) return false;
+    char head[snapshot_header_size];
+    std::ifstream fs(snapshot_path, std::ios::in|std::ios::binary);
+    if(!fs.read(head, std::streamsize(sizeof(head)))) return false;
+    if((std::memcmp(head, snapshot_magic(), 8) != 0) || (get_le(head+8, 4) != snapshot_version) || (!(get_le(head+32, 4) & 1u))) return false;
+    std::uint64_t hash = 0;
+    return source_hash(source_path, hash) && (hash == get_le(head+24, 8));
+  }
+
+  /**
+   * Returns true if the snapshot file matches the S-record file.
+   * @see bool snapshot_matches(const char* snapshot_path, const char* source_path)
+   * @param std::string snapshot_path
+   * @param std::string source_path
+   * @return bool
+   */
+  static bool snapshot_matches(std::string snapshot_path, std::string source_path)
+  { return snapshot_matches(snapshot_path.c_str(), source_path.c_str()); }
+
+  /**
+   * Checks if the current "image" saved in the
+   * instance is ok. If no address width type is set,
+   * it sets this type implicitly to the minimum possible
+   * address type (means S1/S2/S3).
+   * @param bool strict =true
+   * @return bool
+   */
+  bool validate(bool strict=true)
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.validate);
+    if(!good()) return false;
+    const bool normalized = known_normalized();
+    // Check/set address type. Normalized blocks are ordered, so that
+    // the last block has the highest end address.
+    {
+      record_type_type type = type_s1_16bit;
+      const auto first = (normalized && !blocks_.empty()) ? (blocks_.end()-1) : blocks_.begin();
+      for(auto it = first; it != blocks_.end(); ++it) {
+        if(it->eadr() > 0x100000000ull) { return error(e_validate_record_range_exceeded); }
+        if(it->eadr() > 0x001000000ull) { type = type_s3_32bit; break; }
+        if(it->eadr() > 0x000010000ull) { type = type_s2_24bit;        }
+      }
+      if(type_ == type_undefined) {
+        type_ = type;
+      } else if(type_ < type) {
+        if(strict) {
+          return error(e_validate_record_type_to_small);
+        } else {
+          type_ = type;
+        }
+      }
+    }
+    // Variable checks
+    {
+      if((type_ < type_s1_16bit) || (type_ > type_s3_32bit)) {
+        return error(e_validate_record_type_to_small);
+      }
+      if(blocks_.empty()) {
+        return error(e_validate_no_binary_data);
+      }
+    }
+    // Block range check, note: blocks are ordered by address
+    // when parsing or modifying. We only check that here, unless
+    // the blocks are known to be normalized.
+    if(!normalized) {
+      for(size_type i=1; i<blocks_.size(); ++i) {
+        if(blocks_[i].sadr() < blocks_[i-1].sadr()) {
+          error_address_ = blocks_[i].sadr();
+          return error(e_validate_blocks_unordered);
+        } else if(blocks_[i-1].sadr() + blocks_[i-1].size() > blocks_[i].sadr()) {
+          error_address_ = blocks_[i].sadr();
+          return error(e_validate_overlapping_blocks);
+        }
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Returns a read-only view of the range from `start_address` to just
+   * before `end_address`, without copying data. Iterating the view yields
+   * ordered spans, which refer to the block data or are unassigned
+   * ranges reading as `fill_value`. Overlapping blocks are resolved in
+   * favour of the block with the higher start address.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param value_type fill_value
+   * @return view_type
+   */
+  inline view_type view(address_type start_address, address_type end_address, value_type fill_value) const
+  { return view_type(*this, start_address, end_address, fill_value); }
+
+  /**
+   * Returns a read-only view of the range from `start_address` to just
+   * before `end_address`, where unassigned ranges read as `default_value()`.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return view_type
+   */
+  inline view_type view(address_type start_address, address_type end_address) const
+  { return view(start_address, end_address, default_value()); }
+
+  /**
+   * Returns the CRC-32 (IEEE 802.3, as zlib) of the range from `start_address`
+   * to just before `end_address`. Unassigned addresses count as `default_value()`,
+   * without being materialised. The digests of blocks completely in the range
+   * are cached in the blocks and only recalculated for modified blocks.
+   * Note: The block caches are updated, so concurrent calls on the same
+   * instance must be synchronised.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return std::uint32_t
+   */
+  std::uint32_t crc32(address_type start_address, address_type end_address) const
+  { return range_digest(crc_kernel<std::uint32_t, 0xedb88320u>::instance(), 0, start_address, end_address); }
+
+  /**
+   * Returns the CRC-32C (Castagnoli) of the range from `start_address` to
+   * just before `end_address`, using the SSE4.2 or ARMv8 CRC instructions
+   * where available.
+   * @see std::uint32_t crc32(address_type start_address, address_type end_address) const
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return std::uint32_t
+   */
+  std::uint32_t crc32c(address_type start_address, address_type end_address) const
+  { return range_digest(crc_kernel<std::uint32_t, 0x82f63b78u>::instance(), 1, start_address, end_address); }
+
+  /**
+   * Returns a 64 bit digest (CRC-64/XZ) of the range from `start_address`
+   * to just before `end_address`.
+   * @see std::uint32_t crc32(address_type start_address, address_type end_address) const
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return std::uint64_t
+   */
+  std::uint64_t hash64(address_type start_address, address_type end_address) const
+  { return range_digest(crc_kernel<std::uint64_t, 0xc96c5795d7870f42ull>::instance(), 2, start_address, end_address); }
+
+  /**
+   * Returns an ordered container of blocks that are in the
+   * specified range.
+   *
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return block_container_type
+   */
+  inline block_container_type get_ranges(address_type start_address, address_type end_address) const
+  {
+    block_container_type blocks(blocks_.get_allocator());
+    if(start_address >= end_address) return blocks;
+    if(known_normalized()) {
+      for(size_type i=block_index_ending_after(start_address); (i < blocks_.size()) && (blocks_[i].sadr() < end_address); ++i) {
+        blocks.push_back(blocks_[i].get_range(start_address, end_address));
+      }
+      return blocks;
+    }
+    for(auto& e: blocks_) {
+      block_type blk = e.get_range(start_address, end_address);
+      if(!blk.empty()) blocks.push_back(std::move(blk));
+    }
+    reorder(blocks);
+    return blocks;
+  }
+
+  /**
+   * Returns a range that starts at the address `start_address` and
+   * ends just before `end_address`. Unassigned memory ranges are
+   * filled with the value `fill_value`;
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param value_type fill_value
+   * @return block_type
    */
   inline block_type get_range(address_type start_address, address_type end_address, value_type fill_value) const
   {
-    block_container_type blocks = get_ranges(start_address, end_address);
-    const bool no_match = blocks.empty();
-    block_type block = connect(std::move(blocks), fill_value);
-    if(no_match) block.sadr(start_address);
-    extend(block, start_address, end_address, fill_value);
-    return block;
+    if(known_normalized()) {
+      block_type block(start_address, get_allocator());
+      const view_type range = view(start_address, end_address, fill_value);
+      block.bytes().resize(range.size());
+      range.copy(block.bytes().begin());
+      return block;
+    }
+    block_container_type blocks = get_ranges(start_address, end_address);
+    const bool no_match = blocks.empty();
+    block_type block = connect(std::move(blocks), fill_value);
+    if(no_match) block.sadr(start_address);
+    extend(block, start_address, end_address, fill_value);
+    return block;
+  }
+
+  /**
+   * Returns a range that starts at the address `start_address` and
+   * ends just before `end_address`. Unassigned memory ranges are
+   * filled with the `default_value()`.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return block_type
+   */
+  inline block_type get_range(address_type start_address, address_type end_address) const
+  { return get_range(start_address, end_address, default_value()); }
+
+  /**
+   * Copies the contents of a given block to the appropriate
+   * position. Extends the instance address range if needed,
+   * overwrites existing blocks. Might merge and rearrange
+   * blocks, means drop pointers or references to blocks
+   * after using this method.
+   * @param block_type&& block
+   * @return basic_srecord&
+   */
+  basic_srecord& set_range(block_type&& block)
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.set_range);
+    SRECORD_STATISTICS_BLOCKS(*this, 1);
+    if(blocks_exposed_ || !normalized_) update_normalized();
+    if(normalized_) {
+      if(!block.empty()) {
+        set_range_normalized(std::move(block));
+        return *this;
+      } else if(!blocks_.empty()) {
+        return *this;
+      }
+    }
+    // The easy cases: No existing blocks are affected
+    {
+      bool affected = false;
+      for(auto &e: blocks_) {
+        if(e.in_range(block.sadr(), block.eadr())) {
+          affected = true;
+          break;
+        }
+      }
+      if(!affected) {
+        blocks_.push_back(std::move(block));
+        reorder(blocks_);
+        connect_adjacent_blocks();
+        update_normalized();
+        return *this;
+      }
+    }
+    // The normal cases: Existing blocks are affected. Determmine first and last affected block.
+    reorder(blocks_);
+    size_type i_first = 0;
+    while(i_first < blocks_.size() && !blocks_[i_first].in_range(block.sadr(), block.eadr()) ) {
+      ++i_first;
+    }
+    size_type i_last = blocks_.size()-1;
+    while(i_last && !blocks_[i_last].in_range(block.sadr(), block.eadr()) ) {
+      --i_last;
+    }
+    // All all blocks except the first and the last will be overwritten anyway.
+    for(size_type i = i_first+1; i < i_last; ++i) {
+      blocks_[i].bytes().clear();
+    }
+    block_type before = blocks_[i_first].get_range(blocks_[i_first].sadr(), block.sadr());
+    block_type after  = blocks_[i_last].get_range(block.eadr(), blocks_[i_last].eadr());
+    blocks_[i_first].bytes().clear();
+    blocks_[i_last].bytes().clear();
+    blocks_.push_back(std::move(before));
+    blocks_.push_back(std::move(block));
+    blocks_.push_back(std::move(after));
+    remove_empty_blocks();
+    reorder(blocks_);
+    connect_adjacent_blocks();
+    update_normalized();
+    return *this;
+  }
+
+  /**
+   * Copies the contents of a given block to the appropriate
+   * position. Extends the instance address range if needed,
+   * overwrites existing blocks. Might merge and re-arrange
+   * blocks, means drop pointers or references to blocks
+   * after using this method.
+   * @param const block_type& block
+   * @return basic_srecord&
+   */
+  inline basic_srecord& set_range(const block_type& block)
+  { block_type blk = block; return set_range(std::move(blk)); }
+
+  /**
+   * Copies the contents of given byte data to the appropriate
+   * address. Extends the instance address range if needed,
+   * overwrites existing blocks. Might merge and re-arrange
+   * blocks, means drop pointers or references to blocks
+   * after using this method.
+   * @param address_type address
+   * @param const data_type& data
+   * @return basic_srecord&
+   */
+  inline basic_srecord& set_range(address_type address, data_type&& data)
+  { block_type blk(address, get_allocator()); blk.bytes(std::move(data)); return set_range(std::move(blk)); }
+
+  /**
+   * Copies the contents of given byte data to the appropriate
+   * address. Extends the instance address range if needed,
+   * overwrites existing blocks. Might merge and rearrange
+   * blocks, means drop pointers or references to blocks
+   * after using this method.
+   * @param address_type address
+   * @param const data_type& data
+   * @return basic_srecord&
+   */
+  inline basic_srecord& set_range(address_type address, const data_type& data)
+  { block_type blk(address, data, get_allocator()); return set_range(std::move(blk)); }
+
+  /**
+   * Copies the contents of given values of another container type to
+   * the appropriate address. Extends the instance address range if
+   * needed, overwrites existing blocks. Might merge and re-arrange
+   * blocks, means drop pointers or references to blocks after using
+   * this method.
+   * @tparam typename Container
+   * @param address_type address
+   * @param const Container& data
+   * @return basic_srecord&
+   */
+  template<typename Container>
+  inline typename std::enable_if<
+    std::is_same<typename Container::value_type, value_type>::value && !std::is_same<Container, data_type>::value,
+    basic_srecord&
+  >::type set_range(address_type address, const Container& data)
+  {
+    if(data.empty()) return *this;
+    return set_range(address, data_type(data.begin(), data.end(), get_allocator()));
+  }
+
+  /**
+   * Removes an address range from the srecord. Might split and
+   * rearrange blocks, means you should drop pointers or references
+   * to blocks after using this method.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return basic_srecord&
+   */
+  basic_srecord& remove_range(address_type start_address, address_type end_address)
+  {
+    if((start_address >= end_address) || blocks_.empty()) return *this;
+    if(blocks_exposed_ || !normalized_) update_normalized();
+    if(normalized_) {
+      remove_range_normalized(start_address, end_address);
+      return *this;
+    }
+    size_type i_first = blocks_.size();
+    size_type i;
+    for(i = 0; i < blocks_.size(); ++i) {
+      if(blocks_[i].in_range(start_address, end_address)) {
+        i_first = i;
+        break;
+      }
+    }
+    if(i_first >= blocks_.size()) return *this;
+    size_type i_last = i_first;
+    for(i = i_first; i < blocks_.size(); ++i) {
+      if(!blocks_[i].in_range(start_address, end_address)) break;
+      i_last = i;
+    }
+    if(i_last >= blocks_.size()) {
+      i_last = blocks_.size() - 1;
+    }
+    if(i_first == i_last) {
+      i = i_first;
+      if(blocks_[i].sadr() == start_address) {
+        // Aligned to begin, just shrink the block
+        shrink_to(blocks_[i], end_address, blocks_[i].eadr());
+        if(blocks_[i].empty()) remove_empty_blocks();
+      } else if(blocks_[i].eadr() == end_address) {
+        // Aligned to end, also shrink
+        shrink_to(blocks_[i], blocks_[i].sadr(), start_address);
+        if(blocks_[i].empty()) remove_empty_blocks();
+      } else {
+        // otherwise split it.
+        block_type blk(get_allocator());
+        blk.swap(blocks_[i]);
+        blocks_[i] = blk.get_range(blk.sadr(), start_address);
+        blk = blk.get_range(end_address, blk.eadr());
+        blocks_.push_back(std::move(blk));
+        remove_empty_blocks();
+        reorder(blocks_);
+      }
+    } else {
+      i = i_first + 1;
+      while(i < i_last) {
+        blocks_[i++].clear();
+      }
+      {
+        block_type& blk = blocks_[i_first];
+        if(start_address == blk.sadr()) {
+          blk.clear();
+        } else {
+          blk = blk.get_range(blk.sadr(), start_address);
+        }
+      }
+      {
+        block_type& blk = blocks_[i_last];
+        if(end_address == blk.eadr()) {
+          blk.clear();
+        } else {
+          blk = blk.get_range(end_address, blk.eadr());
+        }
+      }
+      remove_empty_blocks();
+      reorder(blocks_);
+    }
+    update_normalized();
+    return *this;
+  }
+
+  /**
+   * Batch of range modifications, obtained with `begin_edit()`. Writes
+   * and removals are queued and applied with `commit()`, where later
+   * modifications overwrite earlier ones (last write wins), and the
+   * block list is rebuilt once. Uncommitted modifications are discarded
+   * when the transaction is destroyed or assigned. A moved-from transaction
+   * has no record, its `commit()` fails.
+   */
+  class transaction_type
+  {
+  public:
+
+    explicit transaction_type(basic_srecord& rec) noexcept : rec_(&rec), edits_()
+    {}
+
+    transaction_type(transaction_type&& tx) noexcept : rec_(tx.rec_), edits_(std::move(tx.edits_))
+    { tx.rec_ = nullptr; tx.edits_.clear(); }
+
+    transaction_type& operator=(transaction_type&& tx) noexcept
+    {
+      if(&tx == this) return *this;
+      rec_ = tx.rec_; edits_ = std::move(tx.edits_);
+      tx.rec_ = nullptr; tx.edits_.clear();
+      return *this;
+    }
+
+    transaction_type(const transaction_type&) = delete;
+    transaction_type& operator=(const transaction_type&) = delete;
+
+  public:
+
+    /**
+     * Queues writing `data` at `address`.
+     * @param address_type address
+     * @param data_type&& data
+     * @return transaction_type&
+     */
+    transaction_type& set_range(address_type address, data_type&& data)
+    {
+      if(!data.empty()) {
+        const address_type eadr = address + address_type(data.size());
+        edits_.push_back(edit_type{address, eadr, false, std::move(data)});
+      }
+      return *this;
+    }
+
+    /**
+     * Queues writing `data` at `address`.
+     * @param address_type address
+     * @param const data_type& data
+     * @return transaction_type&
+     */
+    transaction_type& set_range(address_type address, const data_type& data)
+    { return set_range(address, copy_data(data)); }
+
+    /**
+     * Queues writing the data of a block.
+     * @param const block_type& block
+     * @return transaction_type&
+     */
+    transaction_type& set_range(const block_type& block)
+    { return set_range(block.sadr(), copy_data(block.bytes())); }
+
+    /**
+     * Queues removing an address range.
+     * @param address_type start_address
+     * @param address_type end_address
+     * @return transaction_type&
+     */
+    transaction_type& remove_range(address_type start_address, address_type end_address)
+    {
+      if(start_address < end_address) edits_.push_back(edit_type{start_address, end_address, true, data_type()});
+      return *this;
+    }
+
+    /**
+     * Returns the number of queued modifications.
+     * @return size_type
+     */
+    size_type size() const noexcept
+    { return edits_.size(); }
+
+    /**
+     * Returns true if no modifications are queued.
+     * @return bool
+     */
+    bool empty() const noexcept
+    { return edits_.empty(); }
+
+    /**
+     * Drops all queued modifications.
+     */
+    void discard() noexcept
+    { edits_.clear(); }
+
+    /**
+     * Applies all queued modifications to the record, the transaction
+     * is empty afterwards and can be reused. Returns false (and drops
+     * the modifications) if the transaction was moved from.
+     * @return bool
+     */
+    bool commit()
+    {
+      if(!rec_) { edits_.clear(); return false; }
+      rec_->commit_edits(edits_);
+      edits_.clear();
+      return true;
+    }
+
+  private:
+
+    /**
+     * Returns a copy of `data`, allocated with the allocator of the record.
+     * @param const data_type& data
+     * @return data_type
+     */
+    data_type copy_data(const data_type& data) const
+    { return rec_ ? data_type(data.begin(), data.end(), rec_->get_allocator()) : data_type(data); }
+
+  private:
+
+    basic_srecord* rec_;              ///< Modified record.
+    std::vector<edit_type> edits_;    ///< Queued modifications.
+  };
+
+  /**
+   * Starts a batch of range modifications.
+   * @see transaction_type
+   * @return transaction_type
+   */
+  transaction_type begin_edit() noexcept
+  { return transaction_type(*this); }
+
+  /**
+   * Decoded data record (S1/S2/S3) of a `reader_type`.
+   */
+  struct data_record_type
+  {
+    explicit data_record_type() noexcept : type(type_undefined), address(0), size(0), data()
+    {}
+
+    address_type eadr() const noexcept
+    { return address + size; }
+
+    record_type_type type;    ///< Data record type.
+    address_type address;     ///< Address of the first data byte.
+    size_type size;           ///< Number of data bytes.
+    value_type data[256];     ///< Data bytes.
+  };
+
+  /**
+   * Record level reader, yields the data records of an S-record
+   * stream or buffer one by one, with O(line) memory. Header, type,
+   * start address, line number and errors are available as settings
+   * of a record without blocks. The checks of `parse()` are applied,
+   * the reader stops at the first error.
+   */
+  class reader_type;
+
+  /**
+   * Record level writer, composes S-record output from data written
+   * in address order, with O(line) memory: Contiguous data are packed
+   * into lines of the configured line length, the data record count
+   * (S5/S6) and the start address record are written on `finish()`.
+   * The output is identical to `compose()` of a record with the same
+   * data and settings.
+   */
+  class writer_type;
+
+  /**
+   * Incremental push parser for chunked input (serial lines, sockets):
+   * Characters are passed in arbitrary chunks using `feed()`, partial
+   * lines are kept between calls. Data records are either collected as
+   * blocks of `record()`, or passed to a callback as they complete. Like
+   * `parse()`, the record ends at the next S0 (or non-S line if not
+   * `single_file_stream`), which is then available as `remainder()`.
+   */
+  class parser_type;
+
+  /**
+   * Immutable flat image of a record: The data of all blocks in one
+   * contiguous arena, and a sorted table of block start addresses and
+   * arena offsets. All methods are const without internal caches, so a
+   * frozen image can be read from any number of threads without locking.
+   * Lookups are binary searches in the start address table.
+   */
+  class frozen_type;
+
+  /**
+   * Returns an immutable flat copy of the record data and settings. The
+   * shared pointer can be published to reader threads, e.g. with
+   * `std::atomic_store()`, and replaced when a new image is available.
+   * @return std::shared_ptr<const frozen_type>
+   */
+  std::shared_ptr<const frozen_type> freeze() const
+  { return std::make_shared<const frozen_type>(*this); }
+
+  /**
+   * Stages of `transform()`, applied in the order they are added,
+   * followed by the output settings.
+   *
+   *  srecord::transform_type tf;
+   *  tf.offset(0x1000).crop(0x08001000, 0x08011000).type(srecord::type_s3_32bit).line_length(74);
+   */
+  class transform_type
+  {
+  public:
+
+    enum class stage_kind { offset, crop, remove, fill };
+
+    struct stage_type
+    {
+      stage_kind kind;          ///< Stage operation.
+      address_type sadr;        ///< Range start (crop/remove/fill), or the offset.
+      address_type eadr;        ///< Range end (crop/remove/fill).
+      bool negative;            ///< Offset direction.
+      value_type value;         ///< Fill value.
+    };
+
+    explicit transform_type() : stages_(), type_(type_undefined), line_length_(0)
+    {}
+
+    /**
+     * Relocates all data and the start address by `offset` (can be negative).
+     * @param long long offset
+     * @return transform_type&
+     */
+    transform_type& offset(long long offset)
+    {
+      const bool negative = offset < 0;
+      const address_type distance = negative ? (address_type(0)-address_type(offset)) : address_type(offset);
+      stages_.push_back(stage_type{stage_kind::offset, distance, 0, negative, value_type()});
+      return *this;
+    }
+
+    /**
+     * Drops all data outside the range [start_address, end_address).
+     * @param address_type start_address
+     * @param address_type end_address
+     * @return transform_type&
+     */
+    transform_type& crop(address_type start_address, address_type end_address)
+    { stages_.push_back(stage_type{stage_kind::crop, start_address, end_address, false, value_type()}); return *this; }
+
+    /**
+     * Drops all data in the range [start_address, end_address).
+     * @param address_type start_address
+     * @param address_type end_address
+     * @return transform_type&
+     */
+    transform_type& remove(address_type start_address, address_type end_address)
+    { stages_.push_back(stage_type{stage_kind::remove, start_address, end_address, false, value_type()}); return *this; }
+
+    /**
+     * Fills unassigned addresses in the range [start_address, end_address)
+     * with `fill_value`. As the data are streamed, gaps are filled in front
+     * of data located after all preceding data, means for address ordered
+     * input.
+     * @param address_type start_address
+     * @param address_type end_address
+     * @param value_type fill_value
+     * @return transform_type&
+     */
+    transform_type& fill(address_type start_address, address_type end_address, value_type fill_value)
+    { stages_.push_back(stage_type{stage_kind::fill, start_address, end_address, false, fill_value}); return *this; }
+
+    /**
+     * Output data record type, `type_undefined` (default) keeps the input type.
+     * @param record_type_type type
+     * @return transform_type&
+     */
+    transform_type& type(record_type_type type) noexcept
+    { type_ = type; return *this; }
+
+    /**
+     * Output line length, see `compose()`.
+     * @param size_type line_length
+     * @return transform_type&
+     */
+    transform_type& line_length(size_type line_length) noexcept
+    { line_length_ = line_length; return *this; }
+
+    const std::vector<stage_type>& stages() const noexcept
+    { return stages_; }
+
+    record_type_type type() const noexcept
+    { return type_; }
+
+    size_type line_length() const noexcept
+    { return line_length_; }
+
+  private:
+
+    std::vector<stage_type> stages_;  ///< Stages in application order.
+    record_type_type type_;           ///< Output data record type.
+    size_type line_length_;           ///< Output line length.
+  };
+
+  /**
+   * Streaming transformation: Reads the S-record from `is` record by
+   * record, applies the stages of `tf` and writes the result to `os`,
+   * without holding the image in memory. Header, type, start address,
+   * parser line and errors are set in this instance, the blocks are
+   * cleared. Returns success.
+   *
+   * @param std::istream& is
+   * @param std::ostream& os
+   * @param const transform_type& tf
+   * @return bool
+   */
+  bool transform(std::istream& is, std::ostream& os, const transform_type& tf)
+  {
+    const bool strict = strict_parsing();
+    clear();
+    reader_type reader(is, strict);
+    writer_type writer(os, tf.type(), tf.line_length());
+    std::vector<address_type> fills(tf.stages().size(), 0);
+    for(size_type i=0; i<fills.size(); ++i) fills[i] = tf.stages()[i].sadr;
+    data_record_type rec;
+    bool first = true;
+    while(reader.next(rec)) {
+      if(first) {
+        first = false;
+        if(tf.type() == type_undefined) writer.type(reader.settings().type());
+        writer.header(reader.settings().header_);
+      }
+      if(!transform_data(tf, 0, rec.address, rec.data, rec.size, fills, writer)) return false;
+    }
+    const basic_srecord& settings = reader.settings();
+    parser_line_ = settings.parser_line_;
+    header_ = settings.header_;
+    if(!settings.good()) return error(settings.error());
+    for(size_type i=0; i<fills.size(); ++i) {
+      const auto& stage = tf.stages()[i];
+      if((stage.kind == transform_type::stage_kind::fill) && (fills[i] < stage.eadr)) {
+        if(!transform_fill(tf, i+1, fills[i], stage.eadr, stage.value, fills, writer)) return false;
+      }
+    }
+    address_type start_address = settings.start_address_;
+    for(const auto& stage: tf.stages()) {
+      if(stage.kind != transform_type::stage_kind::offset) continue;
+      start_address = stage.negative ? (start_address - stage.sadr) : (start_address + stage.sadr);
+    }
+    type_ = writer.type();
+    start_address_ = start_address;
+    if(!writer.finish(start_address)) return error(writer.error());
+    return true;
+  }
+
+  /**
+   * Connects all blocks of this instance to one block, applying a `fill_value`
+   * in unassigned ranges. Overlapping blocks implicitly overwrite, where the
+   * overlapping contents of later blocks overwrite the overlapping ranges of
+   * earlier blocks.
+   * @param value_type fill_value
+   * @return basic_srecord&
+   */
+  inline basic_srecord& merge(value_type fill_value)
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.merge);
+    SRECORD_STATISTICS_BLOCKS(*this, 0);
+    SRECORD_STATISTICS(if(blocks_.size() > 1) ++statistics_.allocations)
+    block_container_type blks(blocks_.get_allocator());
+    blocks_.swap(blks);
+    blocks_.push_back(connect(std::move(blks), fill_value));
+    update_normalized();
+    return *this;
+  }
+
+  /**
+   * Connects all blocks of this instance to one block, applying the instance
+   * `default_value()` to fill unassigned ranges. Overlapping blocks implicitly
+   * overwrite, where the overlapping contents of later blocks overwrite the
+   * overlapping ranges of earlier blocks.
+   * @return basic_srecord&
+   */
+  inline basic_srecord& merge()
+  { return merge(default_value()); }
+
+  /**
+   * Address range from `sadr` to just before `eadr`, as returned by `diff()`.
+   */
+  struct address_range_type
+  {
+    address_type sadr;
+    address_type eadr;
+
+    address_type size() const noexcept
+    { return eadr - sadr; }
+
+    bool operator==(const address_range_type& r) const noexcept
+    { return (sadr == r.sadr) && (eadr == r.eadr); }
+
+    bool operator!=(const address_range_type& r) const noexcept
+    { return !operator==(r); }
+  };
+
+  using address_ranges_type = std::vector<address_range_type>;
+
+  /**
+   * Returns the ordered, non-adjacent address ranges where the contents of
+   * `a` and `b` differ. Unassigned addresses read as the `default_value()`
+   * of the respective record. With a `granularity` greater than 1 (e.g. a
+   * flash sector or page size), the ranges are extended to multiples of it.
+   * Data are compared word-wise. Blocks at the same address and with the
+   * same size are skipped without comparing if both have matching cached
+   * `hash64()` digests.
+   * @param const basic_srecord& a
+   * @param const basic_srecord& b
+   * @param address_type granularity
+   * @return address_ranges_type
+   */
+  static address_ranges_type diff(const basic_srecord& a, const basic_srecord& b, address_type granularity=1)
+  {
+    address_ranges_type ranges;
+    address_type sadr = 0, eadr = 0;
+    {
+      address_type s = 0, e = 0;
+      const bool has_a = a.data_extent(sadr, eadr), has_b = b.data_extent(s, e);
+      if(!has_a && !has_b) return ranges;
+      if(!has_a) { sadr = s; eadr = e; }
+      else if(has_b) { sadr = std::min(sadr, s); eadr = std::max(eadr, e); }
+    }
+    size_type ia = a.view_block_index(sadr), ib = b.view_block_index(sadr);
+    for(address_type adr = sadr; adr < eadr;) {
+      const span_type sa = a.view_span(adr, eadr, a.default_value_, ia);
+      const span_type sb = b.view_span(adr, eadr, b.default_value_, ib);
+      const address_type end = std::min(sa.eadr(), sb.eadr());
+      const size_type n = size_type(end - adr);
+      if(sa.fill() && sb.fill()) {
+        if(!(sa.value() == sb.value())) add_diff_range(ranges, adr, end, granularity);
+      } else if(sa.fill()) {
+        diff_values(fill_values_type(sa.value()), data_values(span_data(sb)), n, adr, granularity, ranges);
+      } else if(sb.fill()) {
+        diff_values(data_values(span_data(sa)), fill_values_type(sb.value()), n, adr, granularity, ranges);
+      } else if(!same_cached_block(a, ia, b, ib, adr, end)) {
+        diff_values(data_values(span_data(sa)), data_values(span_data(sb)), n, adr, granularity, ranges);
+      }
+      adr = end;
+    }
+    return ranges;
+  }
+
+  /**
+   * Copies the contents of `source` in the given `ranges` (e.g. from `diff()`)
+   * into this instance. Addresses unassigned in `source` are removed. Applying
+   * `diff(a, b)` from `b` to `a` hence results in the contents of `b`, and
+   * applying it to an empty record results in a patch image only containing
+   * the changed ranges.
+   * @param const basic_srecord& source
+   * @param const address_ranges_type& ranges
+   * @return basic_srecord&
+   */
+  basic_srecord& apply_diff(const basic_srecord& source, const address_ranges_type& ranges)
+  {
+    for(const auto& range: ranges) {
+      if(range.sadr >= range.eadr) continue;
+      remove_range(range.sadr, range.eadr);
+      for(const auto& span: source.view(range.sadr, range.eadr)) {
+        if(span.fill()) continue;
+        set_range(span.sadr(), data_type(span.begin(), span.end(), get_allocator()));
+      }
+    }
+    return *this;
+  }
+
+  /**
+   * Returns the address of the first byte where the `sequence`
+   * was found, or `end()` if the sequence was not found at all.
+   * @param const data_type& sequence
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find(const data_type& sequence, address_type start_address=0) const
+  { return find_first(search_pattern_type(sequence, nullptr), start_address); }
+
+  /**
+   * Masked search: Returns the address of the first byte where the bytes
+   * match the `sequence` in all bits set in the corresponding `mask` byte
+   * (0xff: exact byte match, 0x00: wildcard), or `end()` if not found.
+   * `mask` must have the same size as `sequence`.
+   * @param const data_type& sequence
+   * @param const data_type& mask
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find(const data_type& sequence, const data_type& mask, address_type start_address=0) const
+  { return find_first(search_pattern_type(sequence, &mask), start_address); }
+
+  /**
+   * Invokes `fn(address_type)` for each address where the `sequence` was
+   * found, in ascending order, overlapping matches included. Returns the
+   * number of matches.
+   * @tparam MatchFunction
+   * @param const data_type& sequence
+   * @param MatchFunction&& fn
+   * @param address_type start_address
+   * @return size_type
+   */
+  template <typename MatchFunction>
+  size_type find_all(const data_type& sequence, MatchFunction&& fn, address_type start_address=0) const
+  {
+    size_type n = 0;
+    search(search_pattern_type(sequence, nullptr), start_address, [&](address_type adr){ ++n; fn(adr); return true; });
+    return n;
+  }
+
+  /**
+   * Masked `find_all()`, see the masked `find()`.
+   * @tparam MatchFunction
+   * @param const data_type& sequence
+   * @param const data_type& mask
+   * @param MatchFunction&& fn
+   * @param address_type start_address
+   * @return size_type
+   */
+  template <typename MatchFunction>
+  size_type find_all(const data_type& sequence, const data_type& mask, MatchFunction&& fn, address_type start_address=0) const
+  {
+    size_type n = 0;
+    search(search_pattern_type(sequence, &mask), start_address, [&](address_type adr){ ++n; fn(adr); return true; });
+    return n;
+  }
+
+  /**
+   * Returns the number of (possibly overlapping) occurrences of
+   * the `sequence`.
+   * @param const data_type& sequence
+   * @param address_type start_address
+   * @return size_type
+   */
+  size_type count(const data_type& sequence, address_type start_address=0) const
+  { return find_all(sequence, [](address_type){}, start_address); }
+
+  /**
+   * Masked `count()`, see the masked `find()`.
+   * @param const data_type& sequence
+   * @param const data_type& mask
+   * @param address_type start_address
+   * @return size_type
+   */
+  size_type count(const data_type& sequence, const data_type& mask, address_type start_address=0) const
+  { return find_all(sequence, mask, [](address_type){}, start_address); }
+
+  #if(__cplusplus >= 201700L)
+
+  enum class endianess_type { little_endian, big_endian };
+
+  /**
+   * Returns the endianess interpretet value from a given start address, or
+   * an empty optional if the range of the given address and the data type
+   * is smaller than the data type.
+   * @tparam IntegralType
+   * @param address_type address
+   * @param endianess_type endianess
+   * @return std::optional<ValueType>
+   */
+  template <typename IntegralType>
+  std::optional<IntegralType> get(address_type address, endianess_type endianess) const
+  {
+    static_assert(std::is_integral<IntegralType>::value, "get<> only for integers, use <cstdint> types.");
+    using itype = IntegralType;
+    constexpr size_type size = sizeof(itype);
+    if constexpr (size==1) {
+      (void)endianess;
+      if(known_normalized()) {
+        const size_type i = block_index_ending_after(address);
+        if((i < blocks_.size()) && (blocks_[i].sadr() <= address)) {
+          return std::optional<itype>(blocks_[i].bytes()[size_type(address-blocks_[i].sadr())]);
+        }
+        return std::optional<itype>();
+      }
+      for(const auto& block:blocks_) {
+        if((address >= block.sadr()) && (address < block.eadr())) {
+          return std::optional<itype>(block.bytes()[size_type(address-block.sadr())]);
+        }
+      }
+      return std::optional<itype>();
+    } else {
+      auto r = std::optional<itype>();
+      value_type data[size];
+      size_type n = 0;
+      for(const auto& span: view(address, address+size)) {
+        if(span.fill()) return r; // there is a gap.
+        for(const auto b: span) data[n++] = b;
+      }
+      if(n != size) return r;
+      auto value = itype(0);
+      switch(endianess) {
+        case endianess_type::big_endian: {
+          for(size_type i=0; i<size; ++i) value = (value<<8)|itype(data[i]);
+          r = value;
+          break;
+        }
+        case endianess_type::little_endian: {
+          for(auto i=int(size)-1; i>=0; --i) value = (value<<8)|itype(data[i]);
+          r = value;
+          break;
+        }
+        default:
+          break;
+      }
+      return r;
+    }
+  }
+
+  /**
+   * Writes the bytes at a specified address according to a given value with a given endianess.
+   * @tparam IntegralType
+   * @param address_type address
+   * @param endianess_type endianess
+   * @param IntegralType value
+   * @return basic_srecord&
+   */
+  template <typename IntegralType>
+  basic_srecord& set(address_type address, endianess_type endianess, const IntegralType value)
+  {
+    static_assert(std::is_integral<IntegralType>::value, "set<> only for integers, use <cstdint> types.");
+    using itype = typename std::decay<IntegralType>::type;
+    constexpr size_type size = sizeof(itype);
+    data_type data(size, 0);
+    if constexpr (size==1) {
+      (void)endianess;
+      data[0] = static_cast<typename data_type::value_type>(value);
+    } else {
+      itype val = value;
+      for(auto i=int(size)-1; i>=0; --i) {
+        data[i] = typename data_type::value_type(val & 0xff);
+        val >>= 8;
+      }
+      switch(endianess) {
+        case endianess_type::little_endian:
+          std::reverse(data.begin(), data.end());
+          break;
+        default:
+          break;
+      }
+    }
+    return set_range(address, data);
+  }
+
+  /**
+   * Returns `count` consecutive values of type `T` (integral or floating
+   * point) starting at `address`, converted from the given endianess, or
+   * an empty optional if the range is not completely assigned. The range is
+   * looked up once and copied in bulk, the byte order is swapped in place.
+   * @tparam T
+   * @param address_type address
+   * @param size_type count
+   * @param endianess_type endianess
+   * @return std::optional<std::vector<T>>
+   */
+  template <typename T>
+  std::optional<std::vector<T>> get_array(address_type address, size_type count, endianess_type endianess) const
+  {
+    static_assert(std::is_arithmetic<T>::value, "get_array<> only for integral and floating point types.");
+    static_assert(sizeof(value_type) == 1, "get_array<> requires a byte value type.");
+    auto r = std::optional<std::vector<T>>();
+    const size_type size = count * sizeof(T);
+    if((count > size_type(std::numeric_limits<address_type>::max()/sizeof(T))) || (address_type(size) > (std::numeric_limits<address_type>::max()-address))) return r;
+    std::vector<T> values(count);
+    unsigned char* dst = reinterpret_cast<unsigned char*>(values.data());
+    if(known_normalized()) {
+      const size_type i = block_index_ending_after(address);
+      if((i >= blocks_.size()) || (blocks_[i].sadr() > address) || (blocks_[i].eadr() < address+size)) return r;
+      const auto src = search_data(blocks_[i].bytes()) + size_type(address-blocks_[i].sadr());
+      std::copy(src, src+size, dst);
+    } else {
+      size_type n = 0;
+      for(const auto& span: view(address, address+size)) {
+        if(span.fill()) return r; // there is a gap.
+        dst = std::copy(span.begin(), span.end(), dst);
+        n += span.size();
+      }
+      if(n != size) return r;
+    }
+    if(swapped_byte_order(endianess)) swap_byte_order<sizeof(T)>(reinterpret_cast<unsigned char*>(values.data()), count);
+    r = std::move(values);
+    return r;
+  }
+
+  /**
+   * Writes `count` values of type `T` (integral or floating point) starting
+   * at `address` with the given endianess. Ranges inside an existing block
+   * are written in place, everything else with one `set_range()`.
+   * @tparam T
+   * @param address_type address
+   * @param const T* values
+   * @param size_type count
+   * @param endianess_type endianess
+   * @return basic_srecord&
+   */
+  template <typename T>
+  basic_srecord& set_array(address_type address, const T* values, size_type count, endianess_type endianess)
+  {
+    static_assert(std::is_arithmetic<T>::value, "set_array<> only for integral and floating point types.");
+    static_assert(sizeof(value_type) == 1, "set_array<> requires a byte value type.");
+    const size_type size = count * sizeof(T);
+    if((!count) || (!values)) return *this;
+    const bool swap = swapped_byte_order(endianess);
+    if(blocks_exposed_) update_normalized();
+    if(normalized_) {
+      const size_type i = block_index_ending_after(address);
+      if((i < blocks_.size()) && (blocks_[i].sadr() <= address) && (size <= size_type(blocks_[i].eadr()-address))) {
+        SRECORD_STATISTICS_TIMER(statistics_.timings.set_range);
+        store_array(data_pointer(blocks_[i].bytes()) + size_type(address-blocks_[i].sadr()), values, count, swap);
+        return *this;
+      }
+    }
+    data_type data(size, value_type(0), get_allocator());
+    store_array(data_pointer(data), values, count, swap);
+    return set_range(address, std::move(data));
+  }
+
+  /**
+   * Writes the values of a contiguous container (`std::vector`, `std::array`,
+   * `std::span`, ...) starting at `address` with the given endianess.
+   * @tparam Contiguous
+   * @param address_type address
+   * @param const Contiguous& values
+   * @param endianess_type endianess
+   * @return basic_srecord&
+   */
+  template <typename Contiguous>
+  basic_srecord& set_array(address_type address, const Contiguous& values, endianess_type endianess)
+  { return set_array(address, std::data(values), size_type(std::size(values)), endianess); }
+
+  #endif
+
+private:
+
+  /**
+   * Merges blocks. Fills unassigned ranges in between with with `fill_value`.
+   * @param block_container_type&& blocks
+   * @return block_type
+   */
+  static block_type connect(block_container_type&& blocks, value_type fill_value)
+  {
+    block_type block{allocator_type(blocks.get_allocator())};
+    if(blocks.empty()) return block;
+    if(blocks.size() < 2) return std::move(blocks.front());
+    reorder(blocks);
+    // The final range is known in advance: Each block is cut at the start of
+    // its successor, gaps are filled. One allocation, bulk copies and fills.
+    block.sadr(blocks.front().sadr());
+    const size_type size = size_type(blocks.back().eadr() - blocks.front().sadr());
+    if(!size) return block;
+    data_type& bytes = block.bytes();
+    reserve_data(bytes, size, 0);
+    for(size_type i=0; i<blocks.size(); ++i) {
+      const block_type& blk = blocks[i];
+      const address_type eadr = ((i+1) < blocks.size()) ? blocks[i+1].sadr() : blk.eadr();
+      const size_type n = size_type(std::min(eadr, blk.eadr()) - blk.sadr());
+      bytes.insert(bytes.end(), blk.bytes().begin(), blk.bytes().begin() + n);
+      if(eadr > blk.eadr()) bytes.insert(bytes.end(), size_type(eadr - blk.eadr()), fill_value);
+      blocks[i].clear();
+    }
+    return block;
+  }
+
+  /**
+   * Reorders blocks, so that the start addresses are sorted
+   * ascending.
+   * @param block_container_type& blocks
+   */
+  static inline void reorder(block_container_type& blocks)
+  {
+    if(blocks.size() < 2) return;
+    std::sort(blocks.begin(), blocks.end(), [](const block_type& a, const block_type& b){
+      return a.sadr() < b.sadr();
+    });
+  }
+
+  /**
+   * Extends a block to a given start/end address, filling the unassigned
+   * bytes with a `fill_value`. Note: This function does not shrink the
+   * block.
+   * @param block_type& block
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param value_type fill_value
+   * @return block_type
+   */
+  static void extend(block_type& block, address_type start_address, address_type end_address, value_type fill_value)
+  {
+    if(start_address >= end_address) return;
+    data_type& bytes = block.bytes();
+    if(start_address < block.sadr()) {
+      bytes.insert(bytes.begin(), size_type(block.sadr() - start_address), fill_value);
+      block.sadr(start_address);
+    }
+    if(end_address > block.eadr()) {
+      bytes.insert(bytes.end(), size_type(end_address - block.eadr()), fill_value);
+    }
+  }
+
+  /**
+   * Shrinks a block to a given start/end address
+   * @param block_type& block
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return block_type
+   */
+  static void shrink_to(block_type& block, address_type start_address, address_type end_address)
+  {
+    if(start_address >= end_address) {
+      block.sadr(block.eadr());
+      block.bytes().clear();
+      return;
+    } else {
+      data_type& bytes = block.bytes();
+      const size_type size = ((end_address-start_address) <= bytes.size()) ? (end_address-start_address) : bytes.size();
+      if(start_address > block.sadr()) {
+        const size_type offset = std::min(size_type(start_address - block.sadr()), bytes.size());
+        bytes.erase(bytes.begin(), bytes.begin() + offset);
+        block.sadr(start_address);
+      }
+      if(size < bytes.size()) bytes.resize(size);
+    }
+  }
+
+  /**
+   * Returns a c-string of an error code.
+   *
+   * @param error_type e
+   * @return const char*
+   */
+  static const char* strerr(error_type e)
+  {
+    static const char* es[] = {
+      "Ok",
+      "[parse] Unacceptable character",
+      "[parse] Line not starting with S",
+      "[parse] Invalid line length",
+      "[parse] Invalid record type",
+      "[parse] Line checksum mismatch",
+      "[parse] Line data length mismatch",
+      "[parse] Missing record header (S0)",
+      "[parse] S0 address field is nonzero",
+      "[parse] Duplicate S5/S6 line found",
+      "[parse] Number of data lines does not match the declaration (S5/S6)",
+      "[parse] Duplicate start address specification (S7/S8/S9)",
+      "[parse] Missing start address line (S7/S8/S9)",
+      "[parse] Missing data lines (S1/S2/S3)",
+      "[parse] Mixed data types in one record (S1/S2/S3)",
+      "[compose] The output has too many data lines for the S5/S6 line data.",
+      "[validate] The specified record type (S1/S2/S3) is to small for the needed data address range.",
+      "[validate] The data range exceeds the greatest possible address of an s-record.",
+      "[validate] No binary data blocks to write found in a record.",
+      "[validate] Unordered data blocks detected",
+      "[validate] Overlapping data blocks detected (address range collision)",
+      "[load] Opening file failed",
+      "[compose] The output buffer is too small.",
+      "[snapshot] Writing the snapshot file failed",
+      "[snapshot] Invalid or incompatible snapshot file",
+      "[parse] Line not starting with ':' (Intel HEX)",
+      "[parse] Missing end of file record (Intel HEX)",
+      "[save] Writing the binary file failed",
+      "[load] Loading the file failed (exception)",
+      ""
+    };
+    return (e < sizeof(es)/sizeof(const char*)) ? es[e] : "unknown error";
+  };
+
+  /**
+   * Returns true if `c` is a whitespace character (locale independent
+   * equivalent of `::isspace()` in the "C" locale).
+   * @param char c
+   * @return bool
+   */
+  static inline bool is_space(char c) noexcept
+  { return (c == ' ') || ((c >= '\t') && (c <= '\r')); }
+
+  /**
+   * Returns the position of the first non-whitespace character
+   * in the range, or `end`.
+   * @param const char* p
+   * @param const char* end
+   * @return const char*
+   */
+  static inline const char* skip_space(const char* p, const char* const end) noexcept
+  { while((p < end) && is_space(*p)) ++p; return p; }
+
+  /**
+   * Size of a file in bytes, 0 if it could not be opened.
+   * @param const char* file_path
+   * @return std::uint64_t
+   */
+  static std::uint64_t file_size(const char* file_path)
+  {
+    std::ifstream fs(file_path, std::ios::in|std::ios::binary|std::ios::ate);
+    const std::streamoff size = fs.good() ? std::streamoff(fs.tellg()) : std::streamoff(0);
+    return (size > 0) ? std::uint64_t(size) : 0u;
+  }
+
+  /**
+   * Loads a memory mapped S-record file into the empty `srec`, sets
+   * `e_load_open_failed` if the file could not be opened.
+   * @param const char* file_path
+   * @param basic_srecord& srec
+   */
+  static void load_mapped_record(const char* file_path, basic_srecord& srec)
+  {
+    if(!file_path || !file_path[0]) { srec.error(e_load_open_failed); return; }
+    mapped_file file(file_path);
+    if(!file.good()) { srec.error(e_load_open_failed); return; }
+    const char* p = file.begin();
+    srec.parse_buffer(p, file.end(), true);
+  }
+
+  /**
+   * Reads a whole file into `data`. Returns false if the file
+   * could not be opened.
+   * @param const char* file_path
+   * @param std::string& data
+   * @return bool
+   */
+  static bool read_file(const char* file_path, std::string& data)
+  {
+    std::ifstream fs(file_path, std::ios::in|std::ios::binary);
+    if(!fs.good()) return false;
+    data.clear();
+    fs.seekg(0, std::ios::end);
+    const std::streamoff size = fs.tellg();
+    fs.seekg(0, std::ios::beg);
+    if((size > 0) && fs.good()) {
+      data.resize(size_type(size));
+      fs.read(&data[0], std::streamsize(size));
+      data.resize(size_type(fs.gcount()));
+    } else {
+      // Not seekable, read chunkwise.
+      fs.clear();
+      char buffer[4096];
+      while(fs.read(buffer, sizeof(buffer)) || fs.gcount()) data.append(buffer, size_type(fs.gcount()));
+    }
+    return true;
+  }
+
+  /**
+   * Snapshot file format: Fixed header (magic, version, type, start address,
+   * source hash, flags, default value, header size, block count), S0 data,
+   * block table (address, size, file offset), aligned block data. All
+   * numbers little endian.
+   */
+  static constexpr size_type snapshot_header_size = 64;
+  static constexpr size_type snapshot_data_alignment = 64;
+  static constexpr std::uint64_t snapshot_version = 1;
+
+  static const char* snapshot_magic() noexcept
+  { return "SRECSNAP"; }
+
+  static constexpr std::uint64_t snapshot_align(std::uint64_t n, std::uint64_t alignment) noexcept
+  { return (n + alignment - 1) & ~(alignment - 1); }
+
+  static void put_le(char* p, std::uint64_t value, unsigned size) noexcept
+  { for(unsigned i=0; i<size; ++i, value >>= 8) p[i] = char(value & 0xff); }
+
+  static std::uint64_t get_le(const char* p, unsigned size) noexcept
+  {
+    std::uint64_t value = 0;
+    while(size) value = (value << 8) | std::uint64_t(static_cast<unsigned char>(p[--size]));
+    return value;
+  }
+
+  /**
+   * Writes `n` values as bytes, contiguous byte data in one piece.
+   */
+  template <typename Iterator>
+  static void write_values(std::ostream& os, Iterator data, size_type n)
+  {
+    char buffer[4096];
+    while(n) {
+      const size_type k = std::min(n, sizeof(buffer));
+      for(size_type i=0; i<k; ++i, ++data) buffer[i] = char(static_cast<unsigned char>(*data));
+      os.write(buffer, std::streamsize(k));
+      n -= k;
+    }
+  }
+
+  static void write_values(std::ostream& os, const value_type* data, size_type n)
+  {
+    if(sizeof(value_type) != 1) {
+      write_values<const value_type*>(os, data, n);
+    } else if(n) {
+      os.write(reinterpret_cast<const char*>(data), std::streamsize(n));
+    }
+  }
+
+  /**
+   * Read-only file mapping (RAII). Falls back to reading the file
+   * into memory where mmap is not available.
+   */
+  class mapped_file
+  {
+  public:
+
+    explicit mapped_file(const char* file_path) : good_(false), data_(nullptr), size_(0), buffer_()
+    {
+      #ifdef SRECORD_WITH_MMAP
+      const int fd = ::open(file_path, O_RDONLY);
+      if(fd < 0) return;
+      struct ::stat st;
+      if((::fstat(fd, &st) == 0) && S_ISREG(st.st_mode)) {
+        size_ = size_type(st.st_size);
+        if(!size_) {
+          good_ = true;
+        } else {
+          void* const p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+          if(p != MAP_FAILED) {
+            data_ = static_cast<const char*>(p);
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            good_ = true;
+          }
+        }
+      }
+      ::close(fd);
+      if(good_) return;
+      size_ = 0;
+      #endif
+      good_ = read_file(file_path, buffer_);
+    }
+
+    ~mapped_file()
+    {
+      #ifdef SRECORD_WITH_MMAP
+      if(data_) ::munmap(const_cast<char*>(data_), size_);
+      #endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    bool good() const noexcept
+    { return good_; }
+
+    const char* begin() const noexcept
+    { return data_ ? data_ : buffer_.data(); }
+
+    const char* end() const noexcept
+    { return data_ ? (data_+size_) : (buffer_.data()+buffer_.size()); }
+
+  private:
+
+    bool good_;           ///< Opening/mapping succeeded.
+    const char* data_;    ///< Mapped memory, or nullptr if the buffer is used.
+    size_type size_;      ///< Mapped size.
+    std::string buffer_;  ///< Fallback read buffer.
+  };
+
+  /**
+   * Parses all lines of a character buffer. `pos` is updated to
+   * the position where parsing stopped, that is `end` if the whole
+   * buffer was consumed, or the beginning of the line that terminated
+   * the record (next S0, or a non-S line if not `single_file_stream`).
+   *
+   * @param const char*& pos
+   * @param const char* end
+   * @param bool single_file_stream
+   * @return bool
+   */
+  bool parse_buffer(const char*& pos, const char* const end, const bool single_file_stream)
+  {
+    clear();
+    parse_state_type state;
+    line_type rec;
+    while(pos < end) {
+      const char* const line = pos;
+      const char* line_end = static_cast<const char*>(std::memchr(line, '\n', size_type(end-line)));
+      if(!line_end) line_end = end;
+      pos = (line_end < end) ? (line_end+1) : end;
+      ++parser_line_;
+      const char* const s = skip_space(line, line_end);
+      if(s == line_end) continue;
+      if((!single_file_stream) && (*s != 'S' && *s != 's')) {
+        pos = line;
+        break;
+      } else if(!parse_line(s, line_end, rec)) {
+        break;
+      } else if(!parse_record(state, rec)) {
+        // That's already the next S0 --> stop in front of it.
+        pos = line;
+        break;
+      }
+    }
+    parse_finish(state);
+    reorder(blocks_);
+    update_normalized();
+    return good() && validate(strict_parsing());
+  }
+
+  /**
+   * Minimum chunk size for `parse_buffer_parallel()`.
+   */
+  static constexpr size_type parallel_min_chunk_size = size_type(1)<<18;
+
+  /**
+   * Runs `fn(index)` for all indices in [0, n), distributed over `threads`
+   * threads including the calling thread. The indices are pulled one by
+   * one, so that uneven workloads are balanced. If no threads can be
+   * started the calling thread processes all indices. Returns false if
+   * `fn` threw an exception for any index.
+   *
+   * @tparam typename Fn
+   * @param size_type n
+   * @param unsigned threads
+   * @param Fn&& fn
+   * @return bool
+   */
+  template <typename Fn>
+  static bool run_parallel(const size_type n, unsigned threads, Fn&& fn)
+  {
+    #if !defined(WITHOUT_SRECORD_THREADS)
+    if(!threads) threads = std::thread::hardware_concurrency();
+    if(threads > n) threads = unsigned(n);
+    std::atomic<size_type> next(0);
+    std::atomic<bool> ok(true);
+    const auto worker = [&]() {
+      for(size_type i=next++; i<n; i=next++) {
+        try { fn(i); } catch(...) { ok = false; }
+      }
+    };
+    std::vector<std::thread> pool;
+    try {
+      for(unsigned i=1; i<threads; ++i) pool.emplace_back(worker);
+    } catch(...) {
+      // No more threads available, the running ones and this thread take over.
+    }
+    worker();
+    for(auto& t: pool) t.join();
+    return ok;
+    #else
+    (void)threads;
+    bool ok = true;
+    for(size_type i=0; i<n; ++i) {
+      try { fn(i); } catch(...) { ok = false; }
+    }
+    return ok;
+    #endif
+  }
+
+  /**
+   * Decodes all lines of a chunk into chunk-local blocks. Stops at the
+   * first irregularity, as the chunk is then parsed sequentially anyway.
+   * @param parse_chunk_type& chunk
+   */
+  static void parse_chunk(parse_chunk_type& chunk)
+  {
+    line_type rec;
+    const char* pos = chunk.begin;
+    const char* const end = chunk.end;
+    bool has_records = false;
+    while(pos < end) {
+      const char* const line = pos;
+      const char* line_end = static_cast<const char*>(std::memchr(line, '\n', size_type(end-line)));
+      if(!line_end) line_end = end;
+      pos = (line_end < end) ? (line_end+1) : end;
+      ++chunk.lines;
+      const char* const s = skip_space(line, line_end);
+      if(s == line_end) continue;
+      if(decode_line(s, line_end, rec) != e_ok) { chunk.regular = false; return; }
+      SRECORD_STATISTICS(++chunk.statistics.lines[rec.type])
+      const bool first = !has_records;
+      has_records = true;
+      if(rec.type == 0) {
+        if(!first) { chunk.regular = false; return; }
+        chunk.leading_s0 = true;
+        chunk.header.assign(rec.data(), rec.data()+rec.size);
+      } else if(rec.type < 4) {
+        if(chunk.type == type_undefined) {
+          chunk.type = record_type_type(rec.type);
+        } else if(rec.type != chunk.type) {
+          chunk.regular = false;
+          return;
+        }
+        block_container_type& blocks = chunk.blocks;
+        SRECORD_STATISTICS(chunk.statistics.bytes_decoded += rec.size)
+        if((!blocks.empty()) && (rec.address == blocks.back().eadr())) {
+          data_type& bytes = blocks.back().bytes();
+          #ifdef WITH_SRECORD_STATISTICS
+          const size_type capacity = bytes.capacity();
+          #endif
+          bytes.insert(bytes.end(), rec.data(), rec.data()+rec.size);
+          SRECORD_STATISTICS(++chunk.statistics.blocks_coalesced; if(bytes.capacity() != capacity) ++chunk.statistics.reallocations)
+        } else if(blocks.empty() || (rec.address > blocks.back().eadr())) {
+          SRECORD_STATISTICS(++chunk.statistics.blocks_created; ++chunk.statistics.allocations)
+          blocks.push_back(block_type(rec.address, data_type(rec.data(), rec.data()+rec.size)));
+        } else {
+          chunk.regular = false;
+          return;
+        }
+        ++chunk.count;
+      } else if(rec.type < 7) {
+        ++chunk.specs;
+        chunk.spec_count = long(rec.address);
+      } else {
+        ++chunk.starts;
+        chunk.start_type = rec.type;
+        chunk.start_after_data = (chunk.count > 0);
+        chunk.start_address = rec.address;
+      }
+    }
+  }
+
+  /**
+   * Parallel variant of `parse_buffer()` with single file stream
+   * semantics, `pos` is updated accordingly.
+   *
+   * @param const char*& pos
+   * @param const char* end
+   * @param unsigned threads
+   * @return bool
+   */
+  bool parse_buffer_parallel(const char*& pos, const char* const end, unsigned threads)
+  {
+    #if !defined(WITHOUT_SRECORD_THREADS)
+    if(!threads) threads = std::thread::hardware_concurrency();
+    #endif
+    const size_type size = (pos < end) ? size_type(end-pos) : 0;
+    if((threads < 2) || (size < 2*parallel_min_chunk_size)) {
+      return parse_buffer(pos, end, true);
+    }
+    // Split at line boundaries, some chunks more than threads for balancing.
+    std::vector<parse_chunk_type> chunks;
+    {
+      size_type n = 4 * size_type(threads);
+      if(n > size/parallel_min_chunk_size) n = size/parallel_min_chunk_size;
+      const size_type chunk_size = size/n;
+      const char* p = pos;
+      while(p < end) {
+        chunks.emplace_back();
+        chunks.back().begin = p;
+        const char* e = ((size_type(end-p)) > (chunk_size + chunk_size/2)) ? (p+chunk_size) : end;
+        if(e < end) {
+          e = static_cast<const char*>(std::memchr(e, '\n', size_type(end-e)));
+          e = e ? (e+1) : end;
+        }
+        chunks.back().end = e;
+        p = e;
+      }
+    }
+    {
+      SRECORD_STATISTICS_TIMER(statistics_.timings.decode);
+      if(!run_parallel(chunks.size(), threads, [&chunks](size_type i){ parse_chunk(chunks[i]); })) {
+        return parse_buffer(pos, end, true);
+      }
+    }
+    // Check if the chunks can be stitched, otherwise the sequential parser
+    // deterministically yields the first error and the correct line.
+    parse_state_type state;
+    {
+      bool regular = chunks.front().leading_s0;
+      unsigned specs = 0, starts = 0;
+      const parse_chunk_type* last_data = nullptr;
+      for(const parse_chunk_type& chunk: chunks) {
+        if((!regular) || (!chunk.regular) || ((&chunk != &chunks.front()) && chunk.leading_s0)) { regular = false; break; }
+        if(chunk.type != type_undefined) {
+          if((state.type != type_undefined) && (chunk.type != state.type)) { regular = false; break; }
+          if(last_data && (chunk.blocks.front().sadr() < last_data->blocks.back().eadr())) { regular = false; break; }
+          state.type = chunk.type;
+          last_data = &chunk;
+        }
+        if(chunk.starts) {
+          const bool after_data = (state.count > 0) || chunk.start_after_data;
+          if(!after_data || (strict_parsing() && (chunk.start_type != 10u-state.type))) { regular = false; break; }
+        }
+        state.count += chunk.count;
+        specs += chunk.specs;
+        starts += chunk.starts;
+        if(chunk.specs) state.spec_count = chunk.spec_count;
+      }
+      if((!regular) || (state.type == type_undefined) || (specs > 1) || (starts > 1) || (specs && !state.spec_count)) {
+        return parse_buffer(pos, end, true);
+      }
+      state.records = 1; // S0 present
+      state.found_s0 = true;
+      state.have_type = true;
+      state.have_start_address = (starts > 0);
+    }
+    // Stitch
+    clear();
+    type_ = state.type;
+    header_ = std::move(chunks.front().header);
+    for(parse_chunk_type& chunk: chunks) {
+      parser_line_ += chunk.lines;
+      SRECORD_STATISTICS(statistics_ += chunk.statistics)
+      if(chunk.starts) start_address_ = chunk.start_address;
+      auto it = chunk.blocks.begin();
+      if(it == chunk.blocks.end()) continue;
+      if((!blocks_.empty()) && (it->sadr() == blocks_.back().eadr())) {
+        data_type& bytes = blocks_.back().bytes();
+        bytes.insert(bytes.end(), it->bytes().begin(), it->bytes().end());
+        SRECORD_STATISTICS(++statistics_.blocks_coalesced; --statistics_.blocks_created; ++statistics_.reallocations)
+        ++it;
+      }
+      for(; it != chunk.blocks.end(); ++it) blocks_.push_back(std::move(*it));
+      block_container_type().swap(chunk.blocks);
+    }
+    pos = end;
+    parse_finish(state);
+    update_normalized();
+    return good() && validate(strict_parsing());
+  }
+
+  /**
+   * Parse a line. The range may contain whitespaces, which
+   * are ignored.
+   *
+   * @param const char* begin
+   * @param const char* end
+   * @param line_type& rec
+   * @return bool
+   */
+  inline bool parse_line(const char* const begin, const char* const end, line_type& rec)
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.decode);
+    if(!good()) return false;
+    return error(decode_line(begin, end, rec));
+  }
+
+  /**
+   * Hex character lookup table: nibble value for [0-9A-Fa-f], the
+   * legacy value of ('S'-'A'+10) for 'S'/'s' (acceptable character,
+   * but not a hex digit), `lut_space` for whitespaces, and `lut_invalid`
+   * for all other characters.
+   * @return const signed char*
+   */
+  static const signed char* hex_lut() noexcept
+  {
+    static const signed char lut[256] = {
+      -2,-2,-2,-2,-2,-2,-2,-2,-2,-1,-1,-1,-1,-1,-2,-2, -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -1,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,  0, 1, 2, 3, 4, 5, 6, 7, 8, 9,-2,-2,-2,-2,-2,-2,
+      -2,10,11,12,13,14,15,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,28,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -2,10,11,12,13,14,15,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,28,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+      -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2, -2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,-2,
+    };
+    return lut;
+  }
+
+  static constexpr signed char lut_space = -1;    ///< hex_lut() value of whitespaces.
+  static constexpr signed char lut_invalid = -2;  ///< hex_lut() value of unacceptable characters.
+
+  /**
+   * Decodes 16 hex digits at `p` into 8 bytes at `out`. Returns false
+   * (and nothing is written) if any of the 16 characters is not a hex
+   * digit, the caller continues with the scalar path then.
+   * @param const char* p
+   * @param unsigned char* out
+   * @return bool
+   */
+  static inline bool decode_hex16(const char* p, unsigned char* out) noexcept
+  {
+    #if defined(SRECORD_WITH_SSE2)
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0'-1)), _mm_cmplt_epi8(v, _mm_set1_epi8('9'+1)));
+    const __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a'-1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f'+1)));
+    if(_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha)) != 0xffff) return false;
+    const __m128i nibbles = _mm_or_si128(
+      _mm_and_si128(is_digit, _mm_sub_epi8(v, _mm_set1_epi8('0'))),
+      _mm_andnot_si128(is_digit, _mm_sub_epi8(lower, _mm_set1_epi8('a'-10)))
+    );
+    // 16 bit lanes: high nibble in the low byte, low nibble in the high byte.
+    const __m128i bytes = _mm_or_si128(
+      _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4),
+      _mm_srli_epi16(nibbles, 8)
+    );
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(bytes, bytes));
+    return true;
+    #elif defined(SRECORD_WITH_NEON)
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    const uint8x16_t digit = vsubq_u8(v, vdupq_n_u8('0'));
+    const uint8x16_t alpha = vsubq_u8(vorrq_u8(v, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+    const uint8x16_t is_digit = vcleq_u8(digit, vdupq_n_u8(9));
+    const uint8x16_t is_alpha = vcleq_u8(alpha, vdupq_n_u8(5));
+    if(vminvq_u8(vorrq_u8(is_digit, is_alpha)) != 0xff) return false;
+    const uint8x16_t nibbles = vbslq_u8(is_digit, digit, vaddq_u8(alpha, vdupq_n_u8(10)));
+    const uint8x8x2_t pairs = vuzp_u8(vget_low_u8(nibbles), vget_high_u8(nibbles));
+    vst1_u8(out, vorr_u8(vshl_n_u8(pairs.val[0], 4), pairs.val[1]));
+    return true;
+    #else
+    (void)p; (void)out;
+    return false;
+    #endif
+  }
+
+  /**
+   * Line decode kernel. Validates the characters, decodes the hex
+   * pairs into a stack buffer, accumulates the checksum and checks
+   * the length in one pass. Whitespaces in the range are ignored.
+   * Returns the parse error (or e_ok), the check precedence is:
+   * unacceptable character, line start, record type, line length,
+   * checksum, byte count, address field.
+   *
+   * @param const char* p
+   * @param const char* end
+   * @param line_type& rec
+   * @return error_type
+   */
+  static error_type decode_line(const char* p, const char* const end, line_type& rec)
+  {
+    const signed char* const lut = hex_lut();
+    unsigned char* const bin = rec.buffer; // count, address, data, checksum (+ SIMD slack).
+    constexpr size_type max_bytes = 256;
+    char tag[2] = {0,0};
+    size_type length = 0; // Significant (non-whitespace) characters.
+    size_type n = 0;      // Decoded bytes.
+    unsigned sum = 0;     // Sum of all decoded bytes, including the checksum.
+    // Record tag "Sx"
+    while((p < end) && (length < 2)) {
+      const char c = *p++;
+      const signed char v = lut[(unsigned char)c];
+      if(v == lut_space) continue;
+      if(v == lut_invalid) return e_parse_unacceptable_character;
+      tag[length++] = c;
+    }
+    // Hex pairs
+    int hi = -1;
+    while(p < end) {
+      if((hi < 0) && ((end-p) >= 16) && (n+8 <= max_bytes) && decode_hex16(p, &bin[n])) {
+        for(size_type i=n; i<n+8; ++i) sum += bin[i];
+        n += 8;
+        length += 16;
+        p += 16;
+        continue;
+      }
+      const signed char v = lut[(unsigned char)(*p++)];
+      if(v == lut_space) continue;
+      if(v == lut_invalid) return e_parse_unacceptable_character;
+      ++length;
+      if(hi < 0) {
+        hi = v;
+      } else {
+        if(n < max_bytes) {
+          bin[n] = (unsigned char)(((hi << 4) | v) & 0xff);
+          sum += bin[n];
+          ++n;
+        }
+        hi = -1;
+      }
+    }
+    if((tag[0] != 'S') && (tag[0] != 's')) {
+      return e_parse_line_not_starting_with_s;
+    } else if((tag[1] < '0') || (tag[1] > '9')) {
+      return e_parse_invalid_record_type;
+    } else if((length & 0x01) || (length < 10) || (length > 514)) {
+      // Line length not even, or less than minimum of 10 === "SxLLAAAACC", L=length bytes, A=address bytes, C=cksum
+      return e_parse_invalid_line_length;
+    }
+    // Record type check, S0 to S9, S4 is reserved.
+    const unsigned type = unsigned(tag[1]-'0');
+    if(type == 4) return e_parse_invalid_record_type;
+    rec.type = type;
+    // Checksum
+    {
+      const unsigned cksum = (~(sum - bin[n-1])) & 0xff;
+      if(cksum != bin[n-1]) return e_parse_chcksum_incorrect;
+    }
+    // Byte count
+    {
+      const unsigned byte_count = bin[0];
+      if((byte_count < 3u) || (byte_count != n-1u)) return e_parse_length_mismatch;
+    }
+    // Address, data
+    {
+      static const unsigned char address_sizes[10] = { 2,2,3,4,0,2,3,4,3,2 };
+      const unsigned char* data = &bin[1];
+      const size_type size = n-2;
+      const size_type address_size = address_sizes[type];
+      if(size < address_size) return e_parse_length_mismatch;
+      if((type == 0) && (data[0] || data[1])) return e_parse_s0_address_nonzero;
+      switch(address_size) {
+        case 2:  rec.address = (type == 0) ? 0 : record_kernel<2>::decode_address(data); break;
+        case 3:  rec.address = record_kernel<3>::decode_address(data); break;
+        default: rec.address = record_kernel<4>::decode_address(data); break;
+      }
+      rec.offset = 1 + address_size;
+      rec.size = size - address_size;
+    }
+    // Alright
+    return e_ok;
+  }
+
+  static constexpr size_type ihex_frame_chars = 12;   ///< Intel HEX ":", count, address, type, checksum, newline.
+
+  /**
+   * Intel HEX line decode kernel, `p` is the first character after the
+   * ':'. Decodes count, address, type, data and checksum into the buffer
+   * of `rec`, whitespaces are ignored. Returns the parse error (or e_ok).
+   *
+   * @param const char* p
+   * @param const char* end
+   * @param line_type& rec
+   * @return error_type
+   */
+  static error_type decode_ihex_line(const char* p, const char* const end, line_type& rec)
+  {
+    const signed char* const lut = hex_lut();
+    unsigned char* const bin = rec.buffer; // count, address, type, data, checksum (+ SIMD slack).
+    constexpr size_type max_bytes = 255+5;
+    size_type n = 0;  // Decoded bytes.
+    unsigned sum = 0; // Sum of all decoded bytes, including the checksum.
+    int hi = -1;
+    while(p < end) {
+      if((hi < 0) && ((end-p) >= 16) && (n+8 <= max_bytes) && decode_hex16(p, &bin[n])) {
+        for(size_type i=n; i<n+8; ++i) sum += bin[i];
+        n += 8;
+        p += 16;
+        continue;
+      }
+      const signed char v = lut[(unsigned char)(*p++)];
+      if(v == lut_space) continue;
+      if((v < 0) || (v > 15)) return e_parse_unacceptable_character;
+      if(hi < 0) {
+        hi = v;
+      } else {
+        if(n >= max_bytes) return e_parse_invalid_line_length;
+        bin[n] = (unsigned char)(((hi << 4) | v) & 0xff);
+        sum += bin[n];
+        ++n;
+        hi = -1;
+      }
+    }
+    if((hi >= 0) || (n < 5)) return e_parse_invalid_line_length;
+    if(sum & 0xffu) return e_parse_chcksum_incorrect;
+    if(size_type(bin[0])+5 != n) return e_parse_length_mismatch;
+    rec.type = bin[3];
+    rec.address = (address_type(bin[1]) << 8) | address_type(bin[2]);
+    rec.offset = 4;
+    rec.size = bin[0];
+    return e_ok;
+  }
+
+  /**
+   * Analyses a decoded record and appends data records directly to the
+   * blocks. Returns false if the record is the S0 of the next S-record
+   * (not consumed). Analysis errors are deferred to `parse_finish()`,
+   * as line decoding errors take precedence.
+   *
+   * @param parse_state_type& state
+   * @param const line_type& rec
+   * @return bool
+   */
+  inline bool parse_record(parse_state_type& state, const line_type& rec)
+  {
+    SRECORD_STATISTICS_TIMER(statistics_.timings.analyse);
+    return analyse_record(state, rec, [this](const line_type& r) {
+      data_size_ = data_size_unknown;
+      if((!blocks_.empty()) && (r.address == blocks_.back().eadr())) {
+        data_type& bytes = blocks_.back().bytes();
+        #ifdef WITH_SRECORD_STATISTICS
+        const size_type capacity = bytes.capacity();
+        #endif
+        bytes.insert(bytes.end(), r.data(), r.data()+r.size);
+        SRECORD_STATISTICS(++statistics_.blocks_coalesced; if(bytes.capacity() != capacity) ++statistics_.reallocations)
+      } else {
+        SRECORD_STATISTICS(++statistics_.blocks_created; ++statistics_.allocations)
+        block_type block(r.address, data_type(r.data(), r.data()+r.size, get_allocator()));
+        if(blocks_.empty() || (block.sadr() >= blocks_.back().sadr())) {
+          blocks_.push_back(std::move(block));
+        } else {
+          const auto it = std::upper_bound(blocks_.begin(), blocks_.end(), block.sadr(),
+            [](address_type adr, const block_type& blk){ return adr < blk.sadr(); }
+          );
+          blocks_.insert(it, std::move(block));
+        }
+      }
+    });
+  }
+
+  /**
+   * Record analysis of `parse_record()`, accepted data records are
+   * passed to `on_data(const line_type&)`.
+   *
+   * @param parse_state_type& state
+   * @param const line_type& rec
+   * @param DataFunction&& on_data
+   * @return bool
+   */
+  template <typename DataFunction>
+  inline bool analyse_record(parse_state_type& state, const line_type& rec, DataFunction&& on_data)
+  {
+    const auto defer = [&state, this](error_type e) {
+      if(state.error != e_ok) return;
+      state.error = e;
+      state.error_line = parser_line_;
+    };
+    SRECORD_STATISTICS(if(rec.type < 10) ++statistics_.lines[rec.type])
+    if(rec.type == 0) {
+      if(state.found_s0) return false;
+      state.found_s0 = true;
+      if(!state.records++) {
+        header_.assign(rec.data(), rec.data()+rec.size);
+        return true;
+      }
+      // S0 not as first record: treated like a data line.
+    } else if(!state.records++) {
+      state.missing_s0 = true;
+    }
+    if(rec.type < 4) {
+      // Data lines (header is out)
+      if(!state.have_type) {
+        state.have_type = true;
+        state.type = record_type_type(rec.type);
+        type_ = record_type_type(rec.type);
+        if(state.start_line && strict_parsing() && (state.start_type != 10u-rec.type)) {
+          // Start address record before the first data record.
+          if((state.error == e_ok) || (state.start_line < state.error_line)) {
+            state.error = e_parse_startaddress_vs_data_type_mismatch;
+            state.error_line = state.start_line;
+          }
+        }
+      }
+      if(state.error != e_ok) return true;
+      if((rec.type != state.type) && strict_parsing()) {
+        defer(e_parse_mixed_data_line_types);
+        return true;
+      }
+      SRECORD_STATISTICS(statistics_.bytes_decoded += rec.size)
+      on_data(rec);
+      ++state.count;
+    } else if(rec.type < 7) {
+      // Line count lines
+      if(state.spec_count) defer(e_parse_duplicate_data_count);
+      state.spec_count = long(rec.address);
+    } else {
+      // Start addresses S7/S8/S9
+      // S<0, S4, S>9 already filtered out, S0/1/2/3 and S5/6 handled above --> S7/8/9 left.
+      if(state.have_start_address && strict_parsing()) defer(e_parse_duplicate_start_address);
+      state.have_start_address = true;
+      if(strict_parsing()) {
+        if(state.have_type) {
+          if(rec.type != 10u-state.type) defer(e_parse_startaddress_vs_data_type_mismatch);
+        } else if(!state.start_line) {
+          state.start_line = parser_line_;
+          state.start_type = rec.type;
+        }
+      }
+      start_address_ = rec.address;
+    }
+    return true;
+  }
+
+  /**
+   * Final checks after all records are analysed, return success. On
+   * line or decode errors the parsed data, header and type are discarded,
+   * so that the record is empty with the error details. Analysis errors
+   * (e.g. line count mismatch, duplicate or mismatching S5-S9 records)
+   * keep the parsed data, like the parser always did.
+   * @param const parse_state_type& state
+   * @return bool
+   */
+  inline bool parse_finish(const parse_state_type& state)
+  {
+    if(!good()) {
+      discard_parsed();
+      return false;
+    } else if(!state.records) {
+      return error(e_parse_missing_data_lines);
+    } else if(state.missing_s0 && strict_parsing()) {
+      return error(e_parse_missing_s0);
+    } else if((!state.have_type) || (state.type == type_undefined)) {
+      return error(e_parse_missing_data_lines);
+    } else if(state.error != e_ok) {
+      return error(state.error);
+    } else if(state.spec_count && (state.spec_count != state.count)) {
+      return error(e_parse_line_count_mismatch);
+    }
+    // All ok
+    return true;
+  }
+
+  /**
+   * Discards the parsed data, header, type and start address of a
+   * failed parse, the error details are kept.
+   */
+  inline void discard_parsed() noexcept
+  {
+    type_ = type_undefined;
+    start_address_ = 0;
+    header_.clear();
+    blocks_.clear();
+    normalized_ = true;
+    blocks_exposed_ = false;
+    data_size_ = 0;
+  }
+
+  /**
+   * Byte to hex lookup table, two upper case characters per byte value.
+   * @return const char*
+   */
+  static const char* hex_byte_lut() noexcept
+  {
+    struct lut_type {
+      char c[512];
+      lut_type() noexcept {
+        const char* hx = "0123456789ABCDEF";
+        for(unsigned i=0; i<256; ++i) { c[2*i] = hx[i>>4]; c[2*i+1] = hx[i & 0xf]; }
+      }
+    };
+    static const lut_type lut;
+    return lut.c;
+  }
+
+  /**
+   * Fixed size output buffer for `compose()`, the content is written
+   * to the stream in large chunks, not line by line, and flushed on
+   * destruction at the latest.
+   */
+  class output_buffer
+  {
+  public:
+
+    explicit output_buffer(std::ostream& os) noexcept : os_(os), size_(0)
+    {}
+
+    ~output_buffer()
+    { flush(); }
+
+    output_buffer(const output_buffer&) = delete;
+    output_buffer& operator=(const output_buffer&) = delete;
+
+    /**
+     * Returns the write position for at least `n` characters,
+     * or nullptr if the `n` exceeds the buffer capacity.
+     * @param size_type n
+     * @return char*
+     */
+    inline char* reserve(size_type n)
+    {
+      if(size_+n > sizeof(buffer_)) flush();
+      return (n <= sizeof(buffer_)) ? (buffer_+size_) : nullptr;
+    }
+
+    /**
+     * Marks the characters up to `end` (obtained via `reserve()`) as used.
+     * @param const char* end
+     */
+    inline void commit(const char* end) noexcept
+    { size_ = size_type(end-buffer_); }
+
+    /**
+     * Direct write, bypassing the buffer.
+     * @param const char* p
+     * @param size_type n
+     */
+    inline void write(const char* p, size_type n)
+    { flush(); os_.write(p, std::streamsize(n)); written_ += n; }
+
+    /**
+     * Writes the buffered characters to the stream.
+     */
+    inline void flush()
+    { if(size_) os_.write(buffer_, std::streamsize(size_)); written_ += size_; size_ = 0; }
+
+    /**
+     * Number of characters written or buffered.
+     * @return size_type
+     */
+    inline size_type written() const noexcept
+    { return written_ + size_; }
+
+  private:
+    std::ostream& os_;
+    size_type size_;
+    size_type written_ = 0;
+    char buffer_[16384];
+  };
+
+  /**
+   * Writes hex dump lines of the values [it, end) at address `adr`,
+   * `<AAAAAAAA> XXXX XXXX ...` with `align` values per line, indented
+   * by `indent` spaces and optionally followed by the ASCII column.
+   * The lines are formatted directly into the output buffer.
+   */
+  template <typename Iterator>
+  static void dump_lines(output_buffer& out, address_type adr, Iterator it, const Iterator end, unsigned align,
+                         unsigned indent, bool ascii)
+  {
+    const char* const lut = hex_byte_lut();
+    const size_type hex_end = size_type(indent) + 11 + 2*size_type(align) + align/2;
+    const size_type line_size = hex_end + (ascii ? (size_type(align) + 2) : 0) + 1;
+    std::vector<char> oversized;
+    while(it != end) {
+      char* const reserved = out.reserve(line_size);
+      if(!reserved) oversized.resize(line_size);
+      char* const line = reserved ? reserved : oversized.data();
+      const address_type line_address = adr - (adr % align);
+      const size_type skip = size_type(adr - line_address);
+      char* p = std::fill_n(line, indent, ' ');
+      *p++ = '<';
+      for(int shift=24; shift >= 0; shift -= 8) {
+        const unsigned v = unsigned(line_address >> shift) & 0xffu;
+        *p++ = lut[2*v];
+        *p++ = lut[2*v+1];
+      }
+      *p++ = '>';
+      *p++ = ' ';
+      p = std::fill_n(p, 2*skip + skip/2, ' ');
+      char* a = std::fill_n(line + hex_end + 1, ascii ? skip : 0, ' ');
+      do {
+        const unsigned v = unsigned(*it) & 0xffu;
+        *p++ = lut[2*v];
+        *p++ = lut[2*v+1];
+        if(ascii) *a++ = ((v >= 0x20) && (v < 0x7f)) ? char(v) : '.';
+        ++it;
+        if(!((++adr) & 0x1)) *p++ = ' ';
+      } while((it != end) && (adr % align));
+      if(ascii) {
+        p = std::fill_n(p, size_type((line + hex_end) - p), ' ');
+        *p++ = '|';
+        p = std::fill_n(a, size_type((line + hex_end + 1 + align) - a), ' ');
+        *p++ = '|';
+      }
+      *p++ = '\n';
+      if(reserved) {
+        out.commit(p);
+      } else {
+        out.write(line, size_type(p - line));
+      }
+    }
+  }
+
+  /**
+   * Record kernels for a fixed address field size of `AddressSize` bytes,
+   * that is 2, 3 or 4 for the S1/S2/S3 data records and their S9/S8/S7
+   * terminations. The frame sizes are compile time constants, and the
+   * address fields are encoded/decoded without loops over the width,
+   * so that the per-line code has no address type branches.
+   */
+  template <unsigned AddressSize>
+  struct record_kernel
+  {
+    static_assert((AddressSize >= 2) && (AddressSize <= 4), "Address size must be 2, 3 or 4 bytes.");
+
+    static constexpr unsigned address_size = AddressSize;                       ///< Address field bytes.
+    static constexpr unsigned data_record_type = AddressSize-1;                 ///< S1/S2/S3.
+    static constexpr unsigned termination_record_type = 10u-data_record_type;   ///< S9/S8/S7.
+    static constexpr size_type frame_chars = 2 + 2*(1+AddressSize+1) + 1;       ///< "Sx", count, address, checksum, newline.
+
+    /**
+     * Decodes the big endian address field.
+     * @param const unsigned char* p
+     * @return address_type
+     */
+    static inline address_type decode_address(const unsigned char* p) noexcept
+    {
+      address_type adr = 0;
+      for(unsigned i=0; i<AddressSize; ++i) adr = (adr << 8) | p[i];
+      return adr;
+    }
+
+    /**
+     * Renders a data record of `size` values at `address` including the
+     * newline into `p` (room for `frame_chars + 2*size`), returns the end
+     * of the rendered characters.
+     * @tparam typename Iterator
+     * @param char* p
+     * @param address_type address
+     * @param Iterator data
+     * @param size_type size
+     * @return char*
+     */
+    template <typename Iterator>
+    static inline char* render_data(char* p, address_type address, Iterator data, size_type size) noexcept
+    {
+      const char* const lut = hex_byte_lut();
+      const unsigned count = unsigned(AddressSize+size+1) & 0xffu;
+      unsigned sum = count;
+      p[0] = 'S';
+      p[1] = char('0'+data_record_type);
+      std::memcpy(p+2, lut+2*count, 2);
+      p += 4;
+      for(unsigned i=0; i<AddressSize; ++i, p += 2) {
+        const unsigned b = unsigned(address >> (8*(AddressSize-1-i))) & 0xffu;
+        sum += b;
+        std::memcpy(p, lut+2*b, 2);
+      }
+      for(size_type i=0; i<size; ++i, ++data, p += 2) {
+        const unsigned b = unsigned(*data) & 0xffu;
+        sum += b;
+        std::memcpy(p, lut+2*b, 2);
+      }
+      sum = (~sum) & 0xffu;
+      std::memcpy(p, lut+2*sum, 2);
+      p[2] = '\n';
+      return p+3;
+    }
+  };
+
+  /**
+   * Renders an Intel HEX record ":LLAAAATT<data>CC" including the newline
+   * into `p` (room for `ihex_frame_chars + 2*size`), returns the end of
+   * the rendered characters.
+   * @tparam typename Iterator
+   * @param char* p
+   * @param unsigned type
+   * @param unsigned address
+   * @param Iterator data
+   * @param size_type size
+   * @return char*
+   */
+  template <typename Iterator>
+  static inline char* render_ihex_record(char* p, unsigned type, unsigned address, Iterator data, size_type size) noexcept
+  {
+    const char* const lut = hex_byte_lut();
+    const unsigned head[4] = { unsigned(size) & 0xffu, (address >> 8) & 0xffu, address & 0xffu, type & 0xffu };
+    unsigned sum = 0;
+    *p++ = ':';
+    for(unsigned i=0; i<4; ++i, p += 2) {
+      sum += head[i];
+      std::memcpy(p, lut+2*head[i], 2);
+    }
+    for(size_type i=0; i<size; ++i, ++data, p += 2) {
+      const unsigned b = unsigned(*data) & 0xffu;
+      sum += b;
+      std::memcpy(p, lut+2*b, 2);
+    }
+    sum = (0x100u - (sum & 0xffu)) & 0xffu;
+    std::memcpy(p, lut+2*sum, 2);
+    p[2] = '\n';
+    return p+3;
+  }
+
+  /**
+   * Renders one record line including the newline to `p`, returns the
+   * end of the rendered characters. The byte count is truncated to 8 bit
+   * like the record field. `p` must have room for `record_chars()`.
+   *
+   * @tparam typename Iterator
+   * @param char* p
+   * @param unsigned type
+   * @param address_type address
+   * @param unsigned address_size
+   * @param Iterator data
+   * @param size_type size
+   * @param size_type padding
+   * @return char*
+   */
+  template <typename Iterator>
+  static char* render_record(char* p, unsigned type, address_type address, unsigned address_size, Iterator data, size_type size, size_type padding=0)
+  {
+    const char* const lut = hex_byte_lut();
+    const unsigned count = unsigned(address_size+size+padding+1) & 0xffu;
+    unsigned sum = count;
+    *p++ = 'S';
+    *p++ = char('0'+type);
+    *p++ = lut[2*count]; *p++ = lut[2*count+1];
+    for(unsigned i=address_size; i>0; --i) {
+      const unsigned b = unsigned(address >> (8*(i-1))) & 0xffu;
+      sum += b;
+      *p++ = lut[2*b]; *p++ = lut[2*b+1];
+    }
+    for(size_type i=0; i<size; ++i, ++data) {
+      const unsigned b = unsigned(*data) & 0xffu;
+      sum += b;
+      *p++ = lut[2*b]; *p++ = lut[2*b+1];
+    }
+    for(size_type i=0; i<padding; ++i) {
+      *p++ = '0'; *p++ = '0';
+    }
+    sum = (~sum) & 0xffu;
+    *p++ = lut[2*sum]; *p++ = lut[2*sum+1];
+    *p++ = '\n';
+    return p;
+  }
+
+  /**
+   * Maximum number of characters `render_record()` writes.
+   * @param unsigned address_size
+   * @param size_type size
+   * @return size_type
+   */
+  static constexpr size_type record_chars(unsigned address_size, size_type size) noexcept
+  { return 2 + 2*(1+address_size+size+1) + 1; }
+
+  /**
+   * Renders one record line into the output buffer, long lines (S0 with
+   * large header) are rendered separately.
+   *
+   * @tparam typename Iterator
+   * @param output_buffer& out
+   * @param unsigned type
+   * @param address_type address
+   * @param unsigned address_size
+   * @param Iterator data
+   * @param size_type size
+   * @param size_type padding
+   */
+  template <typename Iterator>
+  static void write_record(output_buffer& out, unsigned type, address_type address, unsigned address_size, Iterator data, size_type size, size_type padding=0)
+  {
+    const size_type n = record_chars(address_size, size+padding);
+    char* p = out.reserve(n);
+    if(p) {
+      out.commit(render_record(p, type, address, address_size, data, size, padding));
+    } else {
+      std::string line(n, '\0');
+      const char* e = render_record(&line[0], type, address, address_size, data, size, padding);
+      out.write(line.data(), size_type(e-line.data()));
+    }
+  }
+
+  /**
+   * Renders all data records with `data_line_length` bytes per line into
+   * the output buffer, returns the number of data records.
+   * @tparam unsigned AddressSize
+   * @param output_buffer& out
+   * @param size_type data_line_length
+   * @return unsigned long
+   */
+  template <unsigned AddressSize>
+  unsigned long write_data_records(output_buffer& out, const size_type data_line_length) const
+  {
+    using kernel = record_kernel<AddressSize>;
+    const size_type line_chars = kernel::frame_chars + 2*data_line_length;
+    unsigned long count = 0;
+    for(const block_type& block: blocks_) {
+      const data_type& bytes = block.bytes();
+      const size_type sz = bytes.size();
+      const address_type address = block.sadr();
+      for(size_type i=0; i < sz; i += data_line_length, ++count) {
+        const size_type n = ((sz-i) < data_line_length) ? (sz-i) : data_line_length;
+        char* p = out.reserve(line_chars);
+        if(p) {
+          out.commit(kernel::render_data(p, address+address_type(i), bytes.begin()+i, n));
+        } else {
+          std::string line(line_chars, '\0');
+          const char* e = kernel::render_data(&line[0], address+address_type(i), bytes.begin()+i, n);
+          out.write(line.data(), size_type(e-line.data()));
+        }
+      }
+    }
+    return count;
+  }
+
+  /**
+   * Number of data bytes per data line for a given line length
+   * (0: default, limited to 92 characters and at least 4 data bytes).
+   * @param size_type line_length
+   * @return size_type
+   */
+  size_type compose_data_line_length(size_type line_length) const noexcept
+  { return compose_data_line_length(type(), line_length); }
+
+  /**
+   * Data bytes per line for a record type and line length.
+   * @param record_type_type type
+   * @param size_type line_length
+   * @return size_type
+   */
+  static size_type compose_data_line_length(record_type_type type, size_type line_length) noexcept
+  {
+    const size_type frame_size = (2+2+(2*(1+type))+2); // Sx+len+(adr)+(no data bytes)+cksum
+    const size_type min_line_length = (frame_size+8);  // frame + min 4 data bytes.
+    if(line_length == 0) line_length = frame_size + 64;
+    else if(line_length > 92) line_length = 92;
+    else if(line_length < min_line_length) line_length = min_line_length;
+    return (line_length-frame_size)/2;
+  }
+
+  /**
+   * Validates and calculates the composer output layout.
+   * @param compose_layout_type& layout
+   * @param size_type line_length
+   * @return bool
+   */
+  bool compose_layout(compose_layout_type& layout, size_type line_length)
+  {
+    if(!good() || !validate()) return false;
+    layout.data_line_length = compose_data_line_length(line_length);
+    layout.address_size = unsigned(type_)+1;
+    layout.header_chars = record_chars(layout.address_size, (header_.size() < 12) ? 12 : header_.size());
+    layout.lines.assign(1, 0);
+    layout.chars.assign(1, 0);
+    layout.lines.reserve(blocks_.size()+1);
+    layout.chars.reserve(blocks_.size()+1);
+    for(const block_type& block: blocks_) {
+      const size_type sz = block.size();
+      const size_type n = (sz + layout.data_line_length - 1) / layout.data_line_length;
+      layout.lines.push_back(layout.lines.back() + (unsigned long)n);
+      layout.chars.push_back(layout.chars.back() + n * record_chars(layout.address_size, 0) + 2*sz);
+    }
+    const unsigned long count = layout.data_lines();
+    if(count > 0xffffffu) return error(e_compose_max_number_of_data_lines_exceeded);
+    layout.trailer_chars = record_chars((count > 0xffffu) ? 3u : 2u, 0) + record_chars(layout.address_size, 0);
+    return true;
+  }
+
+  /**
+   * Renders the S0 line, returns the end of the rendered characters.
+   * @param char* p
+   * @param const compose_layout_type& layout
+   * @return char*
+   */
+  char* render_header(char* p, const compose_layout_type& layout) const
+  {
+    const size_type padding = (header_.size() < 12) ? (12-header_.size()) : 0;
+    return render_record(p, 0, 0, layout.address_size, header_.begin(), header_.size(), padding);
+  }
+
+  /**
+   * Renders the data lines [first, last), returns the end of the rendered characters.
+   * @param char* p
+   * @param const compose_layout_type& layout
+   * @param unsigned long first
+   * @param unsigned long last
+   * @return char*
+   */
+  char* render_data_lines(char* p, const compose_layout_type& layout, unsigned long first, const unsigned long last) const
+  {
+    switch(layout.address_size) {
+      case 2:  return render_data_lines<2>(p, layout, first, last);
+      case 3:  return render_data_lines<3>(p, layout, first, last);
+      default: return render_data_lines<4>(p, layout, first, last);
+    }
+  }
+
+  /**
+   * Renders the data lines [first, last) for a fixed address size.
+   * @tparam unsigned AddressSize
+   * @param char* p
+   * @param const compose_layout_type& layout
+   * @param unsigned long first
+   * @param unsigned long last
+   * @return char*
+   */
+  template <unsigned AddressSize>
+  char* render_data_lines(char* p, const compose_layout_type& layout, unsigned long first, const unsigned long last) const
+  {
+    if(first >= last) return p;
+    const size_type dll = layout.data_line_length;
+    size_type i_block = size_type(std::upper_bound(layout.lines.begin(), layout.lines.end(), first) - layout.lines.begin()) - 1;
+    size_type i = size_type(first - layout.lines[i_block]) * dll;
+    while(first < last) {
+      const data_type& bytes = blocks_[i_block].bytes();
+      const size_type sz = bytes.size();
+      for(; (i < sz) && (first < last); i += dll, ++first) {
+        const size_type n = ((sz-i) < dll) ? (sz-i) : dll;
+        p = record_kernel<AddressSize>::render_data(p, blocks_[i_block].sadr() + address_type(i), bytes.begin()+i, n);
+      }
+      ++i_block;
+      i = 0;
+    }
+    return p;
+  }
+
+  /**
+   * Renders the S5/S6 and S7/S8/S9 lines, returns the end of the rendered characters.
+   * @param char* p
+   * @param const compose_layout_type& layout
+   * @return char*
+   */
+  char* render_trailer(char* p, const compose_layout_type& layout) const
+  {
+    const unsigned long count = layout.data_lines();
+    p = render_record(p, (count > 0xffffu) ? 6u : 5u, address_type(count), (count > 0xffffu) ? 3u : 2u, header_.begin(), 0);
+    return render_record(p, 10u-unsigned(type_), start_address_, layout.address_size, header_.begin(), 0);
+  }
+
+  /**
+   * Error setter
+   * @param error_type e
+   * @return bool
+   */
+  inline bool error(error_type e)
+  { error_ = e; return e == e_ok; }
+
+  /**
+   * Passes data through the `transform()` stages from index `stage` on,
+   * and writes the result. Ranges that are removed from the middle of
+   * the data are split into two parts.
+   * @return bool
+   */
+  bool transform_data(const transform_type& tf, size_type stage, address_type adr, const value_type* data,
+                      size_type size, std::vector<address_type>& fills, writer_type& out)
+  {
+    using kind = typename transform_type::stage_kind;
+    for(; stage < tf.stages().size(); ++stage) {
+      const auto& st = tf.stages()[stage];
+      switch(st.kind) {
+        case kind::offset:
+          if(st.negative && (adr < st.sadr)) return error(e_validate_record_range_exceeded);
+          adr = st.negative ? (adr - st.sadr) : (adr + st.sadr);
+          break;
+        case kind::crop: {
+          const address_type sadr = std::max(adr, st.sadr), eadr = std::min(adr+size, st.eadr);
+          if(sadr >= eadr) return true;
+          data += size_type(sadr-adr);
+          size = size_type(eadr-sadr);
+          adr = sadr;
+          break;
+        }
+        case kind::remove:
+          if((adr+size <= st.sadr) || (adr >= st.eadr)) break;
+          if((adr < st.sadr) && (!transform_data(tf, stage+1, adr, data, size_type(st.sadr-adr), fills, out))) return false;
+          if(adr+size <= st.eadr) return true;
+          data += size_type(st.eadr-adr);
+          size -= size_type(st.eadr-adr);
+          adr = st.eadr;
+          break;
+        case kind::fill:
+          if((adr > fills[stage]) && (fills[stage] < st.eadr)) {
+            const address_type eadr = std::min(adr, st.eadr);
+            if(!transform_fill(tf, stage+1, fills[stage], eadr, st.value, fills, out)) return false;
+          }
+          fills[stage] = std::max(fills[stage], adr+size);
+          break;
+      }
+    }
+    return out.write(adr, data, size) || error(out.error());
+  }
+
+  /**
+   * Passes the fill range [sadr, eadr) through the `transform()` stages
+   * from index `stage` on, line sized.
+   * @return bool
+   */
+  bool transform_fill(const transform_type& tf, size_type stage, address_type sadr, address_type eadr,
+                      value_type fill_value, std::vector<address_type>& fills, writer_type& out)
+  {
+    value_type data[256];
+    std::fill(data, data+256, fill_value);
+    for(address_type adr=sadr; adr < eadr; adr += 256) {
+      const size_type n = size_type(std::min(address_type(256), eadr-adr));
+      if(!transform_data(tf, stage, adr, data, n, fills, out)) return false;
+    }
+    return true;
+  }
+
+  /**
+   * Applies queued modifications with last-write-wins semantics. The
+   * visible part of each modification is determined in reverse order,
+   * then the blocks are rebuilt in one ordered pass, where unaffected
+   * blocks are moved, not copied. Edit data is only moved into the blocks
+   * if its allocator equals the allocator of the record.
+   * @param std::vector<edit_type>& edits
+   */
+  void commit_edits(std::vector<edit_type>& edits)
+  {
+    if(edits.empty()) return;
+    if(blocks_exposed_ || !normalized_) update_normalized();
+    if(!normalized_) {
+      for(edit_type& e: edits) {
+        if(e.remove) {
+          remove_range(e.sadr, e.eadr);
+        } else {
+          set_range(e.sadr, std::move(e.data));
+        }
+      }
+      return;
+    }
+    // Segment of the new block list: a range of an edit or an existing block.
+    struct segment_type { address_type sadr; address_type eadr; data_type* data; address_type data_sadr; };
+    std::vector<segment_type> segments;
+    std::map<address_type, address_type> covered; // disjoint [sadr, eadr) of later edits.
+    for(size_type i = edits.size(); i > 0; --i) {
+      edit_type& e = edits[i-1];
+      auto it = covered.upper_bound(e.sadr);
+      if((it != covered.begin()) && (std::prev(it)->second >= e.sadr)) --it;
+      address_type pos = e.sadr, sadr = e.sadr, eadr = e.eadr;
+      while((it != covered.end()) && (it->first <= e.eadr)) {
+        if((!e.remove) && (it->first > pos)) segments.push_back(segment_type{pos, it->first, &e.data, e.sadr});
+        if(it->second > pos) pos = it->second;
+        if(it->first < sadr) sadr = it->first;
+        if(it->second > eadr) eadr = it->second;
+        it = covered.erase(it);
+      }
+      if((!e.remove) && (pos < e.eadr)) segments.push_back(segment_type{pos, e.eadr, &e.data, e.sadr});
+      covered[sadr] = eadr;
+    }
+    // Existing data outside the modified ranges.
+    {
+      auto it = covered.begin();
+      for(block_type& block: blocks_) {
+        address_type pos = block.sadr();
+        while((it != covered.end()) && (it->second <= pos)) ++it;
+        for(auto jt = it; (jt != covered.end()) && (jt->first < block.eadr()); ++jt) {
+          if(jt->first > pos) segments.push_back(segment_type{pos, jt->first, &block.bytes(), block.sadr()});
+          if(jt->second > pos) pos = jt->second;
+        }
+        if(pos < block.eadr()) segments.push_back(segment_type{pos, block.eadr(), &block.bytes(), block.sadr()});
+      }
+    }
+    std::sort(segments.begin(), segments.end(), [](const segment_type& a, const segment_type& b){ return a.sadr < b.sadr; });
+    block_container_type blocks(blocks_.get_allocator());
+    blocks.reserve(segments.size());
+    for(segment_type& seg: segments) {
+      const auto first = seg.data->begin() + size_type(seg.sadr - seg.data_sadr);
+      const auto last = seg.data->begin() + size_type(seg.eadr - seg.data_sadr);
+      if((!blocks.empty()) && (blocks.back().eadr() == seg.sadr)) {
+        data_type& bytes = blocks.back().bytes();
+        bytes.insert(bytes.end(), first, last);
+      } else if((seg.sadr == seg.data_sadr) && (size_type(seg.eadr - seg.sadr) == seg.data->size()) && (seg.data->get_allocator() == get_allocator())) {
+        blocks.push_back(block_type(seg.sadr, std::move(*seg.data)));
+      } else {
+        blocks.push_back(block_type(seg.sadr, data_type(first, last, get_allocator())));
+      }
+    }
+    blocks_.swap(blocks);
+    normalized_ = true;
+    data_size_ = count_size();
+  }
+
+  /**
+   * Returns true if the blocks are ordered by address, non-overlapping,
+   * non-adjacent, and non-empty.
+   * @param const block_container_type& blocks
+   * @return bool
+   */
+  static bool is_normalized(const block_container_type& blocks) noexcept
+  {
+    for(size_type i=0; i<blocks.size(); ++i) {
+      if(blocks[i].empty()) return false;
+      if(i && (blocks[i-1].eadr() >= blocks[i].sadr())) return false;
+    }
+    return true;
+  }
+
+  /**
+   * `data_size_` value of an unknown total data size.
+   */
+  static constexpr size_type data_size_unknown = ~size_type(0);
+
+  /**
+   * Re-checks the block ordering invariant, which enables the
+   * binary search address lookups, and recounts the cached size.
+   * Blocks exposed by the mutable `blocks()` are trusted again.
+   */
+  inline void update_normalized() noexcept
+  { normalized_ = is_normalized(blocks_); blocks_exposed_ = false; data_size_ = count_size(); }
+
+  /**
+   * Returns the sum of all block sizes (O(n)).
+   * @return size_type
+   */
+  inline size_type count_size() const noexcept
+  {
+    size_type n = 0;
+    for(const block_type& e: blocks_) n += e.size();
+    return n;
+  }
+
+  /**
+   * Returns true if the blocks are normalized and cannot have been
+   * modified via a reference obtained from the mutable `blocks()`
+   * since the last re-check.
+   * Only then the binary search address lookups are applicable.
+   * @return bool
+   */
+  inline bool known_normalized() const noexcept
+  { return normalized_ && (!blocks_exposed_); }
+
+  /**
+   * Index of the first block with an end address greater than `address`
+   * (normalized blocks only).
+   * @param address_type address
+   * @return size_type
+   */
+  inline size_type block_index_ending_after(address_type address) const noexcept
+  {
+    return size_type(std::lower_bound(blocks_.begin(), blocks_.end(), address,
+      [](const block_type& blk, address_type adr){ return blk.eadr() <= adr; }
+    ) - blocks_.begin());
+  }
+
+  /**
+   * Index of the first block with a start address greater or equal
+   * to `address` (normalized blocks only).
+   * @param address_type address
+   * @return size_type
+   */
+  inline size_type block_index_starting_from(address_type address) const noexcept
+  {
+    return size_type(std::lower_bound(blocks_.begin(), blocks_.end(), address,
+      [](const block_type& blk, address_type adr){ return blk.sadr() < adr; }
+    ) - blocks_.begin());
+  }
+
+  /**
+   * Initial block index of a view iteration starting at `address`.
+   * @param address_type address
+   * @return size_type
+   */
+  inline size_type view_block_index(address_type address) const noexcept
+  { return known_normalized() ? block_index_ending_after(address) : 0; }
+
+  /**
+   * Returns the span of a view at `adr`, ending at `end` at the latest.
+   * For normalized blocks, `block` is the index of the first block ending
+   * after `adr` and advanced accordingly. Otherwise, the block with the
+   * highest start address containing `adr` is used, cut at the next
+   * block start.
+   * @param address_type adr
+   * @param address_type end
+   * @param value_type fill_value
+   * @param size_type& block
+   * @return span_type
+   */
+  span_type view_span(address_type adr, address_type end, value_type fill_value, size_type& block) const
+  {
+    if(known_normalized()) {
+      while((block < blocks_.size()) && (blocks_[block].eadr() <= adr)) ++block;
+      if(block >= blocks_.size()) return span_type(adr, size_type(end-adr), fill_value);
+      const block_type& blk = blocks_[block];
+      if(blk.sadr() > adr) return span_type(adr, size_type(std::min(end, blk.sadr())-adr), fill_value);
+      return span_type(adr, size_type(std::min(end, blk.eadr())-adr), blk.bytes().begin() + size_type(adr-blk.sadr()));
+    }
+    const block_type* container = nullptr;
+    address_type next = end;
+    for(const auto& blk: blocks_) {
+      if(blk.empty()) continue;
+      if(blk.sadr() > adr) {
+        next = std::min(next, blk.sadr());
+      } else if((blk.eadr() > adr) && ((!container) || (blk.sadr() >= container->sadr()))) {
+        container = &blk;
+      }
+    }
+    if(!container) return span_type(adr, size_type(next-adr), fill_value);
+    return span_type(adr, size_type(std::min(next, container->eadr())-adr), container->bytes().begin() + size_type(adr-container->sadr()));
+  }
+
+  /**
+   * Position of the first `value` in `text[from, to)`, or `to`.
+   */
+  template <typename Iterator>
+  static size_type find_value(Iterator text, size_type from, size_type to, value_type value)
+  {
+    while((from < to) && !(text[from] == value)) ++from;
+    return from;
+  }
+
+  static size_type find_value(const value_type* text, size_type from, size_type to, value_type value) noexcept
+  {
+    if(sizeof(value_type) != 1) {
+      while((from < to) && !(text[from] == value)) ++from;
+      return from;
+    }
+    if(from >= to) return to;
+    const void* p = std::memchr(text+from, static_cast<unsigned char>(value), to-from);
+    return p ? size_type(static_cast<const value_type*>(p) - text) : to;
+  }
+
+  /**
+   * Contiguous data is searched via pointers, everything else
+   * via container iterators.
+   */
+  template <typename T, typename A>
+  static const T* search_data(const std::vector<T,A>& data) noexcept
+  { return data.data(); }
+
+  template <typename Container>
+  static typename Container::const_iterator search_data(const Container& data)
+  { return data.begin(); }
+
+  /**
+   * Reserves capacity for containers providing `reserve()` (e.g.
+   * `std::vector`), no-op for others (e.g. `std::deque`).
+   */
+  template <typename Container>
+  static auto reserve_data(Container& data, size_type n, int) -> decltype(data.reserve(n), void())
+  { data.reserve(n); }
+
+  template <typename Container>
+  static void reserve_data(Container&, size_type, long)
+  {}
+
+  #if(__cplusplus >= 201700L)
+  /**
+   * Mutable counterpart of `search_data()`: pointer for contiguous data,
+   * container iterator otherwise.
+   */
+  template <typename T, typename A>
+  static T* data_pointer(std::vector<T,A>& data) noexcept
+  { return data.data(); }
+
+  template <typename Container>
+  static typename Container::iterator data_pointer(Container& data)
+  { return data.begin(); }
+
+  /**
+   * True if the given byte order differs from the byte order of the target.
+   */
+  static bool swapped_byte_order(endianess_type endianess) noexcept
+  {
+    #if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+    constexpr bool little_endian_target = (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+    #else
+    const std::uint16_t probe = 1;
+    const bool little_endian_target = (*reinterpret_cast<const unsigned char*>(&probe) == 1);
+    #endif
+    return (endianess == endianess_type::little_endian) != little_endian_target;
+  }
+
+  /**
+   * Reverses the byte order of `count` consecutive `Size` byte words. The
+   * words are loaded and stored via memcpy, so the loop vectorizes to byte
+   * shuffles.
+   */
+  template <size_type Size>
+  static void swap_byte_order(unsigned char* p, size_type count) noexcept
+  {
+    if constexpr (Size == 2) {
+      for(size_type i=0; i<count; ++i, p+=2) { std::swap(p[0], p[1]); }
+    } else if constexpr ((Size == 4) || (Size == 8)) {
+      using word_type = typename std::conditional<Size==4, std::uint32_t, std::uint64_t>::type;
+      for(size_type i=0; i<count; ++i, p+=Size) {
+        word_type w;
+        std::memcpy(&w, p, Size);
+        #if defined(__GNUC__) || defined(__clang__)
+        if constexpr (Size == 4) w = __builtin_bswap32(w); else w = __builtin_bswap64(w);
+        #else
+        word_type v = 0;
+        for(size_type k=0; k<Size; ++k, w>>=8) v = (v<<8) | (w & 0xff);
+        w = v;
+        #endif
+        std::memcpy(p, &w, Size);
+      }
+    } else if constexpr (Size > 1) {
+      for(size_type i=0; i<count; ++i, p+=Size) std::reverse(p, p+Size);
+    } else {
+      (void)p; (void)count;
+    }
+  }
+
+  /**
+   * Stores `count` values at `dst`, byte swapped if `swap` is set. Contiguous
+   * destinations are copied in bulk and swapped in place.
+   */
+  template <typename T>
+  static void store_array(value_type* dst, const T* values, size_type count, bool swap) noexcept
+  {
+    std::memcpy(dst, values, count*sizeof(T));
+    if(swap) swap_byte_order<sizeof(T)>(reinterpret_cast<unsigned char*>(dst), count);
+  }
+
+  template <typename Iterator, typename T>
+  static void store_array(Iterator dst, const T* values, size_type count, bool swap)
+  {
+    for(size_type i=0; i<count; ++i) {
+      unsigned char bytes[sizeof(T)];
+      std::memcpy(bytes, values+i, sizeof(T));
+      if(swap) std::reverse(bytes, bytes+sizeof(T));
+      dst = std::copy(bytes, bytes+sizeof(T), dst);
+    }
+  }
+  #endif
+
+  #ifdef WITH_SRECORD_STATISTICS
+  /**
+   * Adds the elapsed steady clock time in nanoseconds to `ns` on destruction.
+   */
+  class statistics_timer
+  {
+  public:
+
+    explicit statistics_timer(std::uint64_t& ns) noexcept : ns_(ns), t0_(std::chrono::steady_clock::now())
+    {}
+
+    ~statistics_timer() noexcept
+    { ns_ += std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0_).count()); }
+
+    statistics_timer(const statistics_timer&) = delete;
+    statistics_timer& operator=(const statistics_timer&) = delete;
+
+  private:
+    std::uint64_t& ns_;
+    std::chrono::steady_clock::time_point t0_;
+  };
+
+  /**
+   * Accounts the change of the block count on destruction: More blocks
+   * than before are created blocks, fewer than before plus `added` are
+   * coalesced blocks.
+   */
+  class block_statistics
+  {
+  public:
+
+    explicit block_statistics(basic_srecord& rec, size_type added) noexcept : rec_(rec), before_(rec.blocks_.size()), added_(added)
+    {}
+
+    ~block_statistics() noexcept
+    {
+      const size_type after = rec_.blocks_.size();
+      if(after > before_) rec_.statistics_.blocks_created += after - before_;
+      if(after < before_ + added_) rec_.statistics_.blocks_coalesced += before_ + added_ - after;
+    }
+
+    block_statistics(const block_statistics&) = delete;
+    block_statistics& operator=(const block_statistics&) = delete;
+
+  private:
+    basic_srecord& rec_;
+    size_type before_;
+    size_type added_;
+  };
+  #endif
+
+  /**
+   * Sets the lowest and highest+1 assigned address, returns false if
+   * there are no data.
+   */
+  bool data_extent(address_type& sadr, address_type& eadr) const noexcept
+  {
+    bool any = false;
+    for(const auto& blk: blocks_) {
+      if(blk.empty()) continue;
+      if(!any || (blk.sadr() < sadr)) sadr = blk.sadr();
+      if(!any || (blk.eadr() > eadr)) eadr = blk.eadr();
+      any = true;
+      if(known_normalized()) { eadr = blocks_.back().eadr(); break; }
+    }
+    return any;
+  }
+
+  /**
+   * Byte sources of `diff_values()`: `at(i)` is the byte at offset `i`,
+   * `word(i)` the 8 bytes from offset `i` (in any consistent order).
+   */
+  struct fill_values_type
+  {
+    explicit fill_values_type(value_type v) noexcept : value(static_cast<unsigned char>(v)), words(0x0101010101010101ull * value)
+    {}
+
+    unsigned char at(size_type) const noexcept
+    { return value; }
+
+    std::uint64_t word(size_type) const noexcept
+    { return words; }
+
+    unsigned char value;
+    std::uint64_t words;
+  };
+
+  template <typename Iterator>
+  struct data_values_type
+  {
+    explicit data_values_type(Iterator it) noexcept : data(it)
+    {}
+
+    unsigned char at(size_type i) const
+    { return static_cast<unsigned char>(data[i]); }
+
+    std::uint64_t word(size_type i) const
+    {
+      std::uint64_t w = 0;
+      for(unsigned k=0; k<8; ++k) w |= std::uint64_t(at(i+k)) << (8*k);
+      return w;
+    }
+
+    Iterator data;
+  };
+
+  struct byte_values_type
+  {
+    explicit byte_values_type(const unsigned char* p) noexcept : data(p)
+    {}
+
+    unsigned char at(size_type i) const noexcept
+    { return data[i]; }
+
+    std::uint64_t word(size_type i) const noexcept
+    {
+      std::uint64_t w;
+      std::memcpy(&w, data+i, sizeof(w));
+      return w;
+    }
+
+    const unsigned char* data;
+  };
+
+  template <typename Iterator>
+  static data_values_type<Iterator> data_values(Iterator it)
+  { return data_values_type<Iterator>(it); }
+
+  static byte_values_type data_values(const unsigned char* p) noexcept
+  { return byte_values_type(p); }
+
+  /**
+   * Data of a span as pointer for contiguous containers, as iterator
+   * otherwise.
+   */
+  template <typename T, typename A>
+  static const T* span_data(typename std::vector<T,A>::const_iterator it, const std::vector<T,A>*) noexcept
+  { return &*it; }
+
+  template <typename Container>
+  static typename Container::const_iterator span_data(typename Container::const_iterator it, const Container*)
+  { return it; }
+
+  static auto span_data(const span_type& span) -> decltype(span_data(span.begin(), static_cast<const data_type*>(nullptr)))
+  { return span_data(span.begin(), static_cast<const data_type*>(nullptr)); }
+
+  /**
+   * Appends the range to the `diff()` result, rounded to the granularity,
+   * and joined with the last range if overlapping or adjacent.
+   */
+  static void add_diff_range(address_ranges_type& ranges, address_type sadr, address_type eadr, address_type granularity)
+  {
+    if(granularity > 1) {
+      sadr -= sadr % granularity;
+      const address_type rem = eadr % granularity;
+      if(rem && (eadr + (granularity - rem) > eadr)) eadr += granularity - rem;
+    }
+    if((!ranges.empty()) && (ranges.back().eadr >= sadr)) {
+      if(eadr > ranges.back().eadr) ranges.back().eadr = eadr;
+    } else {
+      ranges.push_back(address_range_type{sadr, eadr});
+    }
+  }
+
+  /**
+   * Adds the differing ranges of `a[0, n)` and `b[0, n)`, located at `adr`.
+   * Equal and differing runs are skipped word-wise, a zero byte in the XOR of
+   * two words marks an equal byte.
+   */
+  template <typename A, typename B>
+  static void diff_values(const A& a, const B& b, size_type n, address_type adr, address_type granularity, address_ranges_type& ranges)
+  {
+    constexpr std::uint64_t lsbs = 0x0101010101010101ull, msbs = 0x8080808080808080ull;
+    size_type i = 0;
+    while(i < n) {
+      while((i+8 <= n) && (a.word(i) == b.word(i))) i += 8;
+      while((i < n) && (a.at(i) == b.at(i))) ++i;
+      if(i >= n) break;
+      size_type j = i+1;
+      while(j+8 <= n) {
+        const std::uint64_t x = a.word(j) ^ b.word(j);
+        if((x - lsbs) & ~x & msbs) break;
+        j += 8;
+      }
+      while((j < n) && (a.at(j) != b.at(j))) ++j;
+      add_diff_range(ranges, adr+i, adr+j, granularity);
+      i = j;
+    }
+  }
+
+  /**
+   * True if the spans at `[adr, end)` are complete blocks with the same
+   * address, size and cached `hash64()` digest.
+   */
+  static bool same_cached_block(const basic_srecord& a, size_type ia, const basic_srecord& b, size_type ib, address_type adr, address_type end) noexcept
+  {
+    if((!a.known_normalized()) || (!b.known_normalized()) || (ia >= a.blocks_.size()) || (ib >= b.blocks_.size())) return false;
+    const block_type& ba = a.blocks_[ia];
+    const block_type& bb = b.blocks_[ib];
+    if((ba.sadr() != adr) || (bb.sadr() != adr) || (ba.eadr() != end) || (bb.eadr() != end)) return false;
+    std::uint64_t da, db;
+    return ba.cached_digest(2, da) && bb.cached_digest(2, db) && (da == db);
+  }
+
+  /**
+   * Table driven (slicing-by-8) CRC of a reflected polynomial, operating
+   * on the raw CRC register (without initial value and final inversion).
+   * `zeros[i]` is the GF(2) operator appending 2^i zero bytes to a
+   * register, which allows to append block digests and fill ranges in
+   * O(log n) instead of feeding the bytes.
+   */
+  template <typename Word, std::uint64_t Polynomial>
+  struct crc_kernel
+  {
+    using word_type = Word;
+    static constexpr unsigned bits = unsigned(sizeof(Word) * 8);
+
+    Word table[8][256];
+    Word zeros[64][bits];
+
+    crc_kernel() noexcept
+    {
+      for(unsigned b=0; b<256; ++b) {
+        Word c = Word(b);
+        for(unsigned k=0; k<8; ++k) c = (c & 1u) ? Word((c >> 1) ^ Word(Polynomial)) : Word(c >> 1);
+        table[0][b] = c;
+      }
+      for(unsigned t=1; t<8; ++t) {
+        for(unsigned b=0; b<256; ++b) table[t][b] = Word(table[t-1][b] >> 8) ^ table[0][table[t-1][b] & 0xffu];
+      }
+      for(unsigned j=0; j<bits; ++j) zeros[0][j] = byte(Word(Word(1) << j), 0);
+      for(unsigned i=1; i<64; ++i) {
+        for(unsigned j=0; j<bits; ++j) zeros[i][j] = apply(zeros[i-1], zeros[i-1][j]);
+      }
+    }
+
+    static const crc_kernel& instance()
+    { static const crc_kernel kernel; return kernel; }
+
+    static Word apply(const Word* op, Word v) noexcept
+    {
+      Word r = 0;
+      for(unsigned j=0; v; ++j, v >>= 1) if(v & 1u) r ^= op[j];
+      return r;
+    }
+
+    static std::uint64_t load64(const unsigned char* p) noexcept
+    {
+      return std::uint64_t(p[0])       | (std::uint64_t(p[1]) << 8)  | (std::uint64_t(p[2]) << 16) | (std::uint64_t(p[3]) << 24)
+          | (std::uint64_t(p[4]) << 32) | (std::uint64_t(p[5]) << 40) | (std::uint64_t(p[6]) << 48) | (std::uint64_t(p[7]) << 56);
+    }
+
+    Word byte(Word crc, unsigned char b) const noexcept
+    { return Word(crc >> 8) ^ table[0][(crc ^ b) & 0xffu]; }
+
+    Word update(Word crc, const unsigned char* p, size_type n) const noexcept
+    {
+      #if defined(SRECORD_WITH_SSE42) && (defined(__x86_64__) || defined(_M_X64))
+      if(Polynomial == 0x82f63b78u) {
+        std::uint64_t c = crc;
+        for(; n >= 8; n -= 8, p += 8) c = _mm_crc32_u64(c, load64(p));
+        crc = Word(c);
+      }
+      #elif defined(SRECORD_WITH_ARM_CRC32) && defined(__aarch64__)
+      if(Polynomial == 0x82f63b78u) {
+        for(; n >= 8; n -= 8, p += 8) crc = Word(__crc32cd(std::uint32_t(crc), load64(p)));
+      } else if(Polynomial == 0xedb88320u) {
+        for(; n >= 8; n -= 8, p += 8) crc = Word(__crc32d(std::uint32_t(crc), load64(p)));
+      }
+      #endif
+      for(; n >= 8; n -= 8, p += 8) {
+        const std::uint64_t w = load64(p) ^ std::uint64_t(crc);
+        crc = table[7][w & 0xffu] ^ table[6][(w >> 8) & 0xffu] ^ table[5][(w >> 16) & 0xffu] ^ table[4][(w >> 24) & 0xffu]
+            ^ table[3][(w >> 32) & 0xffu] ^ table[2][(w >> 40) & 0xffu] ^ table[1][(w >> 48) & 0xffu] ^ table[0][w >> 56];
+      }
+      for(; n; --n, ++p) crc = byte(crc, *p);
+      return crc;
+    }
+
+    template <typename Iterator>
+    Word update(Word crc, Iterator it, size_type n) const
+    {
+      for(; n; --n, ++it) crc = byte(crc, static_cast<unsigned char>(*it));
+      return crc;
+    }
+
+    Word shift(Word crc, std::uint64_t n) const noexcept
+    {
+      for(unsigned i=0; n && crc; ++i, n >>= 1) if(n & 1u) crc = apply(zeros[i], crc);
+      return crc;
+    }
+
+    Word fill(Word crc, unsigned char value, std::uint64_t n) const noexcept
+    {
+      if(n < 64) {
+        for(; n; --n) crc = byte(crc, value);
+        return crc;
+      }
+      Word run = byte(0, value); // Register of 2^i value bytes.
+      for(unsigned i=0; n; ++i, n >>= 1) {
+        if(n & 1u) crc = apply(zeros[i], crc) ^ run;
+        if(n > 1) run = apply(zeros[i], run) ^ run;
+      }
+      return crc;
+    }
+  };
+
+  /**
+   * CRC of a range, see `crc32()`. Blocks completely in the range are
+   * appended using their cached digest with index `cache_index`.
+   */
+  template <typename Kernel>
+  typename Kernel::word_type range_digest(const Kernel& kernel, unsigned cache_index, address_type start_address, address_type end_address) const
+  {
+    using word_type = typename Kernel::word_type;
+    word_type crc = word_type(~word_type(0));
+    if(start_address >= end_address) return word_type(~crc);
+    const unsigned char fill = static_cast<unsigned char>(default_value_);
+    address_type adr = start_address;
+    if(!known_normalized()) {
+      for(const auto& span: view(start_address, end_address)) {
+        crc = span.fill() ? kernel.fill(crc, fill, span.size()) : kernel.update(crc, span.begin(), span.size());
+      }
+      return word_type(~crc);
+    }
+    for(size_type i=block_index_ending_after(start_address); (i < blocks_.size()) && (blocks_[i].sadr() < end_address); ++i) {
+      const block_type& blk = blocks_[i];
+      if(blk.sadr() > adr) {
+        crc = kernel.fill(crc, fill, blk.sadr() - adr);
+        adr = blk.sadr();
+      }
+      const address_type end = std::min(blk.eadr(), end_address);
+      if((adr == blk.sadr()) && (end == blk.eadr())) {
+        std::uint64_t digest;
+        if(!blk.cached_digest(cache_index, digest)) {
+          digest = kernel.update(word_type(0), search_data(blk.bytes()), blk.size());
+          blk.cache_digest(cache_index, digest);
+        }
+        crc = kernel.shift(crc, blk.size()) ^ word_type(digest);
+      } else {
+        crc = kernel.update(crc, search_data(blk.bytes()) + size_type(adr - blk.sadr()), size_type(end - adr));
+      }
+      adr = end;
+    }
+    if(adr < end_address) crc = kernel.fill(crc, fill, end_address - adr);
+    return word_type(~crc);
+  }
+
+  /**
+   * Returns the index of the first match of `pattern` in `text[from, n)`,
+   * or `n` if not found.
+   * @param Iterator text
+   * @param size_type n
+   * @param size_type from
+   * @param const search_pattern_type& pattern
+   * @return size_type
+   */
+  template <typename Iterator>
+  static size_type search_values(Iterator text, size_type n, size_type from, const search_pattern_type& pattern)
+  {
+    const size_type m = pattern.size;
+    if((n < m) || (from > n-m)) return n;
+    const size_type last = n-m;
+    if(pattern.prefilter) {
+      // Candidates via the anchor byte, as long as they are sparse enough,
+      // otherwise continue with Horspool.
+      const size_type k = pattern.anchor;
+      const value_type value = static_cast<value_type>(pattern.bytes[k]);
+      const size_type begin = from;
+      size_type candidates = 0;
+      while(from <= last) {
+        from = find_value(text, from+k, last+k+1, value) - k;
+        if(from > last) return n;
+        if(pattern.matches(text+from)) return from;
+        ++from;
+        if((++candidates >= 64) && ((from-begin) < (candidates * 32))) break;
+      }
+    }
+    const size_type m1 = m-1;
+    const unsigned char last_byte = pattern.bytes[m1], last_mask = pattern.masks[m1];
+    while(from <= last) {
+      const unsigned char c = static_cast<unsigned char>(text[from+m1]);
+      if(((c & last_mask) == last_byte) && pattern.matches(text+from)) return from;
+      from += pattern.shift[c];
+    }
+    return n;
+  }
+
+  /**
+   * Invokes `fn(address_type)->bool` for each match of `pattern` from
+   * `start_address` on, until `fn` returns false. Matches are located
+   * block by block, as all exported methods connect adjacent blocks.
+   * @param const search_pattern_type& pattern
+   * @param address_type start_address
+   * @param MatchFunction&& fn
+   */
+  template <typename MatchFunction>
+  void search(const search_pattern_type& pattern, address_type start_address, MatchFunction&& fn) const
+  {
+    if((!pattern.size) || blocks_.empty() || ((start_address < sadr()) && ((start_address+pattern.size) > eadr()))) {
+      return;
+    }
+    size_type i_block = 0;
+    if(known_normalized()) {
+      i_block = (start_address > 0) ? block_index_ending_after(start_address-1) : 0;
+    } else {
+      while(i_block < blocks_.size() && blocks_[i_block].eadr() < start_address) {
+        ++i_block;
+      }
+    }
+    if(i_block >= blocks_.size()) {
+      return;
+    }
+    size_type i = (start_address > blocks_[i_block].sadr()) ? size_type(start_address - blocks_[i_block].sadr()) : 0;
+    for(; i_block < blocks_.size(); ++i_block, i=0) {
+      const data_type& bytes = blocks_[i_block].bytes();
+      const size_type n = bytes.size();
+      while((i = search_values(search_data(bytes), n, i, pattern)) < n) {
+        if(!fn(blocks_[i_block].sadr() + i)) return;
+        ++i;
+      }
+    }
+  }
+
+  /**
+   * Address of the first match of `pattern`, or `eadr()`.
+   * @param const search_pattern_type& pattern
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find_first(const search_pattern_type& pattern, address_type start_address) const
+  {
+    address_type found = eadr();
+    search(pattern, start_address, [&](address_type adr){ found = adr; return false; });
+    return found;
+  }
+
+  /**
+   * `set_range()` for normalized blocks: Overwrites the data of affected
+   * blocks in place, or merges the new data with overlapping and adjacent
+   * blocks. Only the blocks at the range are touched.
+   * @param block_type&& block
+   */
+  void set_range_normalized(block_type&& block)
+  {
+    const address_type sadr = block.sadr();
+    const address_type eadr = block.eadr();
+    const size_type lo = (sadr > 0) ? block_index_ending_after(sadr-1) : 0; // first block with end >= sadr
+    const size_type hi = block_index_starting_from(eadr+1); // first block with start > eadr
+    if(lo >= hi) {
+      if(data_size_ != data_size_unknown) data_size_ += block.size();
+      blocks_.insert(blocks_.begin()+lo, std::move(block));
+      return;
+    }
+    block_type& first = blocks_[lo];
+    const block_type& last = blocks_[hi-1];
+    if((hi-lo == 1) && (first.sadr() <= sadr) && (eadr <= first.eadr())) {
+      std::copy(block.bytes().begin(), block.bytes().end(), first.bytes().begin() + size_type(sadr-first.sadr()));
+      return;
+    }
+    if(data_size_ != data_size_unknown) {
+      // The blocks [lo, hi) are replaced with one block from min(sadr, first.sadr()) to max(eadr, last.eadr()).
+      for(size_type i=lo; i<hi; ++i) data_size_ -= blocks_[i].size();
+      data_size_ += size_type(std::max(eadr, last.eadr()) - std::min(sadr, first.sadr()));
+    }
+    if(first.sadr() <= sadr) {
+      // Keep the head of the first block, append the new data and the tail of the last block.
+      data_type& bytes = first.bytes();
+      bytes.resize(size_type(sadr-first.sadr()));
+      bytes.insert(bytes.end(), block.bytes().begin(), block.bytes().end());
+      if((hi-lo > 1) && (last.eadr() > eadr)) {
+        bytes.insert(bytes.end(), last.bytes().begin()+size_type(eadr-last.sadr()), last.bytes().end());
+      }
+    } else {
+      // New data is the head, append the tail of the last block.
+      data_type& bytes = block.bytes();
+      if(last.eadr() > eadr) {
+        bytes.insert(bytes.end(), last.bytes().begin()+size_type(eadr-last.sadr()), last.bytes().end());
+      }
+      first.swap(block);
+    }
+    blocks_.erase(blocks_.begin()+lo+1, blocks_.begin()+hi);
+  }
+
+  /**
+   * `remove_range()` for normalized blocks, only the blocks in the range
+   * are touched.
+   * @param address_type start_address
+   * @param address_type end_address
+   */
+  void remove_range_normalized(address_type start_address, address_type end_address)
+  {
+    const size_type lo = block_index_ending_after(start_address);
+    const size_type hi = block_index_starting_from(end_address);
+    if(lo >= hi) return;
+    block_type& first = blocks_[lo];
+    block_type& last = blocks_[hi-1];
+    if(data_size_ != data_size_unknown) {
+      // Removed are the bytes of [lo, hi) within the range.
+      for(size_type i=lo; i<hi; ++i) {
+        data_size_ -= size_type(std::min(end_address, blocks_[i].eadr()) - std::max(start_address, blocks_[i].sadr()));
+      }
+    }
+    if((hi-lo == 1) && (first.sadr() < start_address) && (first.eadr() > end_address)) {
+      // Split
+      block_type tail(end_address, data_type(first.bytes().begin()+size_type(end_address-first.sadr()), first.bytes().end(), get_allocator()));
+      first.bytes().resize(size_type(start_address-first.sadr()));
+      blocks_.insert(blocks_.begin()+hi, std::move(tail));
+      return;
+    }
+    size_type erase_begin = lo, erase_end = hi;
+    if(first.sadr() < start_address) {
+      first.bytes().resize(size_type(start_address-first.sadr()));
+      ++erase_begin;
+    }
+    if(last.eadr() > end_address) {
+      data_type& bytes = last.bytes();
+      bytes.erase(bytes.begin(), bytes.begin()+size_type(end_address-last.sadr()));
+      last.sadr(end_address);
+      --erase_end;
+    }
+    if(erase_begin < erase_end) blocks_.erase(blocks_.begin()+erase_begin, blocks_.begin()+erase_end);
+  }
+
+  /**
+   * Connects blocks where the condition
+   * block[n].end() == block[n+1].begin()
+   */
+  inline void connect_adjacent_blocks()
+  {
+    if(blocks_.size() < 2) return;
+    size_type i=0, j=1;
+    while(j < blocks_.size() && blocks_[i].empty()) {
+      ++i; ++j;
+    }
+    while(j < blocks_.size()) {
+      if((blocks_[i].eadr() != blocks_[j].sadr())) {
+        i = j++;
+      } else {
+        block_type& a = blocks_[i];
+        block_type b(get_allocator());
+        b.swap(blocks_[j]);
+        a.bytes().insert(a.bytes().end(), b.bytes().begin(), b.bytes().end()); // append b to a
+        ++j;
+      }
+    }
+    remove_empty_blocks();
+  }
+
+  /**
+   * Erases blocks with the size 0 from the block container.
+   */
+  inline void remove_empty_blocks()
+  {
+    blocks_.erase(std::remove_if(blocks_.begin(), blocks_.end(), [](const block_type& e){ return e.empty(); }), blocks_.end());
+  }
+
+  /**
+   * Number to hex
+   *
+   * @tparam typename T
+   * @param T n
+   * @return std::string
+   */
+  template <typename T>
+  static inline std::string numtohex(T n)
+  {
+    static const char* hx = "0123456789ABCDEF";
+    constexpr size_type num_chars = sizeof(T)*2;
+    char s[num_chars+1];
+    s[num_chars] = '\0';
+    char *p = &(s[num_chars]);
+    while(p > s) {
+      *(--p) = hx[n & 0xf];
+      n >>= 4;
+    }
+    return std::string(p);
+  }
+
+  /**
+   * Number to hex, width specified in bytes
+   *
+   * @param unsigned long n
+   * @param unsigned width
+   * @return std::string
+   */
+  template <typename T>
+  static inline std::string numtohex(T n, unsigned width)
+  {
+    static const char* hx = "0123456789ABCDEF";
+    char s[33];
+    if(width > 4) {
+      width = 4; // limit width to 32bit
+    } else if(!width) {
+      width = 1; // limit width to 8bit
+    }
+    s[sizeof(s)-1] = '\0'; // terminate @ last char
+    char *p = &(s[sizeof(s)-1]); // intentionally sizeof(s), as --p below.
+    width <<= 1; // * 2 --> byte to hex chars
+    while(width--) {
+      *(--p) = hx[n & 0xf];
+      n >>= 4;
+    }
+    return std::string(p);
+  }
+
+  /**
+   * Container of numbers to hex
+   *
+   * @tparam typename ContainerType
+   * @param const ContainerType bin
+   * @return std::string
+   */
+  template <typename ContainerType>
+  static inline std::string tohex(const ContainerType& bin) {
+    std::string s;
+    for(auto e:bin) s += numtohex(e);
+    return s;
+  }
+
+  /**
+   * Calculate the line checksum
+   * @tparam ContainerType
+   * @param const ContainerType& bin
+   * @return value_type
+   */
+  template <typename ContainerType>
+  static value_type cksum(const ContainerType& bin)
+  {
+    unsigned cksum = 0;
+    for(auto e:bin) cksum += e;
+    cksum = (~(cksum)) & 0xff;  // complement, only one byte.
+    return (value_type) cksum;
+  }
+
+private:
+
+  error_type error_;              ///< Current error
+  record_type_type type_;         ///< Type of the data lines (S1,S2 or S3)
+  address_type start_address_;    ///< Address offset from the S9/S8/S7 address field.
+  data_type header_;              ///< Binary data of the S0 field (without address and checksum)
+  block_container_type blocks_;   ///< Contains unconnected blocks of memory ranges.
+  unsigned long parser_line_;     ///< Line counter of the parser
+  address_type error_address_;    ///< The address where an error was found
+  value_type default_value_;      ///< The value that is read in unset address ranges (e.g. RAM 0x00, FLASH 0xff).
+  bool strict_parsing_;           ///< Raises errors if the S-record does not encompass complete information, e.g. if the S0 or S5/S6 is missing.
+  bool normalized_;               ///< The blocks are known to be ordered, non-overlapping, non-adjacent and non-empty.
+  bool blocks_exposed_;           ///< A mutable `blocks()` reference was handed out, the blocks may have changed since the last re-check.
+  size_type data_size_;           ///< Cached `size()`, or `data_size_unknown`.
+  #ifdef WITH_SRECORD_STATISTICS
+  statistics_type statistics_;    ///< Counters and timings, see `statistics()`.
+  #endif
+
+};
+
+/**
+ * Record level reader, see `basic_srecord::reader_type`.
+ */
+template <typename ValueType, typename RandomAccessValueContainerType>
+class basic_srecord<ValueType, RandomAccessValueContainerType>::reader_type
+{
+public:
+
+  /**
+   * c'tor, reads from a stream line by line.
+   * @param std::istream& is
+   * @param bool strict
+   */
+  explicit reader_type(std::istream& is, bool strict=false) : is_(&is), pos_(nullptr), end_(nullptr),
+    line_(), rec_(), state_(), settings_(), done_(false)
+  { settings_.strict_parsing(strict); }
+
+  /**
+   * c'tor, reads from a character buffer, which must persist.
+   * @param const char* begin
+   * @param const char* end
+   * @param bool strict
+   */
+  explicit reader_type(const char* begin, const char* end, bool strict=false) : is_(nullptr), pos_(begin),
+    end_(end), line_(), rec_(), state_(), settings_(), done_(false)
+  { settings_.strict_parsing(strict); }
+
+  reader_type(const reader_type&) = delete;
+  reader_type& operator=(const reader_type&) = delete;
+
+  /**
+   * Reads the next data record. Returns false at the end of the
+   * input or on error, check `good()` to distinguish.
+   * @param data_record_type& record
+   * @return bool
+   */
+  bool next(data_record_type& record)
+  {
+    while(!done_) {
+      const char* line = nullptr;
+      const char* line_end = nullptr;
+      if(!read_line(line, line_end)) return finish();
+      ++settings_.parser_line_;
+      const char* const s = skip_space(line, line_end);
+      if(s == line_end) continue;
+      if(!settings_.parse_line(s, line_end, rec_)) { done_ = true; return false; }
+      bool data = false;
+      const bool consumed = settings_.analyse_record(state_, rec_, [&](const line_type& r) {
+        record.type = record_type_type(r.type);
+        record.address = r.address;
+        record.size = r.size;
+        std::copy(r.data(), r.data()+r.size, record.data);
+        data = true;
+      });
+      if((!consumed) || (state_.error != e_ok)) return finish(); // Next S0 or analysis error.
+      if(data) return true;
+    }
+    return false;
+  }
+
+  /**
+   * Returns true if no error occurred.
+   * @return bool
+   */
+  bool good() const noexcept
+  { return settings_.good(); }
+
+  /**
+   * Returns the current error.
+   * @return error_type
+   */
+  error_type error() const noexcept
+  { return settings_.error(); }
+
+  /**
+   * Settings read so far (header, type, start address, parser line, error),
+   * the blocks are empty.
+   * @return const basic_srecord&
+   */
+  const basic_srecord& settings() const noexcept
+  { return settings_; }
+
+private:
+
+  bool read_line(const char*& line, const char*& line_end)
+  {
+    if(is_) {
+      if(!std::getline(*is_, line_)) return false;
+      line = line_.data();
+      line_end = line + line_.size();
+      return true;
+    }
+    if(pos_ >= end_) return false;
+    line = pos_;
+    line_end = static_cast<const char*>(std::memchr(pos_, '\n', size_type(end_-pos_)));
+    if(!line_end) line_end = end_;
+    pos_ = (line_end < end_) ? (line_end+1) : end_;
+    return true;
+  }
+
+  bool finish()
+  {
+    if(!done_) settings_.parse_finish(state_);
+    done_ = true;
+    return false;
+  }
+
+private:
+
+  std::istream* is_;          ///< Input stream, or nullptr for buffers.
+  const char* pos_;           ///< Buffer read position.
+  const char* end_;           ///< Buffer end.
+  std::string line_;          ///< Stream line buffer.
+  line_type rec_;             ///< Decoded line.
+  parse_state_type state_;    ///< Record analysis state.
+  basic_srecord settings_;    ///< Header, type, start address, errors.
+  bool done_;                 ///< End of input or error.
+};
+
+/**
+ * Incremental push parser, see `basic_srecord::parser_type`.
+ */
+template <typename ValueType, typename RandomAccessValueContainerType>
+class basic_srecord<ValueType, RandomAccessValueContainerType>::parser_type
+{
+public:
+
+  /**
+   * c'tor
+   * @param bool strict
+   * @param bool single_file_stream
+   */
+  explicit parser_type(bool strict=false, bool single_file_stream=false) : line_(), remainder_(), rec_(),
+    state_(), record_(), single_file_stream_(single_file_stream), done_(false), finished_(false), data_()
+  { record_.strict_parsing(strict); }
+
+  parser_type(const parser_type&) = delete;
+  parser_type& operator=(const parser_type&) = delete;
+
+  /**
+   * Parses the next chunk of input, data records are appended to the
+   * blocks of `record()`. Returns the number of characters consumed,
+   * which is less than `size` only if the record ended in this chunk.
+   * Then `done()` is true, and the input of the next record is
+   * `remainder()` followed by the not consumed characters.
+   * @param const char* data
+   * @param size_type size
+   * @return size_type
+   */
+  size_type feed(const char* data, size_type size)
+  { return feed_lines(data, size, [this](const line_type& r) { return record_.parse_record(state_, r); }); }
+
+  /**
+   * Parses the next chunk of input like `feed(data, size)`, but passes
+   * each data record as `on_data(const data_record_type&)` instead of
+   * collecting the data in `record()`.
+   * @tparam typename DataFunction
+   * @param const char* data
+   * @param size_type size
+   * @param DataFunction&& on_data
+   * @return size_type
+   */
+  template <typename DataFunction>
+  size_type feed(const char* data, size_type size, DataFunction&& on_data)
+  { return feed_lines(data, size, [&](const line_type& r) { return record_.analyse_record(state_, r, pass_to(on_data)); }); }
+
+  /**
+   * Parses an unterminated last line and applies the final checks of
+   * `parse()`, returns success. Further input is ignored.
+   * @return bool
+   */
+  bool finish()
+  { return finish_lines([this](const line_type& r) { return record_.parse_record(state_, r); }); }
+
+  /**
+   * Finishes like `finish()`, data of an unterminated last line are
+   * passed to `on_data`.
+   * @tparam typename DataFunction
+   * @param DataFunction&& on_data
+   * @return bool
+   */
+  template <typename DataFunction>
+  bool finish(DataFunction&& on_data)
+  { return finish_lines([&](const line_type& r) { return record_.analyse_record(state_, r, pass_to(on_data)); }); }
+
+  /**
+   * Returns true if the record ended (next S0 or not an S-record line),
+   * a line error occurred, or `finish()` was called.
+   * @return bool
+   */
+  bool done() const noexcept
+  { return done_; }
+
+  /**
+   * Returns true if no error occurred.
+   * @return bool
+   */
+  bool good() const noexcept
+  { return record_.good(); }
+
+  /**
+   * Returns the current error.
+   * @return error_type
+   */
+  error_type error() const noexcept
+  { return record_.error(); }
+
+  /**
+   * Parsed record: Header, type, start address, parser line, errors, and
+   * the collected blocks (ordered and validated after `finish()`).
+   * @return basic_srecord&
+   */
+  basic_srecord& record() noexcept
+  { return record_; }
+
+  /**
+   * Parsed record.
+   * @return const basic_srecord&
+   */
+  const basic_srecord& record() const noexcept
+  { return record_; }
+
+  /**
+   * The line terminating the record (with newline), which belongs to
+   * the next record, or empty.
+   * @return const std::string&
+   */
+  const std::string& remainder() const noexcept
+  { return remainder_; }
+
+private:
+
+  /**
+   * Splits the input into lines, `analyse(const line_type&)` applies
+   * the record analysis and returns false for the next S0.
+   */
+  template <typename AnalyseFunction>
+  size_type feed_lines(const char* data, size_type size, AnalyseFunction&& analyse)
+  {
+    const char* p = data;
+    const char* const end = data + size;
+    while((p < end) && (!done_)) {
+      const char* const nl = static_cast<const char*>(std::memchr(p, '\n', size_type(end-p)));
+      if(!nl) {
+        line_.append(p, end);
+        p = end;
+        break;
+      }
+      if(line_.empty()) {
+        parse_line(p, nl, analyse);
+      } else {
+        line_.append(p, nl);
+        parse_line(line_.data(), line_.data()+line_.size(), analyse);
+        line_.clear();
+      }
+      p = nl + 1;
+    }
+    return size_type(p - data);
+  }
+
+  template <typename AnalyseFunction>
+  bool finish_lines(AnalyseFunction&& analyse)
+  {
+    if(finished_) return record_.good();
+    finished_ = true;
+    if((!done_) && (!line_.empty())) {
+      parse_line(line_.data(), line_.data()+line_.size(), analyse);
+      line_.clear();
+    }
+    done_ = true;
+    if(!record_.parse_finish(state_)) return false;
+    if(record_.blocks_.empty()) return true;
+    reorder(record_.blocks_);
+    record_.update_normalized();
+    return record_.validate(record_.strict_parsing());
+  }
+
+  template <typename AnalyseFunction>
+  void parse_line(const char* line, const char* line_end, AnalyseFunction& analyse)
+  {
+    ++record_.parser_line_;
+    const char* const s = skip_space(line, line_end);
+    if(s == line_end) return;
+    if((!single_file_stream_) && (*s != 'S' && *s != 's')) {
+      end_record(line, line_end);
+    } else if(!record_.parse_line(s, line_end, rec_)) {
+      done_ = true;
+    } else if(!analyse(rec_)) {
+      end_record(line, line_end);
+    }
+  }
+
+  void end_record(const char* line, const char* line_end)
+  {
+    remainder_.assign(line, line_end);
+    remainder_.push_back('\n');
+    done_ = true;
+  }
+
+  /**
+   * Data function of `analyse_record()` passing data records to `on_data`.
+   */
+  template <typename DataFunction>
+  struct pass_to_type
+  {
+    data_record_type& record;
+    DataFunction& on_data;
+
+    void operator()(const line_type& r) const
+    {
+      record.type = record_type_type(r.type);
+      record.address = r.address;
+      record.size = r.size;
+      std::copy(r.data(), r.data()+r.size, record.data);
+      on_data(static_cast<const data_record_type&>(record));
+    }
+  };
+
+  template <typename DataFunction>
+  pass_to_type<DataFunction> pass_to(DataFunction& on_data) noexcept
+  { return pass_to_type<DataFunction>{data_, on_data}; }
+
+private:
+
+  std::string line_;            ///< Partial line of the previous chunks.
+  std::string remainder_;       ///< Terminating line of the record.
+  line_type rec_;               ///< Decoded line.
+  parse_state_type state_;      ///< Record analysis state.
+  basic_srecord record_;        ///< Parsed record.
+  bool single_file_stream_;     ///< Parse all lines, see `parse()`.
+  bool done_;                   ///< End of record or error.
+  bool finished_;               ///< `finish()` called.
+  data_record_type data_;       ///< Data record passed to callbacks.
+};
+
+/**
+ * Record level writer, see `basic_srecord::writer_type`.
+ */
+template <typename ValueType, typename RandomAccessValueContainerType>
+class basic_srecord<ValueType, RandomAccessValueContainerType>::writer_type
+{
+public:
+
+  /**
+   * c'tor, data record type and line length (see `compose()`) can
+   * be set until the first data are written.
+   * @param std::ostream& os
+   * @param record_type_type type
+   * @param size_type line_length
+   */
+  explicit writer_type(std::ostream& os, record_type_type type=type_undefined, size_type line_length=0) :
+    os_(os), out_(os), type_(type), line_length_(line_length), header_(), error_(e_ok), started_(false),
+    finished_(false), data_line_length_(0), address_size_(0), lines_(0), address_(0), size_(0)
+  {}
+
+  writer_type(const writer_type&) = delete;
+  writer_type& operator=(const writer_type&) = delete;
+
+  /**
+   * Data record type (S1/S2/S3).
+   * @return record_type_type
+   */
+  record_type_type type() const noexcept
+  { return type_; }
+
+  /**
+   * Sets the data record type, ignored after the first data were written.
+   * @param record_type_type type
+   */
+  void type(record_type_type type) noexcept
+  { if(!started_) type_ = type; }
+
+  /**
+   * Sets the header (S0) data, ignored after the first data were written.
+   * @param const data_type& data
+   */
+  void header(const data_type& data)
+  { if(!started_) header_.assign(data.begin(), data.end()); }
+
+  /**
+   * Number of data records written so far.
+   * @return unsigned long
+   */
+  unsigned long lines() const noexcept
+  { return lines_; }
+
+  /**
+   * Returns the current error.
+   * @return error_type
+   */
+  error_type error() const noexcept
+  { return error_; }
+
+  /**
+   * Writes `size` values from `data` at `address`. Data contiguous to the
+   * previously written data are continued in the same lines.
+   * @param address_type address
+   * @param Iterator data
+   * @param size_type size
+   * @return bool
+   */
+  template <typename Iterator>
+  bool write(address_type address, Iterator data, size_type size)
+  {
+    if((error_ != e_ok) || finished_) return false;
+    if(!size) return true;
+    if((!started_) && (!start())) return false;
+    if(address+size > 0x100000000ull) return fail(e_validate_record_range_exceeded);
+    if(address+size > (address_type(1) << (8*address_size_))) return fail(e_validate_record_type_to_small);
+    if(size_ && (address != address_+size_)) flush_line();
+    if(!size_) address_ = address;
+    while(size) {
+      const size_type n = std::min(size, data_line_length_-size_);
+      for(size_type i=0; i<n; ++i, ++data) line_[size_+i] = *data;
+      size_ += n;
+      size -= n;
+      if(size_ == data_line_length_) flush_line();
+    }
+    return true;
   }
 
   /**
-   * Returns a range that starts at the address `start_address` and
-   * ends just before `end_address`. Unassigned memory ranges are
-   * filled with the `default_value()`.
+   * Writes the remaining data, the data record count (S5/S6) and start
+   * address record. Returns success.
    * @param address_type start_address
-   * @param address_type end_address
-   * @return block_type
+   * @return bool
    */
-  inline block_type get_range(address_type start_address, address_type end_address) const
-  { return get_range(start_address, end_address, default_value()); }
+  bool finish(address_type start_address)
+  {
+    if((error_ != e_ok) || finished_) return false;
+    if(!started_) return fail(e_validate_no_binary_data);
+    if(size_) flush_line();
+    if(lines_ > 0xffffffu) return fail(e_compose_max_number_of_data_lines_exceeded);
+    write_record(out_, (lines_ > 0xffffu) ? 6u : 5u, address_type(lines_), (lines_ > 0xffffu) ? 3u : 2u, header_.begin(), 0);
+    write_record(out_, 10u-unsigned(type_), start_address, address_size_, header_.begin(), 0);
+    out_.flush();
+    os_.flush();
+    finished_ = true;
+    return true;
+  }
+
+private:
+
+  bool fail(error_type e) noexcept
+  { error_ = e; return false; }
+
+  bool start()
+  {
+    if((type_ < type_s1_16bit) || (type_ > type_s3_32bit)) return fail(e_validate_record_type_to_small);
+    started_ = true;
+    data_line_length_ = compose_data_line_length(type_, line_length_);
+    address_size_ = unsigned(type_)+1;
+    const size_type padding = (header_.size() < 12) ? (12-header_.size()) : 0;
+    write_record(out_, 0, 0, address_size_, header_.begin(), header_.size(), padding);
+    return true;
+  }
+
+  void flush_line()
+  {
+    write_record(out_, unsigned(type_), address_, address_size_, static_cast<const value_type*>(line_), size_);
+    ++lines_;
+    address_ += size_;
+    size_ = 0;
+  }
+
+private:
+
+  std::ostream& os_;                ///< Output stream.
+  output_buffer out_;               ///< Output buffer.
+  record_type_type type_;           ///< Data record type.
+  size_type line_length_;           ///< Line length setting.
+  std::vector<value_type> header_;  ///< Header data.
+  error_type error_;                ///< First error.
+  bool started_;                    ///< Header written.
+  bool finished_;                   ///< Trailer written.
+  size_type data_line_length_;      ///< Data bytes per line.
+  unsigned address_size_;           ///< Address bytes of data records.
+  unsigned long lines_;             ///< Number of data lines written.
+  address_type address_;            ///< Address of the pending line.
+  size_type size_;                  ///< Size of the pending line.
+  value_type line_[256];            ///< Pending line data.
+};
+
+/**
+ * Immutable flat image, see `basic_srecord::frozen_type`.
+ */
+template <typename ValueType, typename RandomAccessValueContainerType>
+class basic_srecord<ValueType, RandomAccessValueContainerType>::frozen_type
+{
+public:
+
+  using arena_type = std::vector<value_type, allocator_type>;
 
   /**
-   * Copies the contents of a given block to the appropriate
-   * position. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and rearrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
-   * @param block_type&& block
-   * @return basic_srecord&
+   * c'tor, copies the data of `rec` into one contiguous arena. Adjacent
+   * blocks are joined, overlapping blocks resolved like `view()`.
+   * @param const basic_srecord& rec
    */
-  basic_srecord& set_range(block_type&& block)
+  explicit frozen_type(const basic_srecord& rec) : settings_(rec.get_allocator()),
+    arena_(rec.get_allocator()), sadrs_(), offsets_()
   {
-    // The easy cases: No existing blocks are affected
-    {
-      bool affected = false;
-      for(auto &e: blocks()) {
-        if(e.in_range(block.sadr(), block.eadr())) {
-          affected = true;
-          break;
-        }
+    settings_.header_ = rec.header_;
+    settings_.type_ = rec.type_;
+    settings_.start_address_ = rec.start_address_;
+    settings_.default_value_ = rec.default_value_;
+    settings_.strict_parsing_ = rec.strict_parsing_;
+    if(rec.blocks_.empty()) { offsets_.push_back(0); return; }
+    address_type sadr = rec.blocks_.front().sadr(), eadr = rec.blocks_.front().eadr();
+    if(!rec.known_normalized()) {
+      for(const block_type& e: rec.blocks_) {
+        if(!e.size()) continue;
+        sadr = std::min(sadr, e.sadr());
+        eadr = std::max(eadr, e.eadr());
       }
-      if(!affected) {
-        blocks().push_back(block);
-        reorder(blocks());
-        connect_adjacent_blocks();
-        return *this;
+    } else {
+      eadr = rec.blocks_.back().eadr();
+    }
+    arena_.reserve(rec.size());
+    for(const auto& span: rec.view(sadr, eadr)) {
+      if(span.fill()) continue;
+      if(sadrs_.empty() || (span.sadr() != (sadrs_.back() + address_type(arena_.size()-offsets_.back())))) {
+        sadrs_.push_back(span.sadr());
+        offsets_.push_back(arena_.size());
       }
+      arena_.insert(arena_.end(), span.begin(), span.end());
     }
-    // The normal cases: Existing blocks are affected. Determmine first and last affected block.
-    reorder(blocks());
-    size_type i_first = 0;
-    while(i_first < blocks().size() && !blocks()[i_first].in_range(block.sadr(), block.eadr()) ) {
-      ++i_first;
+    offsets_.push_back(arena_.size());
+  }
+
+  frozen_type(const frozen_type&) = default;
+  frozen_type(frozen_type&&) = default;
+  frozen_type& operator=(const frozen_type&) = delete;
+  frozen_type& operator=(frozen_type&&) = delete;
+
+public:
+
+  /**
+   * Returns the record settings (header, type, start address, default
+   * value), the settings have no blocks.
+   * @return const basic_srecord&
+   */
+  const basic_srecord& settings() const noexcept
+  { return settings_; }
+
+  /**
+   * Returns the value read at unassigned addresses.
+   * @return value_type
+   */
+  value_type default_value() const noexcept
+  { return settings_.default_value_; }
+
+  /**
+   * Returns the total number of data bytes.
+   * @return size_type
+   */
+  size_type size() const noexcept
+  { return arena_.size(); }
+
+  /**
+   * Returns true if the image has no data.
+   * @return bool
+   */
+  bool empty() const noexcept
+  { return arena_.empty(); }
+
+  /**
+   * Returns the number of (non-adjacent) blocks.
+   * @return size_type
+   */
+  size_type block_count() const noexcept
+  { return sadrs_.size(); }
+
+  /**
+   * Returns the start address of block `i`.
+   * @param size_type i
+   * @return address_type
+   */
+  address_type block_sadr(size_type i) const noexcept
+  { return sadrs_[i]; }
+
+  /**
+   * Returns the size of block `i`.
+   * @param size_type i
+   * @return size_type
+   */
+  size_type block_size(size_type i) const noexcept
+  { return offsets_[i+1] - offsets_[i]; }
+
+  /**
+   * Returns the data of block `i` in the arena.
+   * @param size_type i
+   * @return const value_type*
+   */
+  const value_type* block_data(size_type i) const noexcept
+  { return arena_.data() + offsets_[i]; }
+
+  /**
+   * Returns the first assigned address, 0 if empty.
+   * @return address_type
+   */
+  address_type sadr() const noexcept
+  { return sadrs_.empty() ? 0 : sadrs_.front(); }
+
+  /**
+   * Returns the address behind the last assigned byte, 0 if empty.
+   * @return address_type
+   */
+  address_type eadr() const noexcept
+  { return sadrs_.empty() ? 0 : (sadrs_.back() + address_type(block_size(sadrs_.size()-1))); }
+
+  /**
+   * Returns a pointer to the `size` bytes from `address` on in the arena,
+   * or `nullptr` if the range is not completely assigned.
+   * @param address_type address
+   * @param size_type size
+   * @return const value_type*
+   */
+  const value_type* data(address_type address, size_type size=1) const noexcept
+  {
+    const size_type i = block_index(address);
+    if(i >= sadrs_.size()) return nullptr;
+    const address_type offset = address - sadrs_[i];
+    return ((offset < address_type(block_size(i))) && (address_type(size) <= (address_type(block_size(i)) - offset)))
+      ? (arena_.data() + offsets_[i] + size_type(offset)) : nullptr;
+  }
+
+  /**
+   * Returns true if a byte is assigned at the given address.
+   * @param address_type address
+   * @return bool
+   */
+  bool assigned(address_type address) const noexcept
+  { return data(address) != nullptr; }
+
+  /**
+   * Returns the byte at the given address, or the `default_value()`
+   * if the address is not assigned.
+   * @param address_type address
+   * @return value_type
+   */
+  value_type get(address_type address) const noexcept
+  { const value_type* p = data(address); return p ? *p : default_value(); }
+
+  /**
+   * Returns a block with the bytes from `start_address` to `end_address`,
+   * unassigned bytes are filled with `fill_value`.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param value_type fill_value
+   * @return block_type
+   */
+  block_type get_range(address_type start_address, address_type end_address, value_type fill_value) const
+  {
+    block_type block(start_address, settings_.get_allocator());
+    if(start_address >= end_address) return block;
+    data_type& bytes = block.bytes();
+    bytes.resize(size_type(end_address-start_address), fill_value);
+    size_type i = block_index(start_address);
+    if(i >= sadrs_.size()) i = 0;
+    for(; (i < sadrs_.size()) && (sadrs_[i] < end_address); ++i) {
+      const address_type sadr = std::max(sadrs_[i], start_address);
+      const address_type eadr = std::min(sadrs_[i] + address_type(block_size(i)), end_address);
+      if(sadr >= eadr) continue;
+      const value_type* p = arena_.data() + offsets_[i] + size_type(sadr - sadrs_[i]);
+      std::copy(p, p + size_type(eadr-sadr), bytes.begin() + size_type(sadr-start_address));
     }
-    size_type i_last = blocks().size()-1;
-    while(i_last && !blocks()[i_last].in_range(block.sadr(), block.eadr()) ) {
-      --i_last;
+    return block;
+  }
+
+  /**
+   * Returns a block with the bytes from `start_address` to `end_address`,
+   * unassigned bytes are filled with the `default_value()`.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return block_type
+   */
+  block_type get_range(address_type start_address, address_type end_address) const
+  { return get_range(start_address, end_address, default_value()); }
+
+  /**
+   * Returns the address of the first match of `sequence` from
+   * `start_address` on, or `eadr()` if not found (see `basic_srecord::find()`).
+   * @param const data_type& sequence
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find(const data_type& sequence, address_type start_address=0) const
+  { return find_first(search_pattern_type(sequence, nullptr), start_address); }
+
+  /**
+   * Masked search, see `basic_srecord::find()`.
+   * @param const data_type& sequence
+   * @param const data_type& mask
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find(const data_type& sequence, const data_type& mask, address_type start_address=0) const
+  { return find_first(search_pattern_type(sequence, &mask), start_address); }
+
+  #if(__cplusplus >= 201700L)
+  /**
+   * Returns the endianess interpreted value at `address`, or an empty
+   * optional if the range is not completely assigned.
+   * @tparam IntegralType
+   * @param address_type address
+   * @param endianess_type endianess
+   * @return std::optional<IntegralType>
+   */
+  template <typename IntegralType>
+  std::optional<IntegralType> get(address_type address, endianess_type endianess) const
+  {
+    static_assert(std::is_integral<IntegralType>::value, "get<> only for integers, use <cstdint> types.");
+    const value_type* p = data(address, sizeof(IntegralType));
+    if(!p) return std::optional<IntegralType>();
+    using utype = typename std::make_unsigned<IntegralType>::type;
+    utype value = 0;
+    if(endianess == endianess_type::big_endian) {
+      for(size_type i=0; i<sizeof(utype); ++i) value = utype(utype(value<<8) | utype(p[i]));
+    } else {
+      for(size_type i=sizeof(utype); i>0; --i) value = utype(utype(value<<8) | utype(p[i-1]));
     }
-    // All all blocks except the first and the last will be overwritten anyway.
-    for(size_type i = i_first+1; i < i_last; ++i) {
-      blocks()[i].bytes().clear();
-    }
-    block_type before = blocks()[i_first].get_range(blocks()[i_first].sadr(), block.sadr());
-    block_type after  = blocks()[i_last].get_range(block.eadr(), blocks()[i_last].eadr());
-    blocks()[i_first].bytes().clear();
-    blocks()[i_last].bytes().clear();
-    blocks().push_back(before);
-    blocks().push_back(block);
-    blocks().push_back(after);
-    remove_empty_blocks();
-    reorder(blocks());
-    connect_adjacent_blocks();
-    return *this;
+    return std::optional<IntegralType>(IntegralType(value));
   }
 
   /**
-   * Copies the contents of a given block to the appropriate
-   * position. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and re-arrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
-   * @param const block_type& block
-   * @return basic_srecord&
+   * Returns `count` consecutive values of type `T`, see `basic_srecord::get_array()`.
+   * @tparam T
+   * @param address_type address
+   * @param size_type count
+   * @param endianess_type endianess
+   * @return std::optional<std::vector<T>>
    */
-  inline basic_srecord& set_range(const block_type& block)
-  { block_type blk = block; return set_range(std::move(blk)); }
+  template <typename T>
+  std::optional<std::vector<T>> get_array(address_type address, size_type count, endianess_type endianess) const
+  {
+    static_assert(std::is_arithmetic<T>::value, "get_array<> only for integral and floating point types.");
+    if(count > size_type(std::numeric_limits<address_type>::max()/sizeof(T))) return std::optional<std::vector<T>>();
+    const value_type* p = data(address, count*sizeof(T));
+    if(!p) return std::optional<std::vector<T>>();
+    std::vector<T> values(count);
+    std::memcpy(values.data(), p, count*sizeof(T));
+    if(swapped_byte_order(endianess)) swap_byte_order<sizeof(T)>(reinterpret_cast<unsigned char*>(values.data()), count);
+    return std::optional<std::vector<T>>(std::move(values));
+  }
+  #endif
 
   /**
-   * Copies the contents of given byte data to the appropriate
-   * address. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and re-arrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
+   * Returns a (mutable) record with the image data and settings.
+   * @return basic_srecord
+   */
+  basic_srecord record() const
+  {
+    basic_srecord rec(settings_);
+    rec.blocks_.reserve(sadrs_.size());
+    for(size_type i=0; i<sadrs_.size(); ++i) {
+      block_type block(sadrs_[i], rec.get_allocator());
+      block.bytes().assign(block_data(i), block_data(i)+block_size(i));
+      rec.blocks_.push_back(std::move(block));
+    }
+    rec.normalized_ = true;
+    rec.data_size_ = arena_.size();
+    return rec;
+  }
+
+private:
+
+  /**
+   * Index of the last block starting at or before `address`, or
+   * `block_count()` if there is none. Branch-light binary search:
+   * The loop count only depends on the number of blocks, the compare
+   * compiles to a conditional move.
    * @param address_type address
-   * @param const data_type& data
-   * @return basic_srecord&
+   * @return size_type
+   */
+  size_type block_index(address_type address) const noexcept
+  {
+    size_type n = sadrs_.size();
+    if((!n) || (address < sadrs_.front())) return sadrs_.size();
+    const address_type* base = sadrs_.data();
+    while(n > 1) {
+      const size_type half = n/2;
+      base = (base[half] <= address) ? (base+half) : base;
+      n -= half;
+    }
+    return size_type(base - sadrs_.data());
+  }
+
+  /**
+   * First match of `pattern` from `start_address` on, or `eadr()`.
+   * @param const search_pattern_type& pattern
+   * @param address_type start_address
+   * @return address_type
+   */
+  address_type find_first(const search_pattern_type& pattern, address_type start_address) const
+  {
+    if(!pattern.size) return eadr();
+    size_type i = block_index(start_address);
+    if(i >= sadrs_.size()) i = 0;
+    for(; i < sadrs_.size(); ++i) {
+      const size_type n = block_size(i);
+      const size_type from = (start_address > sadrs_[i]) ? size_type(start_address - sadrs_[i]) : 0;
+      if(from >= n) continue;
+      const size_type k = search_values(block_data(i), n, from, pattern);
+      if(k < n) return sadrs_[i] + address_type(k);
+    }
+    return eadr();
+  }
+
+private:
+
+  basic_srecord settings_;                ///< Header, type, start address, default value, no blocks.
+  arena_type arena_;                      ///< Data of all blocks, in address order.
+  std::vector<address_type> sadrs_;       ///< Sorted block start addresses.
+  std::vector<size_type> offsets_;        ///< Block offsets in the arena, `block_count()+1` entries.
+};
+}}
+
+namespace sw { namespace detail {
+
+/**
+ * Sparse paged memory image, an alternative storage for large and
+ * scattered 32 bit address spaces. The address space is divided into
+ * pages of `2^PageBits` bytes, which are allocated on first write and
+ * referenced by a two-level page table. Each page has a bit mask of the
+ * assigned bytes, unassigned bytes read as `default_value()`. Random
+ * byte access is O(1), the record blocks are derived from the pages
+ * when needed (e.g. for composing).
+ *
+ * Pages and page tables are reference counted and copy-on-write: Copies
+ * (`fork()`) share all pages with the original, only pages modified
+ * afterwards are duplicated. Images sharing pages can be modified
+ * independently, also in different threads.
+ *
+ * @tparam typename SRecordType
+ * @tparam unsigned PageBits
+ */
+template <typename SRecordType, unsigned PageBits=12>
+class basic_paged_image
+{
+public:
+
+  using srecord_type = SRecordType;
+  using value_type = typename srecord_type::value_type;
+  using size_type = typename srecord_type::size_type;
+  using address_type = typename srecord_type::address_type;
+  using data_type = typename srecord_type::data_type;
+  using block_type = typename srecord_type::block_type;
+  using block_container_type = typename srecord_type::block_container_type;
+
+  static_assert((PageBits >= 6) && (PageBits <= 20), "PageBits must be in the range 6 to 20.");
+
+  static constexpr unsigned page_bits = PageBits;
+  static constexpr size_type page_size = size_type(1) << page_bits;
+  static constexpr address_type address_limit = address_type(1) << 32;
+
+private:
+
+  static constexpr unsigned table_bits = (32u-page_bits)/2u;
+  static constexpr unsigned directory_bits = 32u-page_bits-table_bits;
+  static constexpr size_type table_size = size_type(1) << table_bits;
+  static constexpr size_type directory_size = size_type(1) << directory_bits;
+  static constexpr size_type mask_words = page_size/64;
+
+  struct page_type
+  {
+    explicit page_type() noexcept
+    { std::fill(data, data+page_size, value_type()); std::fill(mask, mask+mask_words, std::uint64_t(0)); }
+    value_type data[page_size];       ///< Page bytes
+    std::uint64_t mask[mask_words];   ///< Assigned bytes bit mask
+  };
+
+  struct table_type
+  {
+    std::shared_ptr<page_type> pages[table_size];
+  };
+
+public:
+
+  /**
+   * c'tor (default)
+   * @param value_type default_value
    */
-  inline basic_srecord& set_range(address_type address, data_type&& data)
-  { block_type blk; blk.sadr(address); blk.bytes(std::move(data)); return set_range(std::move(blk)); }
+  explicit basic_paged_image(value_type default_value=value_type(0)) :
+    directory_(directory_size), record_(), pages_(0), blocks_(), blocks_valid_(true)
+  { record_.default_value(default_value); }
 
   /**
-   * Copies the contents of given byte data to the appropriate
-   * address. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and rearrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
-   * @param address_type address
-   * @param const data_type& data
-   * @return basic_srecord&
+   * c'tor, from a record. The record data is copied into pages, the
+   * other record settings (header, type, start address, default value)
+   * are adopted.
+   * @param const srecord_type& rec
    */
-  inline basic_srecord& set_range(address_type address, const data_type& data)
-  { block_type blk(address, data); return set_range(blk); }
+  explicit basic_paged_image(const srecord_type& rec) :
+    directory_(directory_size), record_(), pages_(0), blocks_(), blocks_valid_(true)
+  { assign(rec); }
 
   /**
-   * Copies the contents of given byte data to the appropriate
-   * address. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and re-arrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
-   * @tparam typename Container
-   * @param address_type address
-   * @param const Container& data
-   * @return basic_srecord&
+   * c'tor (copy), shares the pages of `o` (copy-on-write).
+   * @param const basic_paged_image& o
    */
-  template<typename Container>
-  inline typename std::enable_if<std::is_same<typename Container::value_type, value_type>::value, basic_srecord&>
-  ::type set_range(address_type address, const Container& data)
+  basic_paged_image(const basic_paged_image& o) :
+    directory_(o.directory_), record_(o.record_), pages_(o.pages_), blocks_(), blocks_valid_(false)
+  {}
+
+  /**
+   * c'tor (move), the moved-from instance is a valid empty image.
+   * @param basic_paged_image&& o
+   */
+  basic_paged_image(basic_paged_image&& o) :
+    directory_(std::move(o.directory_)), record_(std::move(o.record_)), pages_(o.pages_),
+    blocks_(std::move(o.blocks_)), blocks_valid_(o.blocks_valid_)
   {
-    if(data.empty()) return *this;
-    auto bytes = data_type();
-    bytes.reserve(data.size());
-    for(auto& e:data) bytes.push_back(e);
-    set_range(std::move(bytes));
-    return *this;
+    o.directory_.clear();
+    o.directory_.resize(directory_size);
+    o.pages_ = 0;
+    o.blocks_.clear();
+    o.blocks_valid_ = true;
   }
 
+  basic_paged_image& operator=(const basic_paged_image& o)
+  { if(&o != this) { basic_paged_image tmp(o); swap(tmp); } return *this; }
+
+  basic_paged_image& operator=(basic_paged_image&& o)
+  { if(&o != this) { basic_paged_image tmp(std::move(o)); swap(tmp); } return *this; }
+
+  ~basic_paged_image() = default;
+
+public:
+
   /**
-   * Copies the contents of given byte data to the appropriate
-   * address. Extends the instance address range if needed,
-   * overwrites existing blocks. Might merge and re-arrange
-   * blocks, means drop pointers or references to blocks
-   * after using this method.
-   * @tparam typename Container
-   * @param address_type address
-   * @param const Container& data
+   * Returns a copy of the image, which shares all pages with this image.
+   * The cost is independent of the data size, pages are duplicated when
+   * they are modified in either image.
+   * @return basic_paged_image
    */
-  template<typename Container>
-  inline typename std::enable_if<std::is_same<typename Container::value_type, value_type>::value,void>
-  ::type set_range(address_type address, const Container& data)
+  basic_paged_image fork() const
+  { return basic_paged_image(*this); }
+
+  /**
+   * Swaps the contents of two images.
+   * @param basic_paged_image& o
+   */
+  void swap(basic_paged_image& o)
   {
-    if(data.empty()) return *this;
-    auto bytes = data_type();
-    bytes.reserve(data.size());
-    for(auto& e:data) bytes.push_back(e);
-    set_range(std::move(bytes));
-    return *this;
+    directory_.swap(o.directory_);
+    std::swap(record_, o.record_);
+    std::swap(pages_, o.pages_);
+    blocks_.swap(o.blocks_);
+    std::swap(blocks_valid_, o.blocks_valid_);
   }
 
   /**
-   * Removes an address range from the srecord. Might split and
-   * rearrange blocks, means you should drop pointers or references
-   * to blocks after using this method.
-   * @param address_type start_address
-   * @param address_type end_address
-   * @return basic_srecord&
+   * Removes all data, keeps the record settings.
    */
-  basic_srecord& remove_range(address_type start_address, address_type end_address)
+  void clear()
   {
-    if((start_address >= end_address) || blocks().empty()) return *this;
-    size_type i_first = blocks().size();
-    size_type i;
-    for(i = 0; i < blocks().size(); ++i) {
-      if(blocks()[i].in_range(start_address, end_address)) {
-        i_first = i;
-        break;
-      }
-    }
-    if(i_first >= blocks().size()) return *this;
-    size_type i_last = i_first;
-    for(i = i_first; i < blocks().size(); ++i) {
-      if(!blocks()[i].in_range(start_address, end_address)) break;
-      i_last = i;
-    }
-    if(i_last >= blocks().size()) {
-      i_last = blocks().size() - 1;
-    }
-    if(i_first == i_last) {
-      i = i_first;
-      if(blocks()[i].sadr() == start_address) {
-        // Aligned to begin, just shrink the block
-        shrink_to(blocks()[i], end_address, blocks()[i].eadr());
-        if(blocks()[i].empty()) remove_empty_blocks();
-      } else if(blocks()[i].eadr() == end_address) {
-        // Aligned to end, also shrink
-        shrink_to(blocks()[i], blocks()[i].sadr(), start_address);
-        if(blocks()[i].empty()) remove_empty_blocks();
-      } else {
-        // otherwise split it.
-        block_type blk;
-        blk.swap(blocks()[i]);
-        blocks()[i] = blk.get_range(blk.sadr(), start_address);
-        blk = blk.get_range(end_address, blk.eadr());
-        blocks().push_back(blk);
-        remove_empty_blocks();
-        reorder(blocks());
-      }
-    } else {
-      i = i_first + 1;
-      while(i < i_last) {
-        blocks()[i++].clear();
-      }
-      {
-        block_type& blk = blocks()[i_first];
-        if(start_address == blk.sadr()) {
-          blk.clear();
-        } else {
-          blk = blk.get_range(blk.sadr(), start_address);
-        }
-      }
-      {
-        block_type& blk = blocks()[i_last];
-        if(end_address == blk.eadr()) {
-          blk.clear();
-        } else {
-          blk = blk.get_range(end_address, blk.eadr());
-        }
-      }
-      remove_empty_blocks();
-      reorder(blocks());
-    }
-    return *this;
+    for(auto& e: directory_) e.reset();
+    pages_ = 0;
+    block_container_type().swap(blocks_);
+    blocks_valid_ = true;
   }
 
   /**
-   * Connects all blocks of this instance to one block, applying a `fill_value`
-   * in unassigned ranges. Overlapping blocks implicitly overwrite, where the
-   * overlapping contents of later blocks overwrite the overlapping ranges of
-   * earlier blocks.
-   * @param value_type fill_value
-   * @return basic_srecord&
+   * Replaces the image contents and settings with the given record.
+   * @param const srecord_type& rec
    */
-  inline basic_srecord& merge(value_type fill_value)
+  void assign(const srecord_type& rec)
   {
-    block_container_type blks;
-    blocks_.swap(blks);
-    blocks_.push_back(connect(std::move(blks), fill_value));
-    return *this;
+    clear();
+    record_ = rec;
+    record_.blocks().clear();
+    for(const block_type& block: rec.blocks()) set_range(block);
   }
 
   /**
-   * Connects all blocks of this instance to one block, applying the instance
-   * `default_value()` to fill unassigned ranges. Overlapping blocks implicitly
-   * overwrite, where the overlapping contents of later blocks overwrite the
-   * overlapping ranges of earlier blocks.
-   * @return basic_srecord&
+   * Returns the value that is read at unassigned addresses.
+   * @return value_type
    */
-  inline basic_srecord& merge()
-  { return merge(default_value()); }
+  value_type default_value() const noexcept
+  { return record_.default_value(); }
 
   /**
-   * Returns the address of the first byte where the `sequence`
-   * was found, or `end()` if the sequence was not found at all.
-   * @param const data_type& sequence
-   * @param address_type start_address
-   * @return address_type
+   * Sets the value that is read at unassigned addresses.
+   * @param value_type val
    */
-  address_type find(const data_type& sequence, address_type start_address=0) const
+  void default_value(value_type val) noexcept
+  { record_.default_value(val); }
+
+  /**
+   * Returns true if no byte is assigned.
+   * @return bool
+   */
+  bool empty() const noexcept
+  { return pages_ == 0; }
+
+  /**
+   * Returns the number of allocated pages.
+   * @return size_type
+   */
+  size_type pages() const noexcept
+  { return pages_; }
+
+  /**
+   * Returns the number of pages, which are shared with other images
+   * (forks or copies of this image).
+   * @return size_type
+   */
+  size_type shared_pages() const noexcept
   {
-    const size_type seq_size = sequence.size();
-    if(sequence.empty() || blocks().empty() || ((start_address < sadr()) && ((start_address+seq_size) > eadr()))) {
-      return eadr();
+    size_type n = 0;
+    for(const auto& table: directory_) {
+      if(!table) continue;
+      const bool shared_table = table.use_count() > 1;
+      for(const auto& page: table->pages) n += (page && (shared_table || (page.use_count() > 1))) ? 1 : 0;
     }
-    // As all exported methods connect blocks, it is assured that a
-    // sequence cannot spread across multiple blocks.
-    size_type i_block = 0;
-    while(i_block < blocks().size() && blocks()[i_block].eadr() < start_address) {
-      ++i_block;
-    }
-    if(i_block >= blocks().size()) {
-      return eadr();
-    }
-    // Initial in-block vector index.
-    size_type i = (start_address > blocks()[i_block].sadr()) ? (start_address - blocks()[i_block].sadr()) : 0;
-    // Block iteration
-    while(i_block < blocks().size()) {
-      // Analyse block ...
-      const data_type& bytes = blocks()[i_block].bytes();
-      size_type block_size = bytes.size();
-      // Iterate bytes
-      while(i < block_size) {
-        // Find first byte match.
-        while(i < block_size) {
-          if(bytes[i] == sequence[0]) break;
-          ++i;
-        }
-        if(i >= block_size) {
-          // Not found here, next block
-          break;
-        } else if(seq_size <= 1) {
-          // Special case: first match already enough.
-          return blocks()[i_block].sadr() + i;
-        } else {
-          // Check next matches (byte compare from position i, and 1 in the sequence).
-          size_type j = i;
-          size_type match_size = 1;
-          while(++j < block_size) {
-            if(sequence[match_size] == bytes[j]) {
-              if(++match_size >= seq_size) {
-                // The complete seq starting at i matched --> return address.
-                return blocks()[i_block].sadr() + i;
-              }
-            } else {
-              break; // No match, retry with next i.
-            }
-          }
-        }
-        ++i;
-      }
-      ++i_block;
-      i = 0;
-    }
-    return eadr(); // Not found
+    return n;
   }
 
-  #if(__cplusplus >= 201700L)
-
-  enum class endianess_type { little_endian, big_endian };
+  /**
+   * Returns the number of assigned bytes.
+   * @return size_type
+   */
+  size_type size() const noexcept
+  {
+    size_type n = 0;
+    for_each_page([&n](address_type, const page_type& page) {
+      for(size_type i=0; i<mask_words; ++i) n += bit_count(page.mask[i]);
+    });
+    return n;
+  }
 
   /**
-   * Returns the endianess interpretet value from a given start address, or
-   * an empty optional if the range of the given address and the data type
-   * is smaller than the data type.
-   * @tparam IntegralType
+   * Returns true if a byte is assigned at the given address.
    * @param address_type address
-   * @param endianess_type endianess
-   * @return std::optional<ValueType>
+   * @return bool
    */
-  template <typename IntegralType>
-  std::optional<IntegralType> get(address_type address, endianess_type endianess) const
+  bool assigned(address_type address) const noexcept
   {
-    static_assert(std::is_integral<IntegralType>::value, "get<> only for integers, use <cstdint> types.");
-    using itype = IntegralType;
-    constexpr size_type size = sizeof(itype);
-    if constexpr (size==1) {
-      (void)endianess;
-      for(const auto& block:blocks()) {
-        if((address >= block.sadr()) && (address < block.eadr())) {
-          return std::optional<itype>(block.bytes()[size_type(address-block.sadr())]);
-        }
-      }
-      return std::optional<itype>();
-    } else {
-      auto r = std::optional<itype>();
-      auto ranges = get_ranges(address, address+size);
-      auto data = data_type();
-      if(ranges.empty()) {
-        return r;
-      } else if(ranges.size()==1) {
-        data.swap(ranges.front().bytes());
-      } else {
-        for(const auto b:ranges[0].bytes()) data.push_back(b);
-        for(size_type i=1; i<ranges.size(); ++i) {
-          if(ranges[i-1].eadr() != ranges[i].sadr()) return r; // there is a gap.
-          for(const auto b:ranges[i].bytes()) data.push_back(b);
-        }
-      }
-      if(data.size() != size) return r;
-      auto value = itype(0);
-      switch(endianess) {
-        case endianess_type::big_endian: {
-          for(size_type i=0; i<size; ++i) value = (value<<8)|itype(data[i]);
-          r = value;
-          break;
-        }
-        case endianess_type::little_endian: {
-          for(auto i=int(size)-1; i>=0; --i) value = (value<<8)|itype(data[i]);
-          r = value;
-          break;
-        }
-        default:
-          break;
-      }
-      return r;
-    }
+    const page_type* page = find_page(address);
+    if(!page) return false;
+    const size_type i = size_type(address) & (page_size-1);
+    return (page->mask[i/64] >> (i%64)) & 1u;
   }
 
   /**
-   * Writes the bytes at a specified address according to a given value with a given endianess.
-   * @tparam IntegralType
+   * Returns the byte at the given address, or the `default_value()`
+   * if the address is not assigned.
    * @param address_type address
-   * @param endianess_type endianess
-   * @param IntegralType value
-   * @return basic_srecord&
+   * @return value_type
    */
-  template <typename IntegralType>
-  basic_srecord& set(address_type address, endianess_type endianess, const IntegralType value)
+  value_type get(address_type address) const noexcept
   {
-    static_assert(std::is_integral<IntegralType>::value, "set<> only for integers, use <cstdint> types.");
-    using itype = typename std::decay<IntegralType>::type;
-    constexpr size_type size = sizeof(itype);
-    data_type data(size, 0);
-    if constexpr (size==1) {
-      (void)endianess;
-      data[0] = static_cast<typename data_type::value_type>(value);
-    } else {
-      itype val = value;
-      for(auto i=int(size)-1; i>=0; --i) {
-        data[i] = typename data_type::value_type(val & 0xff);
-        val >>= 8;
-      }
-      switch(endianess) {
-        case endianess_type::little_endian:
-          std::reverse(data.begin(), data.end());
-          break;
-        default:
-          break;
-      }
-    }
-    return set_range(address, data);
+    const page_type* page = find_page(address);
+    if(!page) return default_value();
+    const size_type i = size_type(address) & (page_size-1);
+    return ((page->mask[i/64] >> (i%64)) & 1u) ? page->data[i] : default_value();
   }
 
-  #endif
-
-private:
+  /**
+   * Assigns a byte at the given address. Addresses exceeding the
+   * 32 bit range are ignored.
+   * @param address_type address
+   * @param value_type value
+   */
+  void set(address_type address, value_type value)
+  {
+    page_type* page = get_page(address);
+    if(!page) return;
+    const size_type i = size_type(address) & (page_size-1);
+    page->data[i] = value;
+    page->mask[i/64] |= std::uint64_t(1) << (i%64);
+    blocks_valid_ = false;
+  }
 
   /**
-   * Merges blocks. Fills unassigned ranges in between with with `fill_value`.
-   * @param block_container_type&& blocks
-   * @return block_type
+   * Assigns a range of bytes starting at the given address, bytes
+   * exceeding the 32 bit address range are ignored.
+   * @tparam typename Iterator
+   * @param address_type address
+   * @param Iterator it
+   * @param Iterator end
    */
-  static block_type connect(block_container_type&& blocks, value_type fill_value)
+  template <typename Iterator>
+  void set_range(address_type address, Iterator it, const Iterator end)
   {
-    block_type block;
-    if(blocks.empty()) return block;
-    if(blocks.size() < 2) return blocks.front();
-    reorder(blocks);
-    for(size_type i=1; i<blocks.size(); ++i) {
-      block_type& a = blocks[i-1];
-      block_type& b = blocks[i];
-      if(a.eadr() == b.sadr()) {
-        continue;
-      } else {
-        while(a.eadr() > b.sadr()) a.bytes().pop_back();
-        while(a.eadr() < b.sadr()) a.bytes().push_back(fill_value);
-      }
-    }
-    {
-      size_type sz = 0;
-      for(auto& e: blocks) {
-        sz += e.size();
-      }
-      block.sadr(blocks.front().sadr());
-      if(!sz) return block;
-      block.bytes().swap(blocks.front().bytes());
-      block.bytes().reserve(sz);
-      for(auto& blk: blocks) {
-        for(auto byte: blk.bytes()) {
-          block.bytes().push_back(byte);
-        }
-        data_type().swap(blk.bytes());
-      }
+    while((it != end) && (address < address_limit)) {
+      page_type* page = get_page(address);
+      size_type i = size_type(address) & (page_size-1);
+      const size_type first = i;
+      for(; (i < page_size) && (it != end); ++i, ++it) page->data[i] = value_type(*it);
+      set_bits(page->mask, first, i);
+      address += address_type(i-first);
+      blocks_valid_ = false;
     }
-    return block;
   }
 
   /**
-   * Reorders blocks, so that the start addresses are sorted
-   * ascending.
-   * @param block_container_type& blocks
+   * Assigns a range of bytes starting at the given address.
+   * @param address_type address
+   * @param const data_type& data
+   */
+  void set_range(address_type address, const data_type& data)
+  { set_range(address, data.begin(), data.end()); }
+
+  /**
+   * Assigns the bytes of a block.
+   * @param const block_type& block
+   */
+  void set_range(const block_type& block)
+  { set_range(block.sadr(), block.bytes().begin(), block.bytes().end()); }
+
+  /**
+   * Assigns `value` to all bytes in the address range, e.g. to
+   * fill gaps without allocating unaffected pages.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @param value_type value
    */
-  static inline void reorder(block_container_type& blocks)
+  void fill(address_type start_address, address_type end_address, value_type value)
   {
-    if(blocks.size() < 2) return;
-    std::sort(blocks.begin(), blocks.end(), [](const block_type& a, const block_type& b){
-      return a.sadr() < b.sadr();
-    });
+    if(end_address > address_limit) end_address = address_limit;
+    while(start_address < end_address) {
+      page_type* page = get_page(start_address);
+      const size_type i = size_type(start_address) & (page_size-1);
+      const size_type n = ((end_address-start_address) < address_type(page_size-i)) ? size_type(end_address-start_address) : (page_size-i);
+      std::fill(page->data+i, page->data+i+n, value);
+      set_bits(page->mask, i, i+n);
+      start_address += address_type(n);
+      blocks_valid_ = false;
+    }
   }
 
   /**
-   * Extends a block to a given start/end address, filling the unassigned
-   * bytes with a `fill_value`. Note: This function does not shrink the
-   * block.
-   * @param block_type& block
+   * Unassigns the bytes in the address range, pages without assigned
+   * bytes are released.
    * @param address_type start_address
    * @param address_type end_address
-   * @param value_type fill_value
-   * @return block_type
    */
-  static void extend(block_type& block, address_type start_address, address_type end_address, value_type fill_value)
+  void remove_range(address_type start_address, address_type end_address)
   {
-    if(start_address >= end_address) return;
-    data_type& bytes = block.bytes();
-    if(start_address < block.sadr()) {
-      size_type offset = block.sadr() - start_address;
-      bytes.resize(bytes.size() + offset);
-      size_type i = bytes.size()-offset, j = bytes.size();
-      while(i) bytes[--j] = bytes[--i];
-      while(j) bytes[--j] = fill_value;
-      block.sadr(start_address);
+    if(end_address > address_limit) end_address = address_limit;
+    while(start_address < end_address) {
+      const size_type i = size_type(start_address) & (page_size-1);
+      const size_type n = ((end_address-start_address) < address_type(page_size-i)) ? size_type(end_address-start_address) : (page_size-i);
+      std::shared_ptr<table_type>& table = directory_[directory_index(start_address)];
+      if(table && table->pages[table_index(start_address)]) {
+        std::shared_ptr<page_type>& page = writable(table)->pages[table_index(start_address)];
+        if(n < page_size) clear_bits(writable(page)->mask, i, i+n);
+        if((n == page_size) || std::all_of(page->mask, page->mask+mask_words, [](std::uint64_t w){ return w == 0; })) {
+          page.reset();
+          --pages_;
+        }
+        blocks_valid_ = false;
+      }
+      start_address += address_type(n);
     }
-    while(end_address > block.eadr()) bytes.push_back(fill_value);
   }
 
   /**
-   * Shrinks a block to a given start/end address
-   * @param block_type& block
+   * Returns a block with the bytes from `start_address` to `end_address`,
+   * unassigned bytes are filled with `fill_value`.
    * @param address_type start_address
    * @param address_type end_address
+   * @param value_type fill_value
    * @return block_type
    */
-  static void shrink_to(block_type& block, address_type start_address, address_type end_address)
+  block_type get_range(address_type start_address, address_type end_address, value_type fill_value) const
   {
-    if(start_address >= end_address) {
-      block.sadr(block.eadr());
-      block.bytes().clear();
-      return;
-    } else {
-      data_type& bytes = block.bytes();
-      const size_type size = ((end_address-start_address) <= bytes.size()) ? (end_address-start_address) : bytes.size();
-      if(start_address > block.sadr()) {
-        const size_type offset = start_address - block.sadr();
-        size_type i = offset, j = 0;
-        while(i < bytes.size()) bytes[j++] = bytes[i++];
-        block.sadr(start_address);
+    block_type block(start_address);
+    if(start_address >= end_address) return block;
+    data_type& bytes = block.bytes();
+    bytes.reserve(size_type(end_address-start_address));
+    while(start_address < end_address) {
+      const size_type i = size_type(start_address) & (page_size-1);
+      const size_type n = ((end_address-start_address) < address_type(page_size-i)) ? size_type(end_address-start_address) : (page_size-i);
+      const page_type* page = find_page(start_address);
+      if(!page) {
+        bytes.insert(bytes.end(), n, fill_value);
+      } else {
+        for(size_type k=i; k<i+n; ++k) {
+          bytes.push_back(((page->mask[k/64] >> (k%64)) & 1u) ? page->data[k] : fill_value);
+        }
       }
-      bytes.resize(size);
+      start_address += address_type(n);
     }
+    return block;
   }
 
   /**
-   * Returns a c-string of an error code.
-   *
-   * @param error_type e
-   * @return const char*
+   * Returns a block with the bytes from `start_address` to `end_address`,
+   * unassigned bytes are filled with the `default_value()`.
+   * @param address_type start_address
+   * @param address_type end_address
+   * @return block_type
    */
-  static const char* strerr(error_type e)
-  {
-    static const char* es[] = {
-      "Ok",
-      "[parse] Unacceptable character",
-      "[parse] Line not starting with S",
-      "[parse] Invalid line length",
-      "[parse] Invalid record type",
-      "[parse] Line checksum mismatch",
-      "[parse] Line data length mismatch",
-      "[parse] Missing record header (S0)",
-      "[parse] S0 address field is nonzero",
-      "[parse] Duplicate S5/S6 line found",
-      "[parse] Number of data lines does not match the declaration (S5/S6)",
-      "[parse] Duplicate start address specification (S7/S8/S9)",
-      "[parse] Missing start address line (S7/S8/S9)",
-      "[parse] Missing data lines (S1/S2/S3)",
-      "[parse] Mixed data types in one record (S1/S2/S3)",
-      "[compose] The output has too many data lines for the S5/S6 line data.",
-      "[validate] The specified record type (S1/S2/S3) is to small for the needed data address range.",
-      "[validate] The data range exceeds the greatest possible address of an s-record.",
-      "[validate] No binary data blocks to write found in a record.",
-      "[validate] Unordered data blocks detected",
-      "[validate] Overlapping data blocks detected (address range collision)",
-      "[load] Opening file failed",
-      ""
-    };
-    return (e < sizeof(es)/sizeof(const char*)) ? es[e] : "unknown error";
-  };
+  block_type get_range(address_type start_address, address_type end_address) const
+  { return get_range(start_address, end_address, default_value()); }
 
   /**
-   * Parse a line
-   *
-   * @param std::string&& line
-   * @param line_type& rec
-   * @return bool
+   * Returns the assigned data as ordered, non-adjacent blocks. The blocks
+   * are derived from the pages on the first call after a modification.
+   * Note: The first call after a modification is not thread safe.
+   * @return const block_container_type&
    */
-  inline bool parse_line(std::string&& line, line_type& rec)
+  const block_container_type& blocks() const
   {
-    if(!good()) return false;
-    std::transform(line.begin(), line.end(), line.begin(), ::toupper);
-    if(line.find_first_not_of("0123456789ABCDEFS") != std::string::npos) {
-      return error(e_parse_unacceptable_character);
-    } else if(line[0] != 'S') {
-      return error(e_parse_line_not_starting_with_s);
-    } else if((line[1] < '0') || (line[1] > '9')) {
-      return error(e_parse_invalid_record_type);
-    } else if((line.length() & 0x01) || (line.length() < 10) || (line.length() > 514)) {
-      // Line length not even, or less than minimum of 10 === "SxLLAAAACC", L=length bytes, A=address bytes, C=cksum
-      return error(e_parse_invalid_line_length);
-    } else {
-      // HEX->blob
-      std::deque<typename data_type::value_type> bin;
-      bin.push_back(line[1]-'0'); // S0 to S9 --> value 0 to 9.
-      for(size_type i=2; i < line.length(); i+=2) {
-        bin.push_back(0
-          | ((line[i+0] - (line[i+0] >= 'A' ? ('A'-10) : '0')) << 4)
-          | ((line[i+1] - (line[i+1] >= 'A' ? ('A'-10) : '0')) << 0)
-        );
-      }
-      // Record type check
-      {
-        record_type_type type = (record_type_type) bin[0];
-        if((type > 9) || (type == 4)) {
-          // S0 --> S9, S4 is reserved
-          return error(e_parse_invalid_record_type);
-        }
-        rec.type = type;
-      }
-      // Checksum
-      {
-        unsigned cksum = 0;
-        for(size_type i=1; i < bin.size()-1; ++i) cksum += bin[i];
-        cksum = (~cksum) & 0xff;
-        if(cksum != bin[bin.size()-1]) {
-          return error(e_parse_chcksum_incorrect);
-        }
-      }
-      // Byte count
-      {
-        unsigned byte_count = bin[1];
-        if((byte_count < 3u) || (byte_count != bin.size()-2u)) {
-          return error(e_parse_length_mismatch);
-        }
-      }
-      // Pop type, byte count, checksum
-      {
-        bin.pop_front();
-        bin.pop_front();
-        bin.pop_back();
-      }
-      // Address
-      {
-        address_type adr = 0;
-        switch((unsigned)rec.type) {
-          case 0: // Block header, address must be zero
-            if(bin[0] || bin[1]) {
-              return error(e_parse_s0_address_nonzero);
-            }
-            bin.pop_front();
-            bin.pop_front();
-            break;
-          case 1: // Data line, 16 bit address
-          case 2: // Data line, 24 bit address
-          case 3: // Data line, 32 bit address
-            for(unsigned i=rec.type+1; i; --i) {
-              adr <<= 8; adr |= bin.front(); bin.pop_front();
-            }
-            break;
-          case 5: // Optional block line count: 16 bit value
-          case 6: // Optional block line count: 24 bit value
-            for(unsigned i=rec.type-3; i; --i) {
-              adr <<= 8; adr |= bin.front(); bin.pop_front();
-            }
-            break;
-          case 7: // Block termination for S3: Start Address 32bit address
-          case 8: // Block termination for S2: Start Address 24bit address
-          case 9: // Block termination for S1: Start Address 16bit address
-            for(unsigned i=11-rec.type; i; --i) {
-              adr <<= 8; adr |= bin.front(); bin.pop_front();
-            }
-            break;
-          default:
-            return error(e_parse_invalid_record_type);
-        }
-        rec.address = adr;
-      }
-      // Data
-      {
-        if(!bin.empty()) {
-          rec.bytes.resize(bin.size());
-          std::copy(bin.begin(), bin.end(), rec.bytes.begin());
+    if(!blocks_valid_) {
+      block_container_type blocks;
+      for_each_page([&blocks](address_type page_address, const page_type& page) {
+        size_type i = 0;
+        while(i < page_size) {
+          // Skip unassigned bytes, whole words at once.
+          if(!(page.mask[i/64] >> (i%64))) { i = (i/64+1)*64; continue; }
+          if(!((page.mask[i/64] >> (i%64)) & 1u)) { ++i; continue; }
+          size_type j = i;
+          while(j < page_size) {
+            if((!(j%64)) && (page.mask[j/64] == ~std::uint64_t(0))) { j += 64; continue; }
+            if(!((page.mask[j/64] >> (j%64)) & 1u)) break;
+            ++j;
+          }
+          const address_type address = page_address + address_type(i);
+          if(blocks.empty() || (blocks.back().eadr() != address)) blocks.push_back(block_type(address));
+          data_type& bytes = blocks.back().bytes();
+          bytes.insert(bytes.end(), page.data+i, page.data+j);
+          i = j;
         }
-      }
-      // Alright
-      return true;
+      });
+      blocks_.swap(blocks);
+      blocks_valid_ = true;
     }
+    return blocks_;
   }
 
   /**
-   * Analyse a parsed block, return success.
-   *
-   * @param line_container_type& lines
-   * @return bool
+   * Returns a record with the image data and the record settings of
+   * the image.
+   * @return srecord_type
    */
-  inline bool parse_analyze_block(line_container_type& lines)
+  srecord_type srecord() const
   {
-    if(!good()) return false;
-    // Collect and check line data
-    if(lines.empty()) {
-      return error(e_parse_missing_data_lines);
-    } else if(lines.front().type != 0) {
-      if(strict_parsing()) return error(e_parse_missing_s0);
-    } else {
-      header_ = lines.front().bytes; // Checked for multiple headers already in parse().
-      lines.pop_front();
-    }
-    record_type_type type = type_undefined;  // S1/S2/S3
-    bool have_start_address = false;  // S7/S8/S9
-    long spec_count = 0; // S5/S6
-    long count = 0; // Check for S5/S6
-    for(auto& e: lines) {
-      if(e.type < 4) {
-        type = e.type;
-        break;
-      }
-    }
-    if(!type) {
-      return error(e_parse_missing_data_lines);
-    }
-    type_ = type;
-    for(auto e: lines) {
-      if(e.type < 4) {
-        // Data lines (header is out)
-        if((e.type != type) && strict_parsing()) {
-          return error(e_parse_mixed_data_line_types);
-        }
-        if((!blocks_.empty()) && (e.address == (blocks_.back().sadr() + blocks_.back().size()))) {
-          for(auto ee: e.bytes) {
-            blocks_.back().bytes().push_back(ee);
-          }
-        } else {
-          block_type block;
-          block.sadr(e.address);
-          block.bytes() = e.bytes;
-          if(blocks_.empty() || (block.sadr() >= blocks_.back().sadr())) {
-            blocks_.push_back(block); // vector: push is fast.
-          } else {
-            typename block_container_type::iterator it = blocks_.begin();
-            while(it != blocks_.end() && (block.sadr() >= it->sadr())) ++it;
-            blocks_.insert(it, block);
-          }
-        }
-        ++count;
-      } else if(e.type < 7) {
-        // Line count lines
-        if(spec_count) {
-          return error(e_parse_duplicate_data_count);
-        }
-        spec_count = (long) e.address;
-      } else {
-        // Start addresses S7/S8/S9
-        // S<0, S4, S>9 already filtered out, S0/1/2/3 and S5/6 handled above --> S7/8/9 left.
-        if(have_start_address && strict_parsing()) {
-          return error(e_parse_duplicate_start_address);
-        }
-        have_start_address = true;
-        if((e.type != 10-type) && strict_parsing()) return error(e_parse_startaddress_vs_data_type_mismatch);
-        start_address_ = e.address;
-      }
-    }
-    if(spec_count && (spec_count != count)) {
-      return error(e_parse_line_count_mismatch);
-    }
-    // All ok
-    return true;
+    srecord_type rec = record_;
+    rec.blocks() = blocks();
+    return rec;
   }
 
   /**
-   * Error setter
-   * @param error_type e
-   * @return bool
+   * Returns the record settings (header, type, start address,
+   * parser settings). The record blocks of the settings are not
+   * used.
+   * @return srecord_type&
    */
-  inline bool error(error_type e)
-  { error_ = e; return e == e_ok; }
+  srecord_type& settings() noexcept
+  { return record_; }
 
   /**
-   * Connects blocks where the condition
-   * block[n].end() == block[n+1].begin()
+   * Returns the record settings.
+   * @return const srecord_type&
    */
-  inline void connect_adjacent_blocks()
-  {
-    if(blocks().size() < 2) return;
-    size_type i=0, j=1;
-    while(j < blocks().size() && blocks()[i].empty()) {
-      ++i; ++j;
-    }
-    while(j < blocks().size()) {
-      if((blocks()[i].eadr() != blocks()[j].sadr())) {
-        i = j++;
-      } else {
-        block_type& a = blocks()[i];
-        block_type b;
-        b.swap(blocks()[j]);
-        a.bytes().reserve(a.bytes().size()+b.bytes().size()); // append b to a
-        for(auto e: b.bytes()) a.bytes().push_back(e);
-        ++j;
-      }
-    }
-    remove_empty_blocks();
-  }
+  const srecord_type& settings() const noexcept
+  { return record_; }
 
   /**
-   * Erases blocks with the size 0 from the block container.
+   * Composes the image as S-record. Returns success, the error
+   * details are in `settings().error()`.
+   * @param std::ostream& os
+   * @param size_type line_length
+   * @return bool
    */
-  inline void remove_empty_blocks()
+  bool compose(std::ostream& os, size_type line_length=0)
   {
-    block_container_type blks;
-    blks.swap(blocks_); // now the memory is in blks
-    for(auto& e: blks) {
-      if(!e.empty()) {
-        blocks_.push_back(block_type()); // push fresh instance, and ...
-        blocks_.back().swap(e);  // swap the contents.
-      }
-    }
+    srecord_type rec = srecord();
+    const bool ok = rec.compose(os, line_length);
+    rec.blocks().clear();
+    record_ = rec;
+    return ok;
   }
 
-  /**
-   * Number to hex
-   *
-   * @tparam typename T
-   * @param T n
-   * @return std::string
-   */
-  template <typename T>
-  static inline std::string numtohex(T n)
+private:
+
+  static inline size_type directory_index(address_type address) noexcept
+  { return size_type(address >> (page_bits+table_bits)) & (directory_size-1); }
+
+  static inline size_type table_index(address_type address) noexcept
+  { return size_type(address >> page_bits) & (table_size-1); }
+
+  static inline size_type bit_count(std::uint64_t w) noexcept
+  { size_type n=0; while(w) { w &= w-1; ++n; } return n; }
+
+  static inline void set_bits(std::uint64_t* mask, size_type first, const size_type last) noexcept
   {
-    static const char* hx = "0123456789ABCDEF";
-    constexpr size_type num_chars = sizeof(T)*2;
-    char s[num_chars+1];
-    s[num_chars] = '\0';
-    char *p = &(s[num_chars]);
-    while(p > s) {
-      *(--p) = hx[n & 0xf];
-      n >>= 4;
-    }
-    return std::string(p);
+    for(; (first < last) && (first % 64); ++first) mask[first/64] |= std::uint64_t(1) << (first%64);
+    for(; first+64 <= last; first += 64) mask[first/64] = ~std::uint64_t(0);
+    for(; first < last; ++first) mask[first/64] |= std::uint64_t(1) << (first%64);
   }
 
-  /**
-   * Number to hex, width specified in bytes
-   *
-   * @param unsigned long n
-   * @param unsigned width
-   * @return std::string
-   */
-  template <typename T>
-  static inline std::string numtohex(T n, unsigned width)
+  static inline void clear_bits(std::uint64_t* mask, size_type first, const size_type last) noexcept
   {
-    static const char* hx = "0123456789ABCDEF";
-    char s[33];
-    if(width > 4) {
-      width = 4; // limit width to 32bit
-    } else if(!width) {
-      width = 1; // limit width to 8bit
-    }
-    s[sizeof(s)-1] = '\0'; // terminate @ last char
-    char *p = &(s[sizeof(s)-1]); // intentionally sizeof(s), as --p below.
-    width <<= 1; // * 2 --> byte to hex chars
-    while(width--) {
-      *(--p) = hx[n & 0xf];
-      n >>= 4;
-    }
-    return std::string(p);
+    for(; (first < last) && (first % 64); ++first) mask[first/64] &= ~(std::uint64_t(1) << (first%64));
+    for(; first+64 <= last; first += 64) mask[first/64] = 0;
+    for(; first < last; ++first) mask[first/64] &= ~(std::uint64_t(1) << (first%64));
   }
 
-  /**
-   * Container of numbers to hex
-   *
-   * @tparam typename ContainerType
-   * @param const ContainerType bin
-   * @return std::string
-   */
-  template <typename ContainerType>
-  static inline std::string tohex(const ContainerType& bin) {
-    std::string s;
-    for(auto e:bin) s += numtohex(e);
-    return s;
+  const page_type* find_page(address_type address) const noexcept
+  {
+    if(address >= address_limit) return nullptr;
+    const table_type* table = directory_[directory_index(address)].get();
+    return table ? table->pages[table_index(address)].get() : nullptr;
+  }
+
+  page_type* get_page(address_type address)
+  {
+    if(address >= address_limit) return nullptr;
+    std::shared_ptr<table_type>& table = directory_[directory_index(address)];
+    if(!table) table = std::make_shared<table_type>();
+    std::shared_ptr<page_type>& page = writable(table)->pages[table_index(address)];
+    if(!page) { page = std::make_shared<page_type>(); ++pages_; return page.get(); }
+    return writable(page);
   }
 
   /**
-   * Calculate the line checksum
-   * @tparam ContainerType
-   * @param const ContainerType& bin
-   * @return value_type
+   * Copy-on-write: Duplicates `p` if it is shared with another image.
+   * The acquire fence orders the own writes after the reads of images,
+   * which released their references.
    */
-  template <typename ContainerType>
-  static value_type cksum(const ContainerType& bin)
+  template <typename T>
+  static T* writable(std::shared_ptr<T>& p)
   {
-    unsigned cksum = 0;
-    for(auto e:bin) cksum += e;
-    cksum = (~(cksum)) & 0xff;  // complement, only one byte.
-    return (value_type) cksum;
+    if(p.use_count() > 1) {
+      p = std::make_shared<T>(*p);
+    } else {
+      std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    return p.get();
   }
 
-private:
+  template <typename Fn>
+  void for_each_page(Fn&& fn) const
+  {
+    for(size_type i=0; i<directory_size; ++i) {
+      const table_type* table = directory_[i].get();
+      if(!table) continue;
+      for(size_type j=0; j<table_size; ++j) {
+        if(!table->pages[j]) continue;
+        fn(address_type((i << table_bits) | j) << page_bits, *table->pages[j]);
+      }
+    }
+  }
 
-  error_type error_;              ///< Current error
-  record_type_type type_;         ///< Type of the data lines (S1,S2 or S3)
-  address_type start_address_;    ///< Address offset from the S9/S8/S7 address field.
-  data_type header_;              ///< Binary data of the S0 field (without address and checksum)
-  block_container_type blocks_;   ///< Contains unconnected blocks of memory ranges.
-  unsigned long parser_line_;     ///< Line counter of the parser
-  address_type error_address_;    ///< The address where an error was found
-  value_type default_value_;      ///< The value that is read in unset address ranges (e.g. RAM 0x00, FLASH 0xff).
-  bool strict_parsing_;           ///< Raises errors if the S-record does not encompass complete information, e.g. if the S0 or S5/S6 is missing.
+private:
 
+  std::vector<std::shared_ptr<table_type>> directory_;  ///< Page table directory (shared, copy-on-write).
+  srecord_type record_;                                 ///< Record settings, without blocks.
+  size_type pages_;                                     ///< Number of allocated pages.
+  mutable block_container_type blocks_;                 ///< Derived blocks cache ...
+  mutable bool blocks_valid_;                           ///< ... and its validity.
 };
+
 }}
 
 /**
@@ -1920,6 +7598,21 @@ std::istream& operator>>(std::istream& is, sw::detail::basic_srecord<V,C>& rec)
  */
 namespace sw {
   using srecord = detail::basic_srecord<unsigned char>;
+  using srecord_parser = srecord::parser_type;
+  using paged_image = detail::basic_paged_image<srecord>;
 }
 
+#ifdef SRECORD_WITH_PMR
+/**
+ * Polymorphic allocator specialisation, e.g. to allocate a complete
+ * parse/modify/compose cycle from one `std::pmr::monotonic_buffer_resource`:
+ *
+ *  std::pmr::monotonic_buffer_resource arena;
+ *  sw::pmr::srecord srec(&arena);
+ */
+namespace sw { namespace pmr {
+  using srecord = detail::basic_srecord<unsigned char, std::pmr::vector<unsigned char>>;
+}}
+#endif
+
 #endif
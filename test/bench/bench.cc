@@ -0,0 +1,273 @@
+/**
+ * @file bench.cc
+ * @package de.atwillys.cc.swl
+ * @license BSD (simplified)
+ * @author Stefan Wilhelm (stfwi)
+ * -----------------------------------------------------------------------------
+ * Microbenchmarks for synthetic images (`make bench`, arguments via
+ * `make bench BENCH_ARGS="..."`):
+ *
+ *  --max-size=<n>[K|M|G]   Largest image data size (default 16M, up to 1G).
+ *  --min-time=<seconds>    Minimum measuring time per benchmark (default 0.2).
+ *  --format=text|csv|json  Output format, csv/json are machine-readable.
+ *  --filter=<text>         Only run benchmarks whose name contains <text>.
+ *  --tmp=<path>            Temporary file for `load` (default bench.tmp.s19).
+ *
+ * Images are generated for sizes from 1K to the maximum size, with the
+ * layouts "dense" (one block), "large" (16 blocks) and "small" (256 byte
+ * blocks with gaps), and the record types S1/S2/S3 fitting the address
+ * range. Each result has the time per operation (ns/op) and the data
+ * throughput (MB/s, 1MB = 1e6 bytes).
+ */
+#include <sw/srecord.hh>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <random>
+
+using namespace std;
+using sw::srecord;
+typedef srecord::address_type address_type;
+typedef srecord::size_type size_type;
+typedef srecord::data_type data_type;
+
+namespace {
+
+  struct options_type
+  {
+    size_type max_size = size_type(16) << 20;
+    double min_time = 0.2;
+    string format = "text";
+    string filter;
+    string tmp = "bench.tmp.s19";
+  };
+
+  options_type options;
+
+  /**
+   * Synthetic image: `size` data bytes in the given layout and record type.
+   */
+  struct image_type
+  {
+    string layout;
+    srecord::record_type_type type;
+    size_type size;
+    srecord rec;
+    string text;
+  };
+
+  const char* type_name(srecord::record_type_type type)
+  {
+    switch(type) {
+      case srecord::type_s1_16bit: return "S1";
+      case srecord::type_s2_24bit: return "S2";
+      default: return "S3";
+    }
+  }
+
+  /**
+   * Address span of the layout (data and gaps).
+   */
+  address_type layout_span(const string& layout, size_type size)
+  { return (layout == "small") ? address_type(2*size) : address_type(size + ((layout == "large") ? 16*64 : 0)); }
+
+  image_type make_image(const string& layout, srecord::record_type_type type, size_type size)
+  {
+    image_type img;
+    img.layout = layout;
+    img.type = type;
+    img.size = size;
+    std::mt19937 rnd(unsigned(size) ^ unsigned(type));
+    data_type data(size);
+    for(auto& e: data) e = ((rnd() & 0x3) == 0) ? 0xff : srecord::value_type(rnd());
+    const address_type base = (type == srecord::type_s1_16bit) ? 0 : ((type == srecord::type_s2_24bit) ? 0x10000 : 0x08000000);
+    img.rec.header_str("bench");
+    img.rec.type(type);
+    img.rec.default_value(0xff);
+    img.rec.start_address_definition(base);
+    if(layout == "dense") {
+      img.rec.set_range(base, data);
+    } else {
+      const size_type chunk = (layout == "large") ? ((size+15)/16) : 256;
+      const address_type gap = (layout == "large") ? 64 : 256;
+      address_type adr = base;
+      for(size_type i=0; i<size; i+=chunk) {
+        const size_type n = std::min(chunk, size-i);
+        img.rec.set_range(adr, data_type(data.begin()+i, data.begin()+i+n));
+        adr += n + gap;
+      }
+    }
+    img.text = img.rec.compose();
+    return img;
+  }
+
+  string size_name(size_type size)
+  {
+    if(size >= (size_type(1)<<30)) return to_string(size >> 30) + "G";
+    if(size >= (size_type(1)<<20)) return to_string(size >> 20) + "M";
+    if(size >= (size_type(1)<<10)) return to_string(size >> 10) + "K";
+    return to_string(size);
+  }
+
+  /**
+   * Runs `fn()` (performing `ops` operations on `bytes` bytes of data)
+   * until `min_time` elapsed, and prints the result. `setup()` is run
+   * before each call and not measured.
+   */
+  template <typename Setup, typename Function>
+  void measure(const char* name, const image_type& img, size_type ops, size_type bytes, Setup&& setup, Function&& fn)
+  {
+    if((!options.filter.empty()) && (string(name).find(options.filter) == string::npos)) return;
+    using clock = std::chrono::steady_clock;
+    double elapsed = 0;
+    size_type runs = 0;
+    while((elapsed < options.min_time) || (!runs)) {
+      setup();
+      const auto t0 = clock::now();
+      fn();
+      elapsed += std::chrono::duration<double>(clock::now() - t0).count();
+      ++runs;
+    }
+    const double ns_per_op = 1e9 * elapsed / double(runs * ops);
+    const double mb_per_s = (bytes && elapsed > 0) ? (double(bytes) * double(runs) / elapsed / 1e6) : 0.0;
+    const string image = img.layout + "/" + type_name(img.type) + "/" + size_name(img.size);
+    const size_type blocks = static_cast<const srecord&>(img.rec).blocks().size();
+    char line[512];
+    if(options.format == "csv") {
+      std::snprintf(line, sizeof(line), "%s,%s,%s,%zu,%zu,%zu,%.1f,%.1f", name, img.layout.c_str(), type_name(img.type),
+        img.size, blocks, runs*ops, ns_per_op, mb_per_s);
+    } else if(options.format == "json") {
+      std::snprintf(line, sizeof(line), "{\"benchmark\":\"%s\",\"layout\":\"%s\",\"type\":\"%s\",\"size\":%zu,\"blocks\":%zu,"
+        "\"ops\":%zu,\"ns_per_op\":%.1f,\"mb_per_s\":%.1f}", name, img.layout.c_str(), type_name(img.type), img.size,
+        blocks, runs*ops, ns_per_op, mb_per_s);
+    } else {
+      std::snprintf(line, sizeof(line), "%-14s %-16s %8zu blocks %14.1f ns/op %10.1f MB/s", name, image.c_str(),
+        blocks, ns_per_op, mb_per_s);
+    }
+    std::cout << line << std::endl;
+  }
+
+  template <typename Function>
+  void measure(const char* name, const image_type& img, size_type ops, size_type bytes, Function&& fn)
+  { measure(name, img, ops, bytes, []{}, fn); }
+
+  void run(const image_type& img)
+  {
+    const srecord& rec = img.rec;
+    const address_type sadr = rec.blocks().front().sadr(), eadr = rec.blocks().back().eadr();
+    std::mt19937 rnd(0xbe4c);
+    vector<address_type> addresses(4096);
+    for(auto& e: addresses) e = sadr + (address_type(rnd()) % (eadr-sadr-8));
+    const size_type text_size = img.text.size();
+
+    measure("parse", img, 1, text_size, [&]{
+      srecord r;
+      if(!r.parse(img.text)) std::cerr << "parse failed: " << r.error_message() << std::endl;
+    });
+    {
+      std::ofstream fs(options.tmp, std::ios::binary);
+      fs << img.text;
+    }
+    measure("load", img, 1, text_size, [&]{ srecord r; srecord::load(options.tmp, r); });
+    measure("load_mapped", img, 1, text_size, [&]{ srecord r; srecord::load_mapped(options.tmp, r); });
+    std::remove(options.tmp.c_str());
+    {
+      srecord r;
+      measure("compose", img, 1, text_size, [&]{ r = rec; }, [&]{ string s = r.compose(); });
+    }
+    if(img.size <= (size_type(1) << 20)) {
+      measure("dump", img, 1, img.size, [&]{ std::ostringstream os; rec.dump(os); });
+    }
+    {
+      srecord r = rec;
+      size_type i = 0;
+      const data_type data(16, 0x55);
+      measure("set_range", img, 1024, 1024*16, [&]{
+        for(size_type k=0; k<1024; ++k) r.set_range(addresses[(i++) % addresses.size()], data);
+      });
+    }
+    {
+      srecord r;
+      size_type i = 0;
+      measure("remove_range", img, 256, 0, [&]{ r = rec; }, [&]{
+        for(size_type k=0; k<256; ++k) { const address_type a = addresses[(i++) % addresses.size()]; r.remove_range(a, a+16); }
+      });
+    }
+    {
+      srecord r;
+      measure("merge", img, 1, img.size, [&]{ r = rec; }, [&]{ r.merge(); });
+    }
+    {
+      const data_type pattern = { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0 };
+      measure("find", img, 1, img.size, [&]{ if(rec.find(pattern) == 0x1234) std::cout << ""; });
+    }
+    #if(__cplusplus >= 201700L)
+    {
+      std::uint64_t sum = 0;
+      measure("get<uint32>", img, addresses.size(), 0, [&]{
+        for(const auto a: addresses) sum += rec.get<std::uint32_t>(a, srecord::endianess_type::little_endian).value_or(0);
+      });
+      if(sum == 1) std::cout << "";
+    }
+    #endif
+  }
+
+  size_type parse_size(string s)
+  {
+    size_type mul = 1;
+    if(!s.empty()) {
+      switch(s.back()) {
+        case 'k': case 'K': mul = size_type(1) << 10; s.pop_back(); break;
+        case 'm': case 'M': mul = size_type(1) << 20; s.pop_back(); break;
+        case 'g': case 'G': mul = size_type(1) << 30; s.pop_back(); break;
+        default: break;
+      }
+    }
+    return size_type(std::strtoull(s.c_str(), nullptr, 10)) * mul;
+  }
+
+}
+
+int main(int argc, char* argv[])
+{
+  for(int i=1; i<argc; ++i) {
+    const string arg = argv[i];
+    const string value = (arg.find('=') != string::npos) ? arg.substr(arg.find('=')+1) : string();
+    if(arg.find("--max-size=") == 0) {
+      options.max_size = std::min(parse_size(value), size_type(1) << 30);
+    } else if(arg.find("--min-time=") == 0) {
+      options.min_time = std::strtod(value.c_str(), nullptr);
+    } else if(arg.find("--format=") == 0) {
+      options.format = value;
+    } else if(arg.find("--filter=") == 0) {
+      options.filter = value;
+    } else if(arg.find("--tmp=") == 0) {
+      options.tmp = value;
+    } else {
+      std::cerr << "Unknown argument: " << arg << std::endl;
+      return 1;
+    }
+  }
+  if(options.format == "csv") {
+    std::cout << "benchmark,layout,type,size,blocks,ops,ns_per_op,mb_per_s" << std::endl;
+  }
+  const char* layouts[] = { "dense", "large", "small" };
+  const srecord::record_type_type types[] = { srecord::type_s1_16bit, srecord::type_s2_24bit, srecord::type_s3_32bit };
+  for(size_type size = 1024; size <= options.max_size; size <<= 4) {
+    for(const auto layout: layouts) {
+      for(const auto type: types) {
+        const address_type range = (type == srecord::type_s1_16bit) ? 0x10000 : ((type == srecord::type_s2_24bit) ? 0xff0000 : 0xf8000000ull);
+        if(layout_span(layout, size) > range) continue;
+        run(make_image(layout, type, size));
+      }
+    }
+    if((size < options.max_size) && ((size << 4) > options.max_size)) size = options.max_size >> 4;
+  }
+  return 0;
+}
@@ -12,6 +12,10 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <deque>
 
 #define srec_dump() { stringstream sss; srec.dump(sss); test_comment(sss.str()); }
 #define range_dump(RNG) { stringstream sss; sss<<"Range(sadr:0x"<<std::hex << long(rng.sadr()) << ", size:" << std::dec << long(rng.size()) << "):\n"; (RNG).dump(sss); test_comment(sss.str()); }
@@ -93,6 +97,49 @@ void test_compose()
   }
 }
 
+/**
+ * @req: Composed records shall have the S0/S1-3/S5-6/S7-9 layout, upper case hex, and one record per line.
+ * @req: Composing to a stream and to a string shall yield identical output for all line lengths.
+ */
+void test_compose_format()
+{
+  srecord rec;
+  rec.header_str("HDR");
+  rec.blocks().push_back(srecord::block_type(0x0010, { 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15 }));
+  rec.start_address_definition(0x10);
+  test_expect( rec.compose(20) ==
+    "S00F000048445200000000000000000012\n"
+    "S10800100001020304DD\n"
+    "S10800150506070809BF\n"
+    "S108001A0A0B0C0D0EA1\n"
+    "S104001F0FCD\n"
+    "S5030004F8\n"
+    "S9030010EC\n"
+  );
+  std::mt19937 rnd(0xc0de);
+  for(auto type: { srecord::type_s1_16bit, srecord::type_s2_24bit, srecord::type_s3_32bit }) {
+    srecord src;
+    src.type(type);
+    src.header_str("composer test");
+    for(address_type adr: { 0x0000u, 0x0100u, 0x1000u }) {
+      data_type data(1+(rnd() % 700));
+      for(auto& e: data) e = value_type(rnd());
+      src.set_range(adr, data);
+    }
+    for(size_type line_length=0; line_length < 100; ++line_length) {
+      std::stringstream ss;
+      test_expect_cond_silent( src.compose(ss, line_length) );
+      const std::string composed = src.compose(line_length);
+      test_expect_cond_silent( composed == ss.str() );
+      srecord parsed;
+      test_expect_cond_silent( parsed.parse(composed) );
+      test_expect_cond_silent( parsed.type() == type );
+      test_expect_cond_silent( parsed.dump() == src.dump() );
+    }
+  }
+  test_expect( ::sw::utest::test::num_fails() == 0 );
+}
+
 /**
  * @req: Retrieving a connected data range from the record shall be possible (filled with value by argument or record default value).
  */
@@ -172,6 +219,55 @@ void test_range_get()
   }
 }
 
+/**
+ * @req: A range view shall cover the requested range with ordered spans, referring to the block data or gaps.
+ * @req: The contents of a range view shall be identical to `get_range()`.
+ */
+void test_range_view()
+{
+  test_note("Range view checks ...");
+  srecord rec;
+  rec.default_value(0xff);
+  rec.set_range(0x0100, data_type{1,2,3,4});
+  rec.set_range(0x0110, data_type{5,6});
+  {
+    const auto view = rec.view(0x00fe, 0x0112);
+    test_expect_eq( view.size(), 0x14u );
+    vector<sw::srecord::span_type> spans(view.begin(), view.end());
+    if(test_expect_cond(spans.size() == 4)) {
+      test_expect( spans[0].fill() && (spans[0].sadr() == 0x00fe) && (spans[0].size() == 2) && (spans[0].value() == 0xff) );
+      test_expect( !spans[1].fill() && (spans[1].sadr() == 0x0100) && (spans[1].size() == 4) && (spans[1][3] == 4) );
+      test_expect( &(*spans[1].begin()) == &rec.blocks().front().bytes().front() );
+      test_expect( spans[2].fill() && (spans[2].sadr() == 0x0104) && (spans[2].eadr() == 0x0110) );
+      test_expect( !spans[3].fill() && (spans[3].size() == 2) && (spans[3][0] == 5) );
+    }
+    test_expect( !view.assigned() );
+    test_expect( rec.view(0x0101, 0x0103).assigned() );
+  }
+  {
+    const auto view = rec.view(0x0120, 0x0100);
+    test_expect( view.empty() );
+    test_expect( view.begin() == view.end() );
+  }
+  {
+    std::mt19937 rnd(0x71e3);
+    for(unsigned i=0; i<30; ++i) {
+      data_type data(1 + (rnd() % 40));
+      for(auto& e: data) e = value_type(rnd());
+      rec.set_range(0x0100 + (rnd() % 0x400), data);
+    }
+    srecord linear = rec;
+    linear.blocks();
+    for(unsigned q=0; q<200; ++q) {
+      const address_type sadr = 0x00f0 + (rnd() % 0x420), eadr = sadr + (rnd() % 0x80);
+      data_type data;
+      rec.view(sadr, eadr, 0x5a).copy(std::back_inserter(data));
+      test_expect_cond_silent( data == rec.get_range(sadr, eadr, 0x5a).bytes() );
+      test_expect_cond_silent( data == linear.get_range(sadr, eadr, 0x5a).bytes() );
+    }
+  }
+}
+
 /**
  * @req: Retrieving a sparse data range from the record shall be possible (with gaps, no gap filling).
  * @req: Altering record data using start address and byte container shall be possible.
@@ -367,6 +463,61 @@ void test_find()
   test_expect_eq( srec.find(data_type{0x01, 0x02}, 0x0022), srec.eadr() );
 }
 
+/**
+ * @req: Searching shall be possible with a byte mask, where mask bits set to 0 are ignored (wildcards).
+ * @req: All (also overlapping) occurrences of a byte sequence shall be reported in ascending address order.
+ * @req: Search results shall not depend on the block lookup mode or sequence length.
+ */
+void test_find_all()
+{
+  test_note("Find all / masked find checks ...");
+  srec.clear();
+  srec.blocks().push_back(mkblock_seq(0x0020, 0x00,  8));
+  srec.blocks().push_back(mkblock_seq(0x0080, 0xa0, 10));
+  test_expect_eq( srec.find(data_type{0x03, 0x00, 0x05}, data_type{0xff, 0x00, 0xff}), 0x0023u );
+  test_expect_eq( srec.find(data_type{0xa0, 0x01}, data_type{0xf0, 0x0f}, 0x0024), 0x0080u );
+  test_expect_eq( srec.find(data_type{0x00}, data_type{0x00}), srec.sadr() );
+  test_expect_eq( srec.find(data_type{0x01, 0x02}, data_type{0xff}), srec.eadr() );
+  test_expect_eq( srec.count(data_type{0x00}, data_type{0x00}), 18u );
+  test_expect_eq( srec.count(data_type{0x00, 0x00}, data_type{0x00, 0x00}, 0x0024), 12u );
+  test_expect_eq( srec.count(data_type{0x07, 0xa0}), 0u );
+  test_expect_eq( srec.count(data_type{}), 0u );
+  {
+    vector<address_type> found;
+    test_expect_eq( srec.find_all(data_type{0xa0}, data_type{0xf0}, [&](address_type adr){ found.push_back(adr); }, 0x0085), 5u );
+    test_expect( (found == vector<address_type>{0x85, 0x86, 0x87, 0x88, 0x89}) );
+  }
+  {
+    std::mt19937 rnd(0xf1d);
+    srecord rec;
+    for(unsigned i=0; i<50; ++i) {
+      data_type data(1 + (rnd() % 300));
+      for(auto& e: data) e = value_type((rnd() % 4) ? 0xff : (rnd() % 3));
+      rec.set_range(address_type(rnd() % 0x4000), data);
+    }
+    const srecord& crec = rec;
+    for(unsigned q=0; q<200; ++q) {
+      data_type seq(1 + (q % 12));
+      for(auto& e: seq) e = value_type((rnd() % 4) ? 0xff : (rnd() % 3));
+      const address_type start = address_type(rnd() % 0x2000);
+      vector<address_type> expected, found;
+      for(const auto& blk: crec.blocks()) {
+        for(size_type i=0; i+seq.size() <= blk.size(); ++i) {
+          if((blk.sadr()+i >= start) && std::equal(seq.begin(), seq.end(), blk.bytes().begin()+i)) {
+            expected.push_back(blk.sadr()+i);
+          }
+        }
+      }
+      const size_type n = rec.find_all(seq, [&](address_type adr){ found.push_back(adr); }, start);
+      test_expect_cond_silent( (found == expected) && (n == expected.size()) );
+      test_expect_cond_silent( crec.find(seq, start) == (expected.empty() ? crec.eadr() : expected.front()) );
+      srecord linear = rec;
+      linear.blocks();
+      test_expect_cond_silent( linear.count(seq, start) == expected.size() );
+    }
+  }
+}
+
 /**
  * @req: Removing ranges (defined by start and end address) from the record data shall be possible.
  */
@@ -435,6 +586,30 @@ void test_remove()
   }
 }
 
+/**
+ * @req: A record with non-contiguous data container (std::deque) shall yield the same results as the default record.
+ */
+void test_deque_container()
+{
+  using deque_srecord = sw::detail::basic_srecord<unsigned char, std::deque<unsigned char>>;
+  srecord ref;
+  deque_srecord rec;
+  for(address_type adr=0; adr<0x800; adr += 0x90) {
+    ref.set_range(adr, data_type(0x40, value_type(adr)));
+    rec.set_range(adr, deque_srecord::data_type(0x40, value_type(adr)));
+  }
+  ref.remove_range(0x100, 0x108);
+  rec.remove_range(0x100, 0x108);
+  test_expect( rec.compose() == ref.compose() );
+  test_expect( rec.find(deque_srecord::data_type({0x90,0x90})) == ref.find(data_type({0x90,0x90})) );
+  ref.merge(0xff);
+  rec.merge(0xff);
+  test_expect( rec.compose() == ref.compose() );
+  deque_srecord parsed;
+  test_expect( parsed.parse(ref.compose()) );
+  test_expect( parsed.dump() == ref.dump() );
+}
+
 /**
  * @req: Direct read/write access to the sparse block data shall be possible.
  */
@@ -642,17 +817,1202 @@ void test_multi_file_stream()
   }
 }
 
+/**
+ * @req: Parsing a character buffer shall report the same errors and parser lines as parsing a stream.
+ * @req: Parsing a character buffer shall stop at the next S0 header.
+ * @req: A parse failing with a line or decode error shall leave an empty record (no blocks, header or type) with the error details.
+ * @req: A parse failing with a record analysis error shall keep the parsed data.
+ */
+void test_parse_buffer()
+{
+  const string content = string(
+    "S00F000068656C6C6F212020202000003B\n"
+    "S11F00007C0802A6900100049421FFF07C6C1B787C8C23783C6000003863000026\n"
+    "\n"
+    "S11F001C4BFFFFE5398000007D83637880010014382100107C0803A64E800020E9\n"
+    "S111003848656C6C6F20776F726C642E0A0042"
+  );
+  {
+    srecord buf;
+    test_expect( buf.parse(content.data(), content.data()+content.size()) );
+    test_expect_eq( buf.parser_line(), 5u );
+    test_expect_eq( buf.eadr(), 0x46u );
+    #if(__cplusplus >= 201700L)
+    srecord view;
+    test_expect( view.parse(std::string_view(content)) );
+    test_expect( view.dump() == buf.dump() );
+    #endif
+    srecord cstr;
+    test_expect( cstr.parse(content.c_str()) );
+    test_expect( cstr.dump() == buf.dump() );
+  }
+  {
+    const string data = content + "\n" + content;
+    srecord buf;
+    test_expect( buf.parse(data) );
+    test_expect_eq( buf.parser_line(), 6u ); // Stopped at the second S0.
+    test_expect_eq( buf.eadr(), 0x46u );
+  }
+  {
+    string data = content;
+    data[data.find("0A0042")] = 'X';
+    srecord buf, str;
+    test_expect( !buf.parse(data.data(), data.data()+data.size()) );
+    stringstream ss(data);
+    test_expect( !str.parse(ss) );
+    test_expect( buf.error() == srecord::e_parse_unacceptable_character );
+    test_expect( buf.error() == str.error() );
+    test_expect_eq( buf.parser_line(), str.parser_line() );
+  }
+  {
+    // Checksum error in line 4: no partial data, header or type remain.
+    string data = content;
+    data[data.find("E9\n")] = 'F';
+    srecord buf, str;
+    test_expect( !buf.parse(data) );
+    stringstream ss(data);
+    test_expect( !str.parse(ss) );
+    for(const srecord* r: { &buf, &str }) {
+      test_expect( r->error() == srecord::e_parse_chcksum_incorrect );
+      test_expect_eq( r->parser_line(), 4u );
+      test_expect( r->blocks().empty() );
+      test_expect( r->header().empty() );
+      test_expect( r->type() == srecord::type_undefined );
+      test_expect_eq( r->size(), 0u );
+    }
+  }
+  {
+    // Analysis errors keep the parsed data.
+    const string lines = string(
+      "S00F000068656C6C6F212020202000003B\n"
+      "S11F00007C0802A6900100049421FFF07C6C1B787C8C23783C6000003863000026\n"
+      "S11F001C4BFFFFE5398000007D83637880010014382100107C0803A64E800020E9\n"
+    );
+    const struct { const char* tail; srecord::error_type error; } cases[] = {
+      { "S5030003F9\nS9030000FC\n", srecord::e_parse_line_count_mismatch },
+      { "S5030002FA\nS5030002FA\nS9030000FC\n", srecord::e_parse_duplicate_data_count },
+      { "S9030000FC\nS9030000FC\n", srecord::e_parse_duplicate_start_address },
+      { "S804000000FB\n", srecord::e_parse_startaddress_vs_data_type_mismatch },
+      { "S20500001000EA\nS9030000FC\n", srecord::e_parse_mixed_data_line_types },
+    };
+    for(const auto& c: cases) {
+      srecord rec;
+      rec.strict_parsing(true);
+      test_expect( !rec.parse(lines + c.tail) );
+      test_expect( rec.error() == c.error );
+      test_expect( !rec.header().empty() );
+      test_expect( rec.type() == srecord::type_s1_16bit );
+      test_expect_eq( rec.size(), 56u );
+    }
+  }
+}
+
+/**
+ * @req: parse() shall decode records independent of character case and embedded whitespaces.
+ * @req: parse() shall report unacceptable characters and checksum errors at any position in the line.
+ */
+void test_parse_line_kernel()
+{
+  std::mt19937 rnd(0x5eed);
+  const char* hx = "0123456789ABCDEF";
+  const auto tohex = [&](unsigned v) { string s; s += hx[(v>>4) & 0xf]; s += hx[v & 0xf]; return s; };
+  const auto mkline = [&](unsigned type, address_type adr, const data_type& data) {
+    const unsigned adr_size = type+1;
+    unsigned sum = unsigned(adr_size + data.size() + 1);
+    string line = string("S") + char('0'+type) + tohex(sum);
+    for(unsigned i=adr_size; i; --i) { line += tohex(unsigned(adr >> (8*(i-1)))); sum += unsigned(adr >> (8*(i-1))) & 0xff; }
+    for(auto b:data) { line += tohex(b); sum += b; }
+    return line + tohex((~sum) & 0xff);
+  };
+  for(int n=0; n<200; ++n) {
+    const unsigned type = 1 + unsigned(rnd() % 3);
+    const address_type adr = address_type(rnd() % 0xf000);
+    data_type data(1 + rnd() % 64);
+    for(auto& b:data) b = value_type(rnd());
+    string line = mkline(type, adr, data);
+    string mixed;
+    for(auto c:line) {
+      mixed += (rnd() & 1) ? char(::tolower(c)) : c;
+      if((rnd() % 23) == 0) mixed += ((rnd() & 1) ? ' ' : '\t');
+    }
+    {
+      srecord rec;
+      test_expect_cond_silent( rec.parse(mixed) );
+      test_expect_cond_silent( rec.blocks().size() == 1u );
+      if(rec.blocks().size() == 1) {
+        test_expect_cond_silent( rec.sadr() == adr );
+        test_expect_cond_silent( rec.blocks().front().bytes() == data );
+      }
+    }
+    {
+      string bad = line;
+      bad[2 + rnd() % (bad.size()-2)] = ((rnd() & 1) ? 'G' : '.');
+      srecord rec;
+      test_expect_cond_silent( (!rec.parse(bad)) && (rec.error() == srecord::e_parse_unacceptable_character) );
+    }
+    {
+      string bad = line;
+      char& c = bad[bad.size()-1];
+      c = (c == '0') ? '1' : '0';
+      srecord rec;
+      test_expect_cond_silent( (!rec.parse(bad)) && (rec.error() == srecord::e_parse_chcksum_incorrect) );
+    }
+  }
+  test_expect( ::sw::utest::test::num_fails() == 0 );
+}
+
+/**
+ * @req: parse_parallel() shall yield the same data, errors and parser lines as parse().
+ */
+void test_parse_parallel()
+{
+  std::mt19937 rnd(0x9a7a11e1);
+  srecord src;
+  src.type(srecord::type_s3_32bit);
+  src.header_str("parallel");
+  src.start_address_definition(0x1000);
+  for(address_type adr=0x1000; adr < 0x1000+(8u<<20); adr += 0x40000) {
+    data_type data(0x20000 + (rnd() % 0x10000));
+    for(auto& e: data) e = value_type(rnd());
+    src.set_range(adr, data);
+  }
+  const std::string composed = src.compose(0);
+  if(!test_expect_cond(composed.size() > (4u<<20))) return;
+  for(unsigned threads: { 0u, 1u, 2u, 5u }) {
+    srecord rec;
+    test_expect( rec.parse_parallel(composed, threads) );
+    test_expect( rec.parser_line() == (unsigned long)std::count(composed.begin(), composed.end(), '\n') );
+    test_expect( rec.blocks() == src.blocks() );
+    test_expect( rec.header_str() == src.header_str() );
+    test_expect( rec.start_address_definition() == src.start_address_definition() );
+  }
+  // Errors: first failing line in file order.
+  for(unsigned n=0; n<4; ++n) {
+    std::string bad = composed;
+    for(unsigned k=0; k<=n; ++k) {
+      bad[(bad.size()/8) * (7-2*k) + (rnd() % 1000)] = "x:0"[k % 3];
+    }
+    srecord seq, par;
+    const bool ok = seq.parse(bad);
+    test_expect( par.parse_parallel(bad, 4) == ok );
+    test_expect( par.error() == seq.error() );
+    test_expect( par.parser_line() == seq.parser_line() );
+    test_note( "Error: " << par.error_message() << ", line " << par.parser_line() );
+  }
+  // Out of order data records and a second S0 are handled like parse().
+  {
+    std::string unordered = composed.substr(composed.find('\n')+1, composed.size()/2);
+    unordered = composed.substr(0, composed.find('\n')+1) + composed.substr(composed.size()/2) + unordered + composed;
+    srecord seq, par;
+    const bool ok = seq.parse(unordered);
+    test_expect( par.parse_parallel(unordered, 4) == ok );
+    test_expect( par.error() == seq.error() );
+    test_expect( par.parser_line() == seq.parser_line() );
+    test_expect( par.blocks() == seq.blocks() );
+  }
+}
+
+/**
+ * @req: records() shall yield the lines of compose() one by one, with record type, address and data.
+ * @req: records() shall be empty if the record cannot be composed.
+ */
+void test_records()
+{
+  srecord rec;
+  rec.header_str("lines");
+  rec.type(srecord::type_s2_24bit);
+  rec.start_address_definition(0x100);
+  rec.set_range(0x100, data_type(70, 0x11));
+  rec.set_range(0x20000, data_type{0x01, 0x02, 0x03});
+  const string composed = rec.compose(40);
+  string joined;
+  vector<unsigned> types;
+  vector<address_type> addresses;
+  size_type data_size = 0;
+  for(const auto& line: rec.records(40)) {
+    joined.append(line.chars, line.length);
+    types.push_back(line.type);
+    addresses.push_back(line.address);
+    if((line.type >= 1) && (line.type <= 3)) data_size += line.size;
+  }
+  test_expect( joined == composed );
+  test_expect( (types == vector<unsigned>{0, 2, 2, 2, 2, 2, 2, 5, 8}) );
+  test_expect( addresses.size() == 9 && addresses[1] == 0x100 && addresses[2] == 0x10e && addresses[6] == 0x20000 );
+  test_expect( addresses[7] == 6 && addresses[8] == 0x100 );
+  test_expect_eq( data_size, 73u );
+  {
+    auto range = rec.records();
+    test_expect_eq( range.size(), 1u+4u+1u+1u );
+    auto it = range.begin();
+    const auto first = it++;
+    test_expect( first->type == 0 );
+    test_expect( first->str() == composed.substr(0, composed.find('\n')+1) );
+    test_expect( it->type == 2 && it->size == 32 && *(it->data) == 0x11 );
+  }
+  {
+    srecord empty;
+    test_expect( empty.records().empty() );
+    test_expect( empty.records().begin() == empty.records().end() );
+    test_expect( empty.error() == srecord::e_validate_no_binary_data );
+  }
+}
+
+/**
+ * @req: compose_size() shall return the exact number of characters compose() writes.
+ * @req: compose_parallel() shall yield the same output as compose(), to streams and to character buffers.
+ */
+void test_compose_parallel()
+{
+  std::mt19937 rnd(0xc0c0);
+  srecord src;
+  src.header_str("parallel compose");
+  for(address_type adr=0x0100; adr < 0x0100+(6u<<20); adr += 0x20000 + (rnd() % 0x100)) {
+    data_type data(0x10000 + (rnd() % 0x10000));
+    for(auto& e: data) e = value_type(rnd());
+    src.set_range(adr, data);
+  }
+  for(size_type line_length: { 0u, 20u, 47u, 92u }) {
+    const std::string composed = src.compose(line_length);
+    test_expect( src.compose_size(line_length) == composed.size() );
+    for(unsigned threads: { 0u, 1u, 3u }) {
+      std::stringstream ss;
+      test_expect( src.compose_parallel(ss, line_length, threads) );
+      test_expect( ss.str() == composed );
+      std::string buffer(composed.size(), '\0');
+      test_expect( src.compose_parallel(&buffer[0], &buffer[0]+buffer.size(), line_length, threads) );
+      test_expect( buffer == composed );
+    }
+  }
+  {
+    srecord rec = src;
+    std::string buffer(rec.compose_size()-1, '\0');
+    test_expect( !rec.compose_parallel(&buffer[0], &buffer[0]+buffer.size()) );
+    test_expect( rec.error() == srecord::e_compose_buffer_too_small );
+  }
+  {
+    srecord rec;
+    test_expect( rec.compose_size() == 0 );
+    test_expect( rec.error() == srecord::e_validate_no_binary_data );
+  }
+}
+
+/**
+ * @req: Range operations on ordered blocks shall yield the same results as on blocks modified via `blocks()`.
+ * @req: Modifications via a mutable `blocks()` reference shall not break later range operations.
+ * @req: The fast lookups and cached digests shall be used again after a modifying method re-checked the blocks.
+ */
+void test_block_lookup()
+{
+  std::mt19937 rnd(0x10c);
+  srecord indexed, linear;
+  for(unsigned n=0; n<4000; ++n) {
+    const address_type adr = rnd() % 0x4000;
+    const size_type size = 1 + (rnd() % 24);
+    switch(rnd() % 6) {
+      case 0: {
+        indexed.remove_range(adr, adr+size);
+        linear.blocks();
+        linear.remove_range(adr, adr+size);
+        break;
+      }
+      case 1: {
+        test_expect_cond_silent( indexed.get_range(adr, adr+size, 0xee) == linear.get_range(adr, adr+size, 0xee) );
+        test_expect_cond_silent( indexed.get_ranges(adr, adr+size) == linear.get_ranges(adr, adr+size) );
+        const data_type seq = { value_type(rnd() % 4), value_type(rnd() % 4) };
+        test_expect_cond_silent( indexed.find(seq, adr) == linear.find(seq, adr) );
+        break;
+      }
+      default: {
+        data_type data(size);
+        for(auto& e: data) e = value_type(rnd() % 4);
+        indexed.set_range(adr, data);
+        linear.blocks();
+        linear.set_range(adr, data);
+      }
+    }
+    const srecord& cindexed = indexed;
+    const srecord& clinear = linear;
+    test_expect_cond_silent( cindexed.blocks() == clinear.blocks() );
+  }
+  test_note( "Blocks: " << static_cast<const srecord&>(indexed).blocks().size() );
+  test_expect( ::sw::utest::test::num_fails() == 0 );
+  // Modifications via the mutable `blocks()` reference.
+  {
+    srecord rec;
+    rec.set_range(0x100, {1,1,1,1});
+    auto& b = rec.blocks();
+    b.push_back(srecord::block_type(0x10, {2,2,2,2}));
+    test_expect( rec.get_range(0x10, 0x11, 0xee).bytes() == data_type({2}) );
+    rec.set_range(0x12, {3,3,3,3});
+    const srecord& crec = rec;
+    if(test_expect_cond(crec.blocks().size() == 2)) {
+      test_expect( (crec.blocks()[0].sadr() == 0x10) && (crec.blocks()[0].size() == 6) );
+      test_expect( (crec.blocks()[1].sadr() == 0x100) && (crec.blocks()[1].size() == 4) );
+    }
+    test_expect( rec.get_range(0x10, 0x16, 0xee).bytes() == data_type({2,2,3,3,3,3}) );
+    test_expect( rec.get_range(0x101, 0x102, 0xee).bytes() == data_type({1}) );
+  }
+  // Re-checked after mutable `blocks()` access, digests are cached again.
+  {
+    srecord rec;
+    const srecord& crec = rec;
+    for(address_type adr=0; adr<0x1000; adr += 0x10) rec.set_range(adr, data_type(4, value_type(adr)));
+    test_expect( rec.blocks().size() == 0x100 );
+    std::uint64_t digest = 0;
+    rec.hash64(0, 0x1000);
+    test_expect( !crec.blocks().front().cached_digest(2, digest) );
+    rec.set_range(0x2000, data_type(4, 0x11));
+    const std::uint64_t hash = rec.hash64(0, 0x3000);
+    test_expect( crec.blocks().front().cached_digest(2, digest) );
+    test_expect( rec.hash64(0, 0x3000) == hash );
+    test_expect_eq( rec.size(), 0x404u );
+  }
+  // Scoped modifications via `edit_blocks()`.
+  {
+    srecord rec;
+    rec.set_range(0x100, {1,1,1,1});
+    rec.edit_blocks([](srecord::block_container_type& b) { b.insert(b.begin(), srecord::block_type(0x10, {2,2,2,2})); });
+    rec.set_range(0x12, {3,3,3,3});
+    const srecord& crec = rec;
+    test_expect( crec.blocks().size() == 2 );
+    test_expect( rec.get_range(0x10, 0x16, 0xee).bytes() == data_type({2,2,3,3,3,3}) );
+  }
+}
+
+/**
+ * @req: Batched modifications shall yield the same result as sequential set_range()/remove_range() calls (last write wins).
+ * @req: Uncommitted batched modifications shall not alter the record.
+ * @req: A moved-from transaction shall not modify any record.
+ */
+void test_transaction()
+{
+  std::mt19937 rnd(0x7a);
+  srecord direct, batched;
+  for(address_type adr=0; adr < 0x10000; adr += 0x400) {
+    direct.set_range(adr, data_type(0x100, value_type(adr >> 10)));
+  }
+  batched = direct;
+  {
+    auto tx = batched.begin_edit();
+    test_expect( tx.empty() );
+    for(unsigned n=0; n<5000; ++n) {
+      const address_type adr = rnd() % 0x10400;
+      const size_type size = 1 + (rnd() % 0x200);
+      if(rnd() % 4) {
+        data_type data(size);
+        for(auto& e: data) e = value_type(rnd());
+        direct.set_range(adr, data);
+        tx.set_range(adr, std::move(data));
+      } else {
+        direct.remove_range(adr, adr+size);
+        tx.remove_range(adr, adr+size);
+      }
+    }
+    test_expect( tx.size() == 5000 );
+    test_expect( tx.commit() );
+    test_expect( tx.empty() );
+  }
+  const srecord& cdirect = direct;
+  const srecord& cbatched = batched;
+  test_expect( cbatched.blocks() == cdirect.blocks() );
+  {
+    auto tx = batched.begin_edit();
+    tx.set_range(0, data_type(0x20000, 0xaa));
+    tx.remove_range(0, 0x10);
+  }
+  test_expect( cbatched.blocks() == cdirect.blocks() );
+  {
+    auto tx = batched.begin_edit();
+    tx.set_range(0, data_type(0x20000, 0xaa)).remove_range(0, 0x10).set_range(block_type(0x8, data_type(4, 0x55)));
+    tx.commit();
+    test_expect( cbatched.blocks().size() == 2 );
+    test_expect( cbatched.blocks().front() == block_type(0x8, data_type(4, 0x55)) );
+    test_expect( cbatched.blocks().back().sadr() == 0x10 );
+    test_expect( cbatched.blocks().back().size() == 0x20000-0x10 );
+  }
+  {
+    srecord rec;
+    auto tx = rec.begin_edit();
+    tx.set_range(0x10, data_type(4, 0x11));
+    auto moved = std::move(tx);
+    test_expect( tx.empty() );
+    tx.set_range(0x20, data_type(4, 0x22));
+    test_expect( !tx.commit() );
+    test_expect( tx.empty() );
+    auto other = rec.begin_edit();
+    other.set_range(0x30, data_type(4, 0x33));
+    other = std::move(moved);
+    test_expect( other.size() == 1 );
+    test_expect( other.commit() );
+    const srecord& crec = rec;
+    test_expect( (crec.blocks().size() == 1) && (crec.blocks().front() == block_type(0x10, data_type(4, 0x11))) );
+  }
+}
+
+/**
+ * @req: The record reader shall yield the data records of an S-record in file order, with header, type and start address.
+ * @req: The record writer shall compose the same output as `compose()` for data written in address order.
+ * @req: A streaming transform shall yield the same output as parsing, modifying and composing the record.
+ */
+void test_stream_transform()
+{
+  test_note("Streaming reader/writer/transform checks ...");
+  srecord src;
+  src.header_str("stream");
+  src.type(srecord::type_s2_24bit);
+  src.start_address_definition(0x1234);
+  src.set_range(0x0100, data_type(100, 0x11));
+  src.set_range(0x1000, data_type(300, 0x22));
+  src.set_range(0x20000, data_type(10, 0x33));
+  const string text = src.compose();
+  srecord ref(text);
+  {
+    srecord::reader_type reader(text.data(), text.data()+text.size());
+    srecord::data_record_type rec;
+    size_type n = 0, bytes = 0;
+    address_type last = 0;
+    bool ordered = true;
+    while(reader.next(rec)) {
+      ordered = ordered && (rec.address >= last);
+      last = rec.eadr();
+      bytes += rec.size;
+      ++n;
+    }
+    test_expect( reader.good() );
+    test_expect( ordered );
+    test_expect_eq( bytes, 410u );
+    test_expect_eq( n, 15u );
+    test_expect( reader.settings().type() == srecord::type_s2_24bit );
+    test_expect( reader.settings().header() == ref.header() );
+    test_expect_eq( reader.settings().start_address_definition(), 0x1234u );
+  }
+  {
+    std::stringstream ss;
+    srecord::writer_type writer(ss, src.type(), 40);
+    writer.header(src.header());
+    test_expect( writer.write(0x0100, data_type(40, 0x11).begin(), 40) );
+    test_expect( writer.write(0x0128, data_type(60, 0x11).begin(), 60) );
+    for(const auto& blk: static_cast<const srecord&>(src).blocks()) {
+      if(blk.sadr() != 0x0100) test_expect_cond( writer.write(blk.sadr(), blk.bytes().begin(), blk.size()) );
+    }
+    test_expect( writer.finish(0x1234) );
+    test_expect( ss.str() == src.compose(40) );
+    test_expect( !writer.write(0x0000, data_type(1).begin(), 1) );
+  }
+  {
+    std::stringstream ss;
+    srecord::writer_type writer(ss, srecord::type_s1_16bit);
+    test_expect( !writer.write(0xfff0, data_type(32).begin(), 32) );
+    test_expect( writer.error() == srecord::e_validate_record_type_to_small );
+  }
+  {
+    srecord::transform_type tf;
+    tf.remove(0x1010, 0x1020).offset(0x08000000).crop(0x08000100, 0x08010000).fill(0x08000000, 0x08000200, 0xff);
+    tf.type(srecord::type_s3_32bit).line_length(60);
+    srecord expected;
+    expected.header(ref.header());
+    expected.type(srecord::type_s3_32bit);
+    expected.start_address_definition(0x08001234);
+    for(const auto& blk: static_cast<const srecord&>(ref).blocks()) expected.set_range(blk.sadr()+0x08000000, blk.bytes());
+    expected.remove_range(0x08001010, 0x08001020);
+    expected.remove_range(0, 0x08000100);
+    expected.remove_range(0x08010000, 0x09000000);
+    expected.set_range(expected.get_range(0x08000000, 0x08000200, 0xff));
+    std::stringstream is(text), os;
+    srecord info;
+    test_expect( info.transform(is, os, tf) );
+    test_expect( os.str() == expected.compose(60) );
+    test_expect( info.blocks().empty() );
+    test_expect( info.type() == srecord::type_s3_32bit );
+    test_expect_eq( info.start_address_definition(), 0x08001234u );
+  }
+  {
+    srecord::transform_type tf;
+    tf.crop(0x30000, 0x40000);
+    std::stringstream is(text), os;
+    srecord info;
+    test_expect( !info.transform(is, os, tf) );
+    test_expect( info.error() == srecord::e_validate_no_binary_data );
+    test_expect( os.str().empty() );
+  }
+  {
+    std::stringstream is("S00600004844521B\nS1130000285F245F2212226A000424290008237C2A\nS5030002FA\nS9030000FC\n"), os;
+    srecord info;
+    test_expect( !info.transform(is, os, srecord::transform_type()) );
+    test_expect( info.error() == srecord::e_parse_line_count_mismatch );
+  }
+}
+
+/**
+ * Bitwise reference CRC of a reflected polynomial.
+ */
+template <typename Word>
+Word reference_crc(Word poly, const data_type& data)
+{
+  Word crc = Word(~Word(0));
+  for(auto b: data) {
+    crc ^= Word(b);
+    for(unsigned k=0; k<8; ++k) crc = (crc & 1u) ? Word((crc >> 1) ^ poly) : Word(crc >> 1);
+  }
+  return Word(~crc);
+}
+
+/**
+ * @req: crc32(), crc32c() and hash64() shall match the CRC-32, CRC-32C and CRC-64/XZ of the range data.
+ * @req: Unassigned addresses in the range shall be treated as default_value().
+ * @req: Digests shall reflect modifications of the record (cached block digests are invalidated).
+ */
+void test_range_digests()
+{
+  test_note("Range digest checks ...");
+  {
+    srecord rec;
+    const string check = "123456789";
+    rec.set_range(0x1000, data_type(check.begin(), check.end()));
+    test_expect_eq( rec.crc32(0x1000, 0x1009), 0xcbf43926u );
+    test_expect_eq( rec.crc32c(0x1000, 0x1009), 0xe3069283u );
+    test_expect( rec.hash64(0x1000, 0x1009) == 0x995dc9bbdf1939faull );
+    test_expect_eq( rec.crc32(0x1000, 0x1000), 0u );
+  }
+  std::mt19937 rnd(0xc4c32);
+  srecord rec;
+  rec.default_value(0xff);
+  for(unsigned n=0; n<40; ++n) {
+    const address_type adr = rnd() % 0x40000;
+    rec.set_range(adr, data_type(1 + (rnd() % 3000), value_type(rnd())));
+    rec.set_range(adr + 17, data_type(1 + (rnd() % 100), value_type(rnd())));
+  }
+  for(unsigned n=0; n<60; ++n) {
+    address_type sadr = rnd() % 0x42000, eadr = rnd() % 0x42000;
+    if(n == 0) { sadr = 0; eadr = 0x50000; }
+    if(sadr > eadr) std::swap(sadr, eadr);
+    const data_type data = rec.get_range(sadr, eadr, rec.default_value()).bytes();
+    test_expect_eq( rec.crc32(sadr, eadr), reference_crc<std::uint32_t>(0xedb88320u, data) );
+    test_expect_eq( rec.crc32c(sadr, eadr), reference_crc<std::uint32_t>(0x82f63b78u, data) );
+    test_expect( rec.hash64(sadr, eadr) == reference_crc<std::uint64_t>(0xc96c5795d7870f42ull, data) );
+    if(n % 3 == 0) {
+      rec.set_range(sadr + (rnd() % 0x1000), data_type(1 + (rnd() % 16), value_type(rnd())));
+    } else if(n % 3 == 1) {
+      rec.remove_range(sadr, sadr + (rnd() % 0x100));
+    }
+  }
+  {
+    test_note("Non-normalized blocks");
+    srecord unordered = rec;
+    unordered.blocks().push_back(block_type(0x100, data_type(0x80, 0x5a)));
+    const data_type data = unordered.get_range(0, 0x50000, unordered.default_value()).bytes();
+    test_expect_eq( unordered.crc32(0, 0x50000), reference_crc<std::uint32_t>(0xedb88320u, data) );
+    test_expect_eq( unordered.crc32c(0, 0x50000), reference_crc<std::uint32_t>(0x82f63b78u, data) );
+  }
+}
+
+/**
+ * @req: diff() shall return the ordered ranges where two records differ, unset memory reading as default_value().
+ * @req: diff() ranges shall be extended to the granularity and joined.
+ * @req: apply_diff() shall copy the differing ranges, so that the patched record matches the target.
+ */
+void test_diff()
+{
+  test_note("Diff checks ...");
+  typedef srecord::address_ranges_type ranges_type;
+  typedef srecord::address_range_type range_type;
+  srecord a, b;
+  a.default_value(0xff);
+  b.default_value(0xff);
+  a.set_range(0x1000, data_type(0x100, 0x11));
+  a.set_range(0x2000, data_type(0x20, 0xff));
+  b = a;
+  test_expect( srecord::diff(a, b).empty() );
+  b.set_range(0x1010, data_type(3, 0x22));
+  b.set_range(0x1013, data_type(1, 0x11));
+  b.set_range(0x1014, data_type(1, 0x22));
+  b.remove_range(0x2000, 0x2020);        // 0xff == default value, no difference
+  b.set_range(0x3000, data_type(2, 0x00));
+  test_expect( (srecord::diff(a, b) == ranges_type{ range_type{0x1010,0x1013}, range_type{0x1014,0x1015}, range_type{0x3000,0x3002} }) );
+  test_expect( (srecord::diff(a, b, 0x1000) == ranges_type{ range_type{0x1000,0x2000}, range_type{0x3000,0x4000} }) );
+  test_expect( (srecord::diff(a, b, 0x800) == ranges_type{ range_type{0x1000,0x1800}, range_type{0x3000,0x3800} }) );
+  {
+    srecord erased;
+    test_expect( (srecord::diff(erased, b) == ranges_type{ range_type{0x1000,0x3000} }) ); // gap: 0x00 != 0xff
+    erased.default_value(0xff);
+    test_expect( srecord::diff(erased, b).size() == 2 );
+  }
+  {
+    srecord patched = a;
+    patched.apply_diff(b, srecord::diff(a, b));
+    test_expect( srecord::diff(patched, b).empty() );
+    srecord patch;
+    patch.apply_diff(b, srecord::diff(a, b, 0x10));
+    test_expect( patch.blocks().size() == 2 );
+    test_expect( patch.blocks().front().sadr() == 0x1010 );
+    test_expect( patch.blocks().front().size() == 0x10 );
+    test_expect( patch.blocks().back().sadr() == 0x3000 );
+    test_expect( patch.blocks().back().size() == 2 );
+  }
+  std::mt19937 rnd(0xd1ff);
+  data_type data(0x10000);
+  for(auto& e: data) e = value_type(rnd());
+  a.clear();
+  a.set_range(0x08000000ul, data);
+  for(unsigned n=0; n<20; ++n) data[rnd() % data.size()] ^= value_type(1u << (rnd() % 8));
+  b.clear();
+  b.set_range(0x08000000ul, data);
+  a.hash64(0, 0x10000000ul);
+  b.hash64(0, 0x10000000ul);
+  const ranges_type ranges = srecord::diff(a, b);
+  test_expect( !ranges.empty() && ranges.size() <= 20 );
+  size_type changed = 0;
+  for(const auto& r: ranges) changed += size_type(r.size());
+  test_expect( changed <= 20 );
+  a.apply_diff(b, ranges);
+  test_expect( a.blocks() == static_cast<const srecord&>(b).blocks() );
+  // Data modified via a retained block data reference.
+  {
+    srecord x, y;
+    x.set_range(0x100, data_type(16, 0x11));
+    y.set_range(0x100, data_type(16, 0x11));
+    y.set_range(0x104, data_type(4, 0x22));
+    x.set_range(0x104, data_type(4, 0x22));
+    test_expect( x.hash64(0, 0x1000) == y.hash64(0, 0x1000) );
+    data_type& bytes = y.blocks().front().bytes();
+    const std::uint64_t hx = x.hash64(0, 0x1000), hy = y.hash64(0, 0x1000);
+    test_expect( hx == hy );
+    bytes[5] = 9;
+    test_expect( y.hash64(0, 0x1000) != hx );
+    test_expect( (srecord::diff(x, y) == ranges_type{ range_type{0x105,0x106} }) );
+  }
+}
+
+/**
+ * @req: The push parser shall yield the same record as parse() for arbitrarily chunked input.
+ * @req: The push parser shall stop at the next S0 and provide the remaining input for the next record.
+ * @req: The push parser shall pass data records to a callback without collecting blocks.
+ */
+void test_push_parser()
+{
+  test_note("Push parser checks ...");
+  srecord ref;
+  ref.header_str("push");
+  ref.type(srecord::type_s2_24bit);
+  ref.start_address_definition(0x1234);
+  ref.set_range(0x100, data_type(300, 0x11));
+  ref.set_range(0x8000, data_type(50, 0x22));
+  const string text = ref.compose();
+  ref.parse(text);
+  {
+    sw::srecord_parser parser;
+    bool all_consumed = true;
+    for(size_type i=0; i<text.size(); ++i) all_consumed = all_consumed && (parser.feed(&text[i], 1) == 1);
+    test_expect( all_consumed );
+    test_expect( !parser.done() );
+    test_expect( parser.finish() );
+    test_expect( parser.done() );
+    test_expect( parser.record().dump() == ref.dump() );
+    test_expect( parser.record().start_address_definition() == 0x1234 );
+  }
+  {
+    const string stream = text + "\n" + text;
+    std::istringstream is(stream);
+    srecord first, second;
+    test_expect( first.parse(is) && second.parse(is) );
+    sw::srecord_parser parser;
+    size_type pos = 0;
+    while(!parser.done()) {
+      const size_type n = std::min(size_type(7), stream.size()-pos);
+      const size_type consumed = parser.feed(&stream[pos], n);
+      pos += consumed;
+      if(consumed < n) break;
+    }
+    test_expect( parser.done() );
+    test_expect( parser.finish() );
+    test_expect( parser.record().dump() == first.dump() );
+    test_expect( parser.remainder().substr(0, 2) == "S0" );
+    sw::srecord_parser next;
+    next.feed(parser.remainder().data(), parser.remainder().size());
+    next.feed(&stream[pos], stream.size()-pos);
+    test_expect( next.finish() );
+    test_expect( next.record().dump() == second.dump() );
+  }
+  {
+    sw::srecord_parser parser;
+    size_type count = 0, bytes = 0;
+    address_type eadr = 0;
+    const auto on_data = [&](const srecord::data_record_type& rec) { ++count; bytes += rec.size; eadr = rec.eadr(); };
+    parser.feed(text.data(), text.size()-1, on_data);
+    test_expect( parser.finish(on_data) );
+    test_expect( parser.record().blocks().empty() );
+    test_expect_eq( bytes, 350u );
+    test_expect_eq( eadr, 0x8000u+50 );
+    test_expect( count > 2 );
+  }
+  {
+    sw::srecord_parser parser(true);
+    string broken = text.substr(0, text.find('\n', text.find('\n')+1)) + "\n"; // S0 and first data line
+    broken[broken.size()-2] = (broken[broken.size()-2] == '0') ? '1' : '0';
+    test_expect( parser.feed(broken.data(), broken.size()) == broken.size() );
+    test_expect( parser.done() );
+    test_expect( !parser.finish() );
+    test_expect( parser.error() == srecord::e_parse_chcksum_incorrect );
+  }
+}
+
+/**
+ * @req: statistics() shall be all zero if compiled without WITH_SRECORD_STATISTICS.
+ * @req: statistics() shall count the parsed lines by type, the decoded and emitted bytes, and the created and coalesced blocks.
+ * @req: clear() shall not reset the statistics, reset_statistics() shall.
+ */
+void test_statistics()
+{
+  srecord src;
+  src.header_str("stats");
+  src.type(srecord::type_s2_24bit);
+  src.set_range(0x100, data_type(100, 0x11));
+  src.set_range(0x1000, data_type(40, 0x22));
+  const string text = src.compose(16);
+  srecord rec;
+  test_expect( rec.parse(text) );
+  const srecord::statistics_type stats = rec.statistics();
+  #ifndef WITH_SRECORD_STATISTICS
+  test_expect( stats.lines[2] == 0 );
+  test_expect( stats.bytes_decoded == 0 );
+  test_expect( stats.timings.decode == 0 );
+  #else
+  size_type data_lines = 0;
+  for(size_type i=0; i+1<text.size(); ++i) data_lines += (text[i] == 'S' && text[i+1] == '2') ? 1 : 0;
+  test_expect_eq( stats.lines[0], 1u );
+  test_expect_eq( stats.lines[2], data_lines );
+  test_expect_eq( stats.lines[8], 1u );
+  test_expect_eq( stats.bytes_decoded, 140u );
+  test_expect_eq( stats.blocks_created, 2u );
+  test_expect_eq( stats.blocks_coalesced, data_lines-2 );
+  test_expect( stats.allocations == 2 );
+  test_expect( stats.timings.decode > 0 );
+  test_expect_eq( src.statistics().bytes_emitted, text.size() );
+  rec.clear();
+  test_expect_eq( rec.statistics().bytes_decoded, 140u );
+  rec.reset_statistics();
+  test_expect_eq( rec.statistics().bytes_decoded, 0u );
+  test_expect( rec.parse_parallel(text, 2) );
+  test_expect_eq( rec.statistics().lines[2], data_lines );
+  test_expect_eq( rec.statistics().bytes_decoded, 140u );
+  test_expect_eq( rec.statistics().blocks_created, 2u );
+  rec.reset_statistics();
+  rec.set_range(0x164, data_type(0x1000-0x164, 0x33));
+  test_expect_eq( rec.statistics().blocks_coalesced, 2u );
+  rec.set_range(0x4000, data_type(4, 0x44));
+  test_expect_eq( rec.statistics().blocks_created, 1u );
+  rec.merge();
+  test_expect_eq( rec.statistics().blocks_coalesced, 2u+1u );
+  test_expect( rec.statistics().timings.set_range > 0 );
+  #endif
+}
+
+/**
+ * @req: dump() shall show the blocks as hex lines aligned to 16 bytes, with indented addresses.
+ * @req: dump() for address ranges shall clip the blocks, and optionally show an ASCII column.
+ */
+void test_dump()
+{
+  srecord rec;
+  rec.type(srecord::type_s1_16bit);
+  rec.set_range(0x1003, data_type{0x41, 0x42, 0x00, 0x7f, 0x7a});
+  rec.set_range(0x2000, data_type(18, 0x30));
+  test_expect_eq( rec.dump(), string(
+    "srec {\n data type: S1\n blocks: [\n"
+    "    <00001000>        41 4200 7F7A \n\n"
+    "    <00002000> 3030 3030 3030 3030 3030 3030 3030 3030 \n"
+    "    <00002010> 3030 \n\n"
+    " ]\n}\n"
+  ));
+  {
+    std::ostringstream os;
+    rec.dump(os, 0x1004, 0x1007, 8, 2, true);
+    test_expect_eq( os.str(), string(
+      "srec {\n data type: S1\n blocks: [\n"
+      "  <00001000>           4200 7F   |    B.. |\n\n"
+      " ]\n}\n"
+    ));
+  }
+  {
+    std::ostringstream os;
+    rec.dump(os, 0x1010, 0x2004);
+    test_expect_eq( os.str(), string("srec {\n data type: S1\n blocks: [\n    <00002000> 3030 3030 \n\n ]\n}\n") );
+  }
+  {
+    std::ostringstream os;
+    rec.dump(os, 0x3000, 0x4000);
+    test_expect_eq( os.str(), string("srec {\n data type: S1\n blocks: [\n ]\n}\n") );
+  }
+}
+
+/**
+ * @req: size() shall return the total number of data bytes after any modification.
+ * @req: validate() of normalized records shall determine the same record type as a full scan.
+ */
+void test_cached_size()
+{
+  std::mt19937 rnd(0x512e);
+  srecord rec;
+  const srecord& crec = rec;
+  const auto count = [](const srecord& r) { size_type n = 0; for(const auto& e: r.blocks()) n += e.size(); return n; };
+  test_expect( rec.size() == 0 );
+  bool all_equal = true;
+  for(unsigned n=0; n<3000; ++n) {
+    const address_type adr = address_type(rnd() % 0x20000);
+    const size_type size = 1 + (rnd() % 300);
+    switch(rnd() % 8) {
+      case 0: rec.remove_range(adr, adr+size); break;
+      case 1: if(crec.blocks().size() > 8) rec.merge(); break;
+      case 2: if(!crec.blocks().empty()) rec.blocks().back().bytes().push_back(0x11); break;
+      case 3: rec.size(); break;
+      default: rec.set_range(adr, data_type(size, value_type(n)));
+    }
+    all_equal = all_equal && (rec.size() == count(rec));
+  }
+  test_expect( all_equal );
+  rec.clear();
+  test_expect( rec.size() == 0 );
+  test_expect( rec.parse(string("S00600004844521B\nS1130000285F245F2212226A000424290008237C2A\nS9030000FC\n")) );
+  test_expect_eq( rec.size(), 16u );
+  rec.set_range(0x1234567, data_type(2, 0));
+  test_expect_eq( rec.size(), 18u );
+  rec.type(srecord::type_undefined);
+  test_expect( rec.validate(false) );
+  test_expect( rec.type() == srecord::type_s3_32bit );
+  // Size after modifications via the mutable `blocks()` reference.
+  {
+    srecord exposed;
+    exposed.set_range(0x100, {1,1,1,1});
+    test_expect_eq( exposed.size(), 4u );
+    auto& b = exposed.blocks();
+    b.push_back(srecord::block_type(0x200, {2,2,2,2}));
+    test_expect_eq( exposed.size(), 8u );
+    b.back().bytes().push_back(2);
+    test_expect_eq( exposed.size(), 9u );
+    exposed.set_range(0x300, {3,3});
+    test_expect_eq( exposed.size(), 11u );
+    exposed.blocks().back().bytes().push_back(3);
+    test_expect_eq( exposed.size(), 12u );
+    exposed.remove_range(0x100, 0x102);
+    test_expect_eq( exposed.size(), 10u );
+  }
+}
+
+/**
+ * @req: A frozen image shall return the same data, ranges and search results as the record it was made of.
+ * @req: A frozen image shall be readable from several threads concurrently.
+ */
+void test_frozen()
+{
+  std::mt19937 rnd(0xf502);
+  srecord rec;
+  rec.header_str("frozen");
+  rec.default_value(0xff);
+  for(unsigned n=0; n<300; ++n) {
+    data_type data(1 + (rnd() % 200));
+    for(auto& e: data) e = value_type(rnd() % 4);
+    rec.set_range(address_type(rnd() % 0x20000), data);
+  }
+  rec.blocks().push_back(block_type(0x30000, data_type{0x01, 0x02}));
+  rec.blocks().push_back(block_type(0x30002, data_type{0x03}));
+  const srecord& crec = rec;
+  const auto frozen = rec.freeze();
+  test_expect( frozen->settings().header_str() == "frozen" );
+  test_expect( frozen->settings().blocks().empty() );
+  test_expect( frozen->size() == rec.size() );
+  test_expect( frozen->block_count() == crec.blocks().size()-1 );
+  test_expect( frozen->sadr() == crec.blocks().front().sadr() );
+  test_expect( frozen->eadr() == 0x30003 );
+  test_expect( frozen->get_range(0x2fff0, 0x30010).bytes() == rec.get_range(0x2fff0, 0x30010, 0xff).bytes() );
+  test_expect( frozen->record().blocks().back().bytes() == data_type({0x01, 0x02, 0x03}) );
+  rec.merge();
+  test_expect( rec.blocks().size() == 1 );
+  rec = srecord();
+  // Random lookups from several threads (the record data is gone).
+  srecord ref = frozen->record();
+  const srecord& cref = ref;
+  std::atomic<unsigned> mismatches(0);
+  std::vector<std::thread> threads;
+  for(unsigned t=0; t<4; ++t) {
+    threads.emplace_back([&, t]() {
+      std::mt19937 trnd(t);
+      for(unsigned n=0; n<2000; ++n) {
+        const address_type adr = address_type(trnd() % 0x20100);
+        const address_type eadr = adr + (trnd() % 300);
+        bool ok = (frozen->get(adr) == ref.get_range(adr, adr+1, 0xff).bytes()[0]);
+        ok = ok && (frozen->assigned(adr) == (frozen->data(adr) != nullptr));
+        ok = ok && (frozen->get_range(adr, eadr).bytes() == ref.get_range(adr, eadr, 0xff).bytes());
+        const data_type pattern = { value_type(trnd() % 4), value_type(trnd() % 4), value_type(trnd() % 4), value_type(trnd() % 4) };
+        ok = ok && (frozen->find(pattern, adr) == cref.find(pattern, adr));
+        #if(__cplusplus >= 201700L)
+        ok = ok && (frozen->get<uint32_t>(adr, srecord::endianess_type::big_endian) == cref.get<uint32_t>(adr, srecord::endianess_type::big_endian));
+        ok = ok && (frozen->get_array<uint16_t>(adr, 3, srecord::endianess_type::little_endian) == cref.get_array<uint16_t>(adr, 3, srecord::endianess_type::little_endian));
+        #endif
+        if(!ok) ++mismatches;
+      }
+    });
+  }
+  for(auto& e: threads) e.join();
+  test_expect_eq( mismatches.load(), 0u );
+  test_expect( cref.blocks().size() == frozen->block_count() );
+  const auto empty = srecord().freeze();
+  test_expect( empty->empty() && (empty->eadr() == 0) && (!empty->assigned(0)) && (empty->get(0) == 0) );
+  test_expect( empty->find(data_type{0x00}) == 0 );
+}
+
+#if(__cplusplus >= 201700L)
+/**
+ * @req: get_array<>() shall return the same values as consecutive get<>() calls, or nothing if the range has gaps.
+ * @req: set_array<>() shall write the same bytes as consecutive set<>() calls, for integral and floating point types.
+ */
+void test_array_access()
+{
+  using endianess = srecord::endianess_type;
+  std::mt19937 rnd(0xa77a);
+  srecord rec, ref;
+  const srecord& crec = rec;
+  const vector<uint16_t> u16 = { 0x0102, 0xa1b2, 0xffee, 0x0000, 0x8001 };
+  vector<uint32_t> u32(1000);
+  for(auto& e: u32) e = uint32_t(rnd());
+  rec.set_array(0x100, u16, endianess::big_endian);
+  for(size_type i=0; i<u16.size(); ++i) ref.set<uint16_t>(0x100+2*i, endianess::big_endian, u16[i]);
+  rec.set_array(0x1000, u32.data(), u32.size(), endianess::little_endian);
+  for(size_type i=0; i<u32.size(); ++i) ref.set<uint32_t>(0x1000+4*i, endianess::little_endian, u32[i]);
+  test_expect( crec.blocks() == static_cast<const srecord&>(ref).blocks() );
+  test_expect( rec.get_array<uint16_t>(0x100, u16.size(), endianess::big_endian).value_or(vector<uint16_t>()) == u16 );
+  test_expect( rec.get_array<uint32_t>(0x1000, u32.size(), endianess::little_endian).value_or(vector<uint32_t>()) == u32 );
+  {
+    const auto be = rec.get_array<uint32_t>(0x1004, 3, endianess::big_endian).value_or(vector<uint32_t>());
+    test_expect( be.size() == 3 );
+    bool all_equal = (be.size() == 3);
+    for(size_type i=0; i<be.size(); ++i) all_equal = all_equal && (be[i] == rec.get<uint32_t>(0x1004+4*i, endianess::big_endian).value_or(0));
+    test_expect( all_equal );
+  }
+  test_expect( !rec.get_array<uint16_t>(0x100, u16.size()+1, endianess::big_endian).has_value() );
+  test_expect( !rec.get_array<uint32_t>(0x0ffe, 2, endianess::big_endian).has_value() );
+  test_expect( rec.get_array<uint16_t>(0x100, 0, endianess::big_endian).has_value() );
+  // In place overwrite of an existing block, floating point round trip.
+  const vector<double> f64 = { 1.0, -2.5, 3.14159, 1e300, -0.0 };
+  const vector<float> f32 = { 0.5f, -1e-20f, 65504.0f };
+  const size_type blocks = crec.blocks().size();
+  rec.set_array(0x1010, f64, endianess::big_endian);
+  rec.set_array(0x1100, f32, endianess::little_endian);
+  test_expect( crec.blocks().size() == blocks );
+  test_expect( rec.get_array<double>(0x1010, f64.size(), endianess::big_endian).value_or(vector<double>()) == f64 );
+  test_expect( rec.get_array<float>(0x1100, f32.size(), endianess::little_endian).value_or(vector<float>()) == f32 );
+  test_expect_eq( rec.get<uint64_t>(0x1010, endianess::big_endian).value_or(0), 0x3ff0000000000000ull );
+  test_expect_eq( int(rec.get<uint8_t>(0x1103, endianess::big_endian).value_or(0)), 0x3f );
+  // Unnormalized records and ranges spanning several blocks.
+  rec.blocks().push_back(block_type(0x20, data_type{0x01, 0x02, 0x03}));
+  rec.blocks().push_back(block_type(0x23, data_type{0x04, 0x05}));
+  const auto spanned = rec.get_array<uint16_t>(0x21, 2, endianess::little_endian);
+  test_expect( spanned.has_value() && ((*spanned) == vector<uint16_t>({0x0302, 0x0504})) );
+  rec.set_array(0x22, vector<int16_t>({-2}), endianess::big_endian);
+  test_expect( rec.get_range(0x20, 0x25).bytes() == data_type({0x01, 0x02, 0xff, 0xfe, 0x05}) );
+}
+#endif
+
+/**
+ * @req: parse_ihex() shall decode data, extended segment/linear address and start address records.
+ * @req: compose_ihex() shall compose Intel HEX, which parse_ihex() restores to the same blocks and start address.
+ * @req: parse_ihex() shall reject unacceptable characters, checksum errors and, when strict, a missing end of file record.
+ * @req: parse_ihex() shall wrap data offsets after an extended segment address within the 64KiB segment.
+ * @req: A failed parse_ihex() shall leave an empty record with the error details.
+ * @req: compose_ihex() shall only check the 32 bit address range, not the S-record type.
+ */
+void test_ihex()
+{
+  const string text =
+    ":10010000214601360121470136007EFE09D2190140\n"
+    ":100110002146017E17C20001FF5F16002148011928\n"
+    ":10012000194E79234623965778239EDA3F01B2CAA7\n"
+    ":100130003F0156702B5E712B722B732146013421C7\n"
+    ":00000001FF\n";
+  srecord rec;
+  test_expect( rec.parse_ihex(text) );
+  test_expect( rec.blocks().size() == 1 );
+  test_expect( rec.blocks().front().sadr() == 0x100 );
+  test_expect( rec.blocks().front().size() == 64 );
+  test_expect( rec.type() == srecord::type_s1_16bit );
+  test_expect_eq( rec.compose_ihex(), text );
+  {
+    srecord seg;
+    test_expect( seg.parse_ihex(string(":020000021000EC\r\n:0100000055AA\r\n:0400000312345678E5\r\n:00000001FF\r\n")) );
+    test_expect( seg.blocks().size() == 1 );
+    test_expect( seg.blocks().front().sadr() == 0x10000 );
+    test_expect( seg.blocks().front().bytes() == data_type({0x55}) );
+    test_expect( seg.start_address_definition() == 0x179b8 );
+    test_expect( seg.type() == srecord::type_s2_24bit );
+    // Offsets wrap within the 64KiB segment.
+    test_expect( seg.parse_ihex(string(":020000021000EC\n:04FFFE001122334455\n:00000001FF\n")) );
+    const srecord& cseg = seg;
+    if(test_expect_cond(cseg.blocks().size() == 2)) {
+      test_expect( cseg.blocks().front() == block_type(0x10000, data_type({0x33,0x44})) );
+      test_expect( cseg.blocks().back() == block_type(0x1fffe, data_type({0x11,0x22})) );
+    }
+  }
+  {
+    std::mt19937 rnd(0x1e8);
+    srecord src;
+    src.start_address_definition(0x08000101ul);
+    data_type data(5000);
+    for(auto& e: data) e = value_type(rnd());
+    src.set_range(0x0800fff0ul, data);
+    src.set_range(0x20000000ul, data_type(data.begin(), data.begin()+33));
+    src.set_range(0x0010, data_type(data.begin(), data.begin()+7));
+    for(size_type line_length: { size_type(0), size_type(20), size_type(75), size_type(600) }) {
+      const string ihex = src.compose_ihex(line_length);
+      srecord dst;
+      test_expect( dst.parse_ihex(ihex) );
+      test_expect( static_cast<const srecord&>(dst).blocks() == static_cast<const srecord&>(src).blocks() );
+      test_expect( dst.start_address_definition() == 0x08000101ul );
+      test_expect( dst.type() == srecord::type_s3_32bit );
+      test_expect( dst.compose() == src.compose() );
+    }
+    srecord small = src;
+    small.type(srecord::type_s1_16bit);
+    test_expect( small.compose_ihex() == src.compose_ihex() );
+    test_expect( small.good() );
+    test_expect( small.type() == srecord::type_s1_16bit );
+    const string ihex = src.compose_ihex();
+    test_expect( ihex.find(":020000040800F2\n") != string::npos );
+    test_expect( ihex.find(":020000040801F1\n") != string::npos );
+    test_expect( ihex.find(":0400000508000101ED\n") != string::npos );
+  }
+  {
+    srecord bad;
+    test_expect( !bad.parse_ihex(string(":0100000055AB\n:00000001FF\n")) );
+    test_expect( bad.error() == srecord::e_parse_chcksum_incorrect );
+    test_expect( !bad.parse_ihex(string("S0100000055AA\n")) );
+    test_expect( bad.error() == srecord::e_parse_line_not_starting_with_colon );
+    test_expect( !bad.parse_ihex(string(":01000000S5AA\n")) );
+    test_expect( bad.error() == srecord::e_parse_unacceptable_character );
+    test_expect( !bad.parse_ihex(string(":0200000055A9\n")) );
+    test_expect( bad.error() == srecord::e_parse_length_mismatch );
+    test_expect( !bad.parse_ihex(string(":0100000655A4\n")) );
+    test_expect( bad.error() == srecord::e_parse_invalid_record_type );
+    test_expect( bad.parse_ihex(string(":0100000055AA\n")) );
+    bad.strict_parsing(true);
+    test_expect( !bad.parse_ihex(string(":0100000055AA\n")) );
+    test_expect( bad.error() == srecord::e_parse_missing_eof );
+    test_expect( bad.parse_ihex(string(":0100000055AA\n:00000001FF\n")) );
+    // Errors leave no partial data or start address.
+    test_expect( !bad.parse_ihex(string(":0400000312345678E5\n:0100000055AA\n:0100000655A4\n")) );
+    test_expect( bad.error() == srecord::e_parse_invalid_record_type );
+    test_expect_eq( bad.parser_line(), 3u );
+    test_expect( static_cast<const srecord&>(bad).blocks().empty() );
+    test_expect_eq( bad.start_address_definition(), 0u );
+    test_expect( bad.type() == srecord::type_undefined );
+    test_expect_eq( bad.size(), 0u );
+  }
+}
+
+#ifdef SRECORD_WITH_PMR
+/**
+ * Memory resource counting allocations.
+ */
+struct counting_resource : std::pmr::memory_resource
+{
+  size_type allocations = 0;
+  void* do_allocate(size_t bytes, size_t alignment) override { ++allocations; return std::pmr::new_delete_resource()->allocate(bytes, alignment); }
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override { std::pmr::new_delete_resource()->deallocate(p, bytes, alignment); }
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
+/**
+ * @req: A record with polymorphic allocator shall allocate its blocks from the memory resource of the instance.
+ * @req: Parsing, modifying and composing a pmr record shall yield the same results as the default record.
+ * @req: Committed edit data of a different memory resource shall be copied into the resource of the record.
+ */
+void test_pmr_allocator()
+{
+  test_note("PMR allocator checks ...");
+  srecord ref;
+  ref.header_str("pmr");
+  ref.type(srecord::type_s2_24bit);
+  for(unsigned i=0; i<50; ++i) ref.set_range(i*300, data_type(100+i, value_type(i)));
+  const string text = ref.compose();
+  ref.parse(text);
+  counting_resource default_resource, upstream;
+  std::pmr::memory_resource* previous = std::pmr::set_default_resource(&default_resource);
+  {
+    std::pmr::monotonic_buffer_resource arena(&upstream);
+    sw::pmr::srecord rec(&arena);
+    test_expect( rec.parse(text) );
+    rec.set_range(5, std::pmr::vector<unsigned char>(10, 3, &arena));
+    ref.set_range(5, data_type(10, 3));
+    rec.remove_range(1000, 1010);
+    ref.remove_range(1000, 1010);
+    {
+      const std::pmr::vector<unsigned char> patch(8, 7, &arena);
+      auto tx = rec.begin_edit();
+      const sw::pmr::srecord::block_type block(2100, patch, &arena);
+      tx.set_range(2000, patch).set_range(block);
+      test_expect( tx.commit() );
+      ref.set_range(2000, data_type(8, 7));
+      ref.set_range(2100, data_type(8, 7));
+    }
+    {
+      // Edit data of a foreign resource is copied into the record resource.
+      std::pmr::monotonic_buffer_resource foreign(&upstream);
+      auto tx = rec.begin_edit();
+      tx.set_range(0x10000, std::pmr::vector<unsigned char>(9, 6, &foreign));
+      test_expect( tx.commit() );
+      ref.set_range(0x10000, data_type(9, 6));
+      const sw::pmr::srecord& crec = rec;
+      for(const auto& block: crec.blocks()) test_expect_silent( block.bytes().get_allocator().resource() == &arena );
+    }
+    test_expect( rec.get_range(0, 400).bytes().get_allocator().resource() == &arena );
+    rec.merge(0xff);
+    ref.merge(0xff);
+    std::stringstream ss;
+    test_expect( rec.compose(ss) );
+    test_expect( ss.str() == ref.compose() );
+    test_expect( rec.blocks().front().bytes().get_allocator().resource() == &arena );
+  }
+  std::pmr::set_default_resource(previous);
+  test_expect_eq( default_resource.allocations, 0u );
+  test_expect( upstream.allocations > 0 );
+}
+#endif
+
 void test(const vector<string>& args)
 {
   (void)args;
   test_expect_noexcept( test_parse_example_s19() );
   test_expect_noexcept( test_compose() );
+  test_expect_noexcept( test_compose_format() );
+  test_expect_noexcept( test_compose_parallel() );
   test_expect_noexcept( test_range_get() );
   test_expect_noexcept( test_range_get_set() );
+  test_expect_noexcept( test_range_view() );
   test_expect_noexcept( test_merge() );
   test_expect_noexcept( test_remove() );
   test_expect_noexcept( test_find() );
+  test_expect_noexcept( test_find_all() );
+  test_expect_noexcept( test_block_lookup() );
+  test_expect_noexcept( test_transaction() );
+  test_expect_noexcept( test_stream_transform() );
+  test_expect_noexcept( test_range_digests() );
+  test_expect_noexcept( test_diff() );
+  test_expect_noexcept( test_push_parser() );
+  test_expect_noexcept( test_statistics() );
+  test_expect_noexcept( test_dump() );
+  test_expect_noexcept( test_cached_size() );
+  test_expect_noexcept( test_records() );
+  test_expect_noexcept( test_ihex() );
+  test_expect_noexcept( test_frozen() );
+  #if(__cplusplus >= 201700L)
+  test_expect_noexcept( test_array_access() );
+  #endif
+  #ifdef SRECORD_WITH_PMR
+  test_expect_noexcept( test_pmr_allocator() );
+  #endif
   test_expect_noexcept( test_block_data_access() );
+  test_expect_noexcept( test_deque_container() );
   test_expect_noexcept( test_strict_parsing() );
   test_expect_noexcept( test_multi_file_stream() );
+  test_expect_noexcept( test_parse_buffer() );
+  test_expect_noexcept( test_parse_line_kernel() );
+  test_expect_noexcept( test_parse_parallel() );
 }
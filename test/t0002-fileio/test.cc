@@ -12,6 +12,8 @@
 #include <fstream>
 #include <string>
 #include <sstream>
+#include <cstdio>
+#include <stdexcept>
 
 #ifndef RESOURCE_DIRECTORY
 #define RESOURCE_DIRECTORY "res/"
@@ -28,6 +30,35 @@ using sw::srecord;
 
 srecord srec;
 
+/**
+ * Allocator that fails for block data allocations.
+ */
+template <typename T>
+struct failing_allocator
+{
+  using value_type = T;
+
+  failing_allocator() noexcept = default;
+
+  template <typename U>
+  failing_allocator(const failing_allocator<U>&) noexcept
+  {}
+
+  T* allocate(size_t)
+  { throw std::bad_alloc(); }
+
+  void deallocate(T* p, size_t) noexcept
+  { ::operator delete(p); }
+
+  template <typename U>
+  bool operator==(const failing_allocator<U>&) const noexcept
+  { return true; }
+
+  template <typename U>
+  bool operator!=(const failing_allocator<U>&) const noexcept
+  { return false; }
+};
+
 void test_load_file()
 {
   {
@@ -48,9 +79,212 @@ void test_load_file()
   }
 }
 
+/**
+ * @req: load_mapped() shall yield the same result as load().
+ * @req: load_parallel() shall yield the same result as load().
+ * @req: Parsing a contiguous buffer shall yield the same result as parsing a stream.
+ */
+void test_load_mapped_file()
+{
+  const char* files[] = { RESOURCE_DIRECTORY "test0.s19", RESOURCE_DIRECTORY "test1.s19", RESOURCE_DIRECTORY "test2.s19" };
+  for(auto file: files) {
+    test_note("File: " << file);
+    srecord loaded, mapped;
+    const bool ok = srecord::load(file, loaded);
+    test_expect( srecord::load_mapped(file, mapped) == ok );
+    test_expect( mapped.error() == loaded.error() );
+    test_expect( mapped.parser_line() == loaded.parser_line() );
+    test_expect( mapped.error_address() == loaded.error_address() );
+    test_expect( mapped.dump() == loaded.dump() );
+    {
+      ifstream fs(file);
+      srecord streamed;
+      test_expect( streamed.parse(fs, true) == ok );
+      test_expect( streamed.error() == loaded.error() );
+      test_expect( streamed.parser_line() == loaded.parser_line() );
+      test_expect( streamed.dump() == loaded.dump() );
+    }
+    {
+      srecord raii = srecord::load_mapped(string(file));
+      test_expect( raii.error() == loaded.error() );
+      test_expect( raii.dump() == loaded.dump() );
+    }
+    {
+      srecord parallel;
+      test_expect( srecord::load_parallel(file, parallel, 4) == ok );
+      test_expect( parallel.error() == loaded.error() );
+      test_expect( parallel.parser_line() == loaded.parser_line() );
+      test_expect( parallel.dump() == loaded.dump() );
+    }
+  }
+  {
+    srecord raii_fail = srecord::load_mapped(RESOURCE_DIRECTORY TEST_FILE ".nonexisting");
+    test_expect( raii_fail.blocks().empty() );
+    test_expect( raii_fail.error() == srecord::e_load_open_failed );
+    test_expect( !srecord::load_mapped(RESOURCE_DIRECTORY TEST_FILE ".nonexisting", srec) );
+  }
+}
+
+/**
+ * @req: A record loaded from a snapshot shall be identical to the record the snapshot was saved from.
+ * @req: Invalid or truncated snapshot files shall be rejected with e_snapshot_invalid.
+ * @req: snapshot_matches() shall detect whether a snapshot was saved from the current source file content.
+ */
+void test_snapshot()
+{
+  const string snapshot_file = "snapshot.tmp";
+  const char* files[] = { RESOURCE_DIRECTORY "test0.s19", RESOURCE_DIRECTORY "test1.s19", RESOURCE_DIRECTORY "test2.s19" };
+  for(auto file: files) {
+    test_note("File: " << file);
+    srecord loaded;
+    if(!srecord::load(file, loaded)) continue;
+    loaded.default_value(0xa5);
+    std::uint64_t hash = 0;
+    test_expect( srecord::source_hash(file, hash) );
+    test_expect( loaded.save_snapshot(snapshot_file, hash) );
+    test_expect( srecord::snapshot_matches(snapshot_file, file) );
+    srecord restored;
+    test_expect( srecord::load_snapshot(snapshot_file, restored) );
+    test_expect( restored.good() );
+    test_expect( restored.header() == loaded.header() );
+    test_expect( restored.type() == loaded.type() );
+    test_expect( restored.start_address_definition() == loaded.start_address_definition() );
+    test_expect( restored.default_value() == loaded.default_value() );
+    test_expect( restored.dump() == loaded.dump() );
+    test_expect( restored.compose() == loaded.compose() );
+  }
+  {
+    srecord rec;
+    rec.set_range(0x100, srecord::data_type(100, 0x11));
+    rec.set_range(0x1000, srecord::data_type(3, 0x22));
+    test_expect( rec.save_snapshot(snapshot_file) );
+    test_expect( !srecord::snapshot_matches(snapshot_file, RESOURCE_DIRECTORY TEST_FILE) );
+    const srecord raii = srecord::load_snapshot(snapshot_file);
+    test_expect( raii.good() );
+    test_expect( raii.blocks() == rec.blocks() );
+    string data;
+    {
+      ifstream fs(snapshot_file, ios::in|ios::binary);
+      data.assign(istreambuf_iterator<char>(fs), istreambuf_iterator<char>());
+    }
+    {
+      ofstream fs(snapshot_file, ios::out|ios::binary|ios::trunc);
+      fs.write(data.data(), streamsize(data.size()-1));
+    }
+    srecord truncated;
+    test_expect( !srecord::load_snapshot(snapshot_file, truncated) );
+    test_expect( truncated.error() == srecord::e_snapshot_invalid );
+    test_expect( truncated.blocks().empty() );
+    {
+      ofstream fs(snapshot_file, ios::out|ios::binary|ios::trunc);
+      fs << "S00600004844521B\n";
+    }
+    test_expect( srecord::load_snapshot(snapshot_file).error() == srecord::e_snapshot_invalid );
+  }
+  std::remove(snapshot_file.c_str());
+  test_expect( srecord::load_snapshot(snapshot_file).error() == srecord::e_load_open_failed );
+}
+
+/**
+ * @req: load_many() shall yield one record per path in path order, each identical to load_mapped().
+ * @req: load_many() shall call the completion callback once per file with the loaded record.
+ * @req: load_many() shall set an error for files whose loading throws, and rethrow exceptions of the callback after loading all files.
+ */
+void test_load_many()
+{
+  const vector<string> files = {
+    RESOURCE_DIRECTORY "test2.s19", RESOURCE_DIRECTORY TEST_FILE ".nonexisting", RESOURCE_DIRECTORY "test0.s19",
+    RESOURCE_DIRECTORY "test1.s19", RESOURCE_DIRECTORY "test0.s19"
+  };
+  for(unsigned threads: { 0u, 1u, 3u }) {
+    vector<int> loaded(files.size(), 0);
+    vector<string> dumps(files.size());
+    const vector<srecord> records = srecord::load_many(files, threads, [&](size_t index, const srecord& rec) {
+      ++loaded[index];
+      dumps[index] = rec.dump();
+    });
+    if(!test_expect_cond( records.size() == files.size() )) continue;
+    for(size_t i=0; i<files.size(); ++i) {
+      const srecord expected = srecord::load_mapped(files[i]);
+      test_expect( loaded[i] == 1 );
+      test_expect( records[i].error() == expected.error() );
+      test_expect( records[i].parser_line() == expected.parser_line() );
+      test_expect( records[i].dump() == expected.dump() );
+      test_expect( dumps[i] == expected.dump() );
+    }
+    test_expect( records[1].error() == srecord::e_load_open_failed );
+  }
+  test_expect( srecord::load_many(vector<string>()).empty() );
+  {
+    // Exceptions while loading set an error, callback exceptions are rethrown.
+    using failing_srecord = sw::detail::basic_srecord<unsigned char, std::vector<unsigned char, failing_allocator<unsigned char>>>;
+    vector<int> loaded(files.size(), 0);
+    const vector<failing_srecord> records = failing_srecord::load_many(files, 3, [&](size_t index, const failing_srecord&) { ++loaded[index]; });
+    if(test_expect_cond( records.size() == files.size() )) {
+      test_expect( records[0].error() == failing_srecord::e_load_failed );
+      test_expect( records[1].error() == failing_srecord::e_load_open_failed );
+      test_expect( records[0].blocks().empty() && !records[0].good() );
+    }
+    test_expect( loaded == vector<int>(files.size(), 1) );
+    bool rethrown = false;
+    loaded.assign(files.size(), 0);
+    try {
+      srecord::load_many(files, 3, [&](size_t index, const srecord&) { ++loaded[index]; if(index == 2) throw std::runtime_error("callback"); });
+    } catch(const std::runtime_error&) {
+      rethrown = true;
+    }
+    test_expect( rethrown );
+    test_expect( loaded == vector<int>(files.size(), 1) );
+  }
+}
+
+/**
+ * @req: save_binary() shall write the address range with unassigned bytes as default value.
+ * @req: load_binary() shall load a binary file as one block at the given base address.
+ */
+void test_binary_files()
+{
+  const string binary_file = "binary.tmp";
+  srecord rec;
+  rec.default_value(0xee);
+  rec.set_range(0x1000, srecord::data_type{0x01, 0x02, 0x03});
+  rec.set_range(0x1010, srecord::data_type(5000, 0x44));
+  test_expect( rec.save_binary(binary_file) );
+  {
+    srecord loaded;
+    test_expect( srecord::load_binary(binary_file, loaded, 0x1000) );
+    test_expect( loaded.blocks().size() == 1 );
+    test_expect( loaded.size() == 0x10+5000 );
+    test_expect( loaded.get_range(0x1000, 0x1010+5000).bytes() == rec.get_range(0x1000, 0x1010+5000).bytes() );
+    test_expect( loaded.type() == srecord::type_s1_16bit );
+  }
+  test_expect( rec.save_binary(binary_file, 0x0ffe, 0x1005) );
+  {
+    const srecord loaded = srecord::load_binary(binary_file, 0x08000000ul);
+    test_expect( loaded.good() );
+    test_expect( loaded.blocks().front().sadr() == 0x08000000ul );
+    test_expect( loaded.blocks().front().bytes() == srecord::data_type({0xee, 0xee, 0x01, 0x02, 0x03, 0xee, 0xee}) );
+    test_expect( loaded.type() == srecord::type_s3_32bit );
+  }
+  test_expect( srecord::load_binary(binary_file, 0xfffffffcul).error() == srecord::e_validate_record_range_exceeded );
+  test_expect( rec.save_binary(binary_file, 0x10, 0x10) );
+  {
+    srecord loaded;
+    test_expect( srecord::load_binary(binary_file, loaded) );
+    test_expect( loaded.blocks().empty() );
+  }
+  std::remove(binary_file.c_str());
+  test_expect( srecord::load_binary(binary_file).error() == srecord::e_load_open_failed );
+  test_expect( !rec.save_binary(string()) );
+  test_expect( rec.error() == srecord::e_binary_write_failed );
+}
 
 void test(const vector<string>& args)
 {
   (void)args;
   test_expect_noexcept( test_load_file() );
+  test_expect_noexcept( test_load_mapped_file() );
+  test_expect_noexcept( test_snapshot() );
+  test_expect_noexcept( test_load_many() );
+  test_expect_noexcept( test_binary_files() );
 }
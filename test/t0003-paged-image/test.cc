@@ -0,0 +1,187 @@
+/**
+ * @file test.cc
+ * @package de.atwillys.cc.swl
+ * @license BSD (simplified)
+ * @author Stefan Wilhelm (stfwi)
+ * -----------------------------------------------------------------------------
+ */
+#include "testenv.hh"
+#include <sw/srecord.hh>
+#include <iostream>
+#include <string>
+#include <sstream>
+#include <random>
+
+using namespace std;
+using sw::srecord;
+using sw::paged_image;
+typedef sw::srecord::address_type address_type;
+typedef sw::srecord::value_type value_type;
+typedef sw::srecord::size_type size_type;
+typedef sw::srecord::data_type data_type;
+
+/**
+ * @req: Unassigned addresses of a paged image shall read as the default value.
+ * @req: Byte access of a paged image shall be possible in the whole 32 bit address range.
+ */
+void test_byte_access()
+{
+  paged_image img(0xff);
+  test_expect( img.empty() );
+  test_expect( img.get(0x1234) == 0xff );
+  test_expect( !img.assigned(0x1234) );
+  img.set(0x1234, 0x55);
+  img.set(0xfffffffful, 0xaa);
+  img.set(0x100000000ull, 0x11); // out of range, ignored
+  test_expect( img.get(0x1234) == 0x55 );
+  test_expect( img.assigned(0x1234) );
+  test_expect( img.get(0x1235) == 0xff );
+  test_expect( img.get(0xfffffffful) == 0xaa );
+  test_expect( img.get(0x100000000ull) == 0xff );
+  test_expect( img.pages() == 2 );
+  test_expect( img.size() == 2 );
+  img.default_value(0x00);
+  test_expect( img.get(0x1235) == 0x00 );
+  test_expect( img.blocks().size() == 2 );
+  test_expect( img.blocks().front().sadr() == 0x1234 );
+  test_expect( img.blocks().back().sadr() == 0xfffffffful );
+}
+
+/**
+ * @req: The blocks of a paged image shall be identical to the blocks of a record with the same assigned ranges.
+ * @req: Removing ranges from a paged image shall release unused pages.
+ */
+void test_ranges()
+{
+  std::mt19937 rnd(0x9a6e);
+  srecord rec;
+  paged_image img;
+  for(unsigned n=0; n<2000; ++n) {
+    const address_type adr = (address_type(rnd()) & 0xfffff000ul) | (rnd() % 0x3000);
+    data_type data(1 + (rnd() % ((n % 10) ? 64 : 10000)));
+    for(auto& e: data) e = value_type(rnd());
+    if(adr + data.size() > 0x100000000ull) continue;
+    if(n % 7) {
+      rec.set_range(adr, data);
+      img.set_range(adr, data);
+    } else {
+      rec.remove_range(adr, adr+data.size());
+      img.remove_range(adr, adr+data.size());
+    }
+  }
+  const srecord& crec = rec;
+  test_expect( img.blocks() == crec.blocks() );
+  test_expect( img.srecord().blocks() == crec.blocks() );
+  {
+    size_type n = 0;
+    for(const auto& e: crec.blocks()) n += e.size();
+    test_expect( img.size() == n );
+  }
+  {
+    const auto& blk = crec.blocks()[crec.blocks().size()/2];
+    const address_type sadr = blk.sadr() - 3, eadr = blk.eadr() + 5;
+    test_expect( img.get_range(sadr, eadr, 0x77) == rec.get_range(sadr, eadr, 0x77) );
+  }
+  img.remove_range(0, 0x100000000ull);
+  test_expect( img.empty() );
+  test_expect( img.pages() == 0 );
+  test_expect( img.blocks().empty() );
+}
+
+/**
+ * @req: A paged image shall be constructible from a record, and compose the same output.
+ * @req: Copies of a paged image shall be independent.
+ * @req: A moved-from paged image shall be a valid empty image.
+ */
+void test_record_conversion()
+{
+  srecord rec;
+  rec.header_str("paged");
+  rec.type(srecord::type_s3_32bit);
+  rec.start_address_definition(0x20000000ul);
+  rec.set_range(0x20000000ul, data_type(5000, 0x12));
+  rec.set_range(0x08000000ul, data_type(300, 0x34));
+  paged_image img(rec);
+  test_expect( img.settings().header_str() == "paged" );
+  {
+    std::stringstream ss;
+    test_expect( img.compose(ss) );
+    test_expect( ss.str() == rec.compose() );
+  }
+  paged_image copy = img;
+  copy.fill(0x08000000ul+300, 0x08000000ul+400, 0x56);
+  test_expect( copy.blocks().size() == 2 );
+  test_expect( copy.blocks().front().size() == 400 );
+  test_expect( img.blocks().front().size() == 300 );
+  paged_image empty_image;
+  std::stringstream ss;
+  test_expect( !empty_image.compose(ss) );
+  test_expect( empty_image.settings().error() == srecord::e_validate_no_binary_data );
+  paged_image moved(std::move(copy));
+  test_expect( moved.blocks().front().size() == 400 );
+  test_expect( copy.empty() && copy.blocks().empty() );
+  test_expect( copy.get(0x08000000ul) == 0x00 );
+  copy.set(0x08000000ul, 0x78);
+  test_expect( copy.get(0x08000000ul) == 0x78 );
+  empty_image = std::move(moved);
+  test_expect( empty_image.blocks().size() == 2 );
+  test_expect( moved.empty() && !moved.assigned(0x08000000ul) );
+  moved.set_range(0x100, data_type(4, 0x9a));
+  test_expect( moved.blocks().size() == 1 );
+}
+
+/**
+ * @req: A fork of a paged image shall share all pages with the original.
+ * @req: Modifications of a fork or the original shall only duplicate the modified pages, and not affect the other image.
+ */
+void test_fork()
+{
+  std::mt19937 rnd(0xf04c);
+  paged_image base(0xff);
+  data_type data(64*paged_image::page_size);
+  for(auto& e: data) e = value_type(rnd());
+  base.set_range(0x08000000ul, data);
+  base.set_range(0x20000000ul, data_type(100, 0x11));
+  const size_type pages = base.pages();
+  test_expect( base.shared_pages() == 0 );
+  const srecord::block_container_type blocks = base.blocks();
+  paged_image variant = base.fork();
+  test_expect( variant.pages() == pages );
+  test_expect( variant.shared_pages() == pages );
+  test_expect( base.shared_pages() == pages );
+  test_expect( variant.blocks() == blocks );
+  variant.set(0x08000010ul, 0x00);
+  variant.set_range(0x08003000ul, data_type(4, 0x22));
+  variant.remove_range(0x20000000ul, 0x20000010ul);
+  test_expect( variant.shared_pages() == pages-3 );
+  test_expect( base.shared_pages() == pages-3 );
+  test_expect( variant.get(0x08000010ul) == 0x00 );
+  test_expect( variant.get(0x08003002ul) == 0x22 );
+  test_expect( !variant.assigned(0x20000000ul) );
+  test_expect( base.get(0x08000010ul) == data[0x10] );
+  test_expect( base.get(0x08003002ul) == data[0x3002] );
+  test_expect( base.assigned(0x20000000ul) );
+  test_expect( base.blocks() == blocks );
+  {
+    paged_image other = base.fork();
+    other.remove_range(0x08000000ul, 0x08000000ul + 2*paged_image::page_size);
+    test_expect( other.pages() == pages-2 );
+    other.fill(0x08000000ul, 0x08000004ul, 0x33);
+    test_expect( other.get(0x08000000ul) == 0x33 );
+    test_expect( base.get(0x08000000ul) == data[0] );
+  }
+  test_expect( base.shared_pages() == pages-3 );
+  variant.clear();
+  test_expect( base.shared_pages() == 0 );
+  test_expect( base.blocks() == blocks );
+  test_expect( base.srecord().get_range(0x08000000ul, 0x08000000ul+data.size()).bytes() == data );
+}
+
+void test(const vector<string>& args)
+{
+  (void)args;
+  test_expect_noexcept( test_byte_access() );
+  test_expect_noexcept( test_ranges() );
+  test_expect_noexcept( test_record_conversion() );
+  test_expect_noexcept( test_fork() );
+}
@@ -0,0 +1,166 @@
+/**
+ * @file test.cc
+ * @package de.atwillys.cc.swl
+ * @license BSD (simplified)
+ * @author Stefan Wilhelm (stfwi)
+ * -----------------------------------------------------------------------------
+ * Allocation counts of the modifying API, using a counting allocator
+ * via the container template parameter. Copies on the move paths show
+ * up as additional allocations.
+ */
+#include "testenv.hh"
+#include <sw/srecord.hh>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <list>
+
+using namespace std;
+
+namespace {
+
+  unsigned long allocation_count = 0;
+
+  template <typename T>
+  struct counting_allocator
+  {
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept
+    {}
+
+    T* allocate(size_t n)
+    { ++allocation_count; return static_cast<T*>(::operator new(n * sizeof(T))); }
+
+    void deallocate(T* p, size_t) noexcept
+    { ::operator delete(p); }
+
+    template <typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept
+    { return true; }
+
+    template <typename U>
+    bool operator!=(const counting_allocator<U>&) const noexcept
+    { return false; }
+  };
+
+  using srecord = sw::detail::basic_srecord<unsigned char, std::vector<unsigned char, counting_allocator<unsigned char>>>;
+  using data_type = srecord::data_type;
+  using block_type = srecord::block_type;
+
+  /**
+   * Returns the number of allocations of `fn()`.
+   */
+  template <typename Fn>
+  unsigned long allocations(Fn&& fn)
+  {
+    const unsigned long n = allocation_count;
+    fn();
+    return allocation_count - n;
+  }
+
+}
+
+/**
+ * @req: Setting moved data or blocks shall not copy the data.
+ * @req: Setting copied data shall allocate exactly once for the data.
+ */
+void test_set_range()
+{
+  srecord rec;
+  rec.blocks().reserve(16);
+  {
+    data_type data(1000, 0x11);
+    test_expect_eq( allocations([&]{ rec.set_range(0x1000, std::move(data)); }), 0ul );
+  }
+  {
+    block_type block(0x4000, data_type(100, 0x22));
+    test_expect_eq( allocations([&]{ rec.set_range(std::move(block)); }), 0ul );
+  }
+  {
+    const data_type data(10, 0x33);
+    test_expect_eq( allocations([&]{ rec.set_range(0x8000, data); }), 1ul );
+    test_expect_eq( allocations([&]{ rec.set_range(0x1010, data); }), 1ul ); // in place overwrite, only the temporary copy
+  }
+  {
+    const std::array<unsigned char, 4> data = {{1,2,3,4}};
+    test_expect_eq( allocations([&]{ rec.set_range(0x9000, data); }), 1ul );
+    const std::list<unsigned char> list(20, 0x44);
+    test_expect_eq( allocations([&]{ rec.set_range(0xa000, list); }), 1ul );
+    test_expect( rec.get_range(0xa000, 0xa014, 0).bytes() == data_type(20, 0x44) );
+    test_expect( rec.get_range(0x9000, 0x9004, 0).bytes() == (data_type{1,2,3,4}) );
+  }
+  {
+    block_type block(0, data_type());
+    data_type data(10, 0x55);
+    test_expect_eq( allocations([&]{ block.bytes(std::move(data)); }), 0ul );
+    test_expect( block.size() == 10 );
+  }
+  test_expect_eq( static_cast<const srecord&>(rec).blocks().size(), 5u );
+}
+
+/**
+ * @req: Joining and splitting blocks shall only allocate for the changed data.
+ */
+void test_modify()
+{
+  srecord rec;
+  rec.blocks().reserve(16);
+  rec.set_range(0x1000, data_type(100, 0x11));
+  rec.set_range(0x2000, data_type(100, 0x22));
+  test_expect_eq( allocations([&]{ rec.remove_range(0x1010, 0x1020); }), 1ul ); // split: the tail block
+  test_expect_eq( allocations([&]{ rec.remove_range(0x1000, 0x1010); }), 0ul );
+  test_expect_eq( allocations([&]{ rec.remove_range(0x2000, 0x2064); }), 0ul );
+  rec.set_range(0x2000, data_type(100, 0x22));
+  test_expect_eq( allocations([&]{ rec.merge(); }), 2ul ); // the merged data and the block container
+  test_expect_eq( static_cast<const srecord&>(rec).blocks().size(), 1u );
+}
+
+/**
+ * @req: Moving a record shall not allocate, copying shall allocate once per container.
+ */
+void test_record_move()
+{
+  srecord rec;
+  rec.header_str("move");
+  for(unsigned i=0; i<10; ++i) rec.set_range(0x1000*i, data_type(64, (unsigned char)i));
+  const size_t blocks = static_cast<const srecord&>(rec).blocks().size();
+  {
+    srecord moved;
+    test_expect_eq( allocations([&]{ srecord tmp(std::move(rec)); moved = std::move(tmp); }), 0ul );
+    test_expect( static_cast<const srecord&>(moved).blocks().size() == blocks );
+    test_expect( moved.header_str() == "move" );
+    test_expect( static_cast<const srecord&>(rec).blocks().empty() );
+    test_expect_eq( allocations([&]{ srecord copy(moved); }), 1ul + 1ul + blocks );
+    rec = std::move(moved);
+  }
+  test_expect( static_cast<const srecord&>(rec).blocks().size() == blocks );
+}
+
+/**
+ * @req: Parsing contiguous data records shall not allocate per line.
+ */
+void test_parse()
+{
+  srecord src;
+  src.set_range(0x1000, data_type(64*1000, 0x5a));
+  const string text = src.compose();
+  srecord rec;
+  const unsigned long n = allocations([&]{ rec.parse(text); });
+  test_note( "parse: " << n << " allocations for 1000 data lines" );
+  test_expect( n < 40 );
+  test_expect( static_cast<const srecord&>(rec).blocks() == static_cast<const srecord&>(src).blocks() );
+}
+
+void test(const vector<string>& args)
+{
+  (void)args;
+  test_expect_noexcept( test_set_range() );
+  test_expect_noexcept( test_modify() );
+  test_expect_noexcept( test_record_move() );
+  test_expect_noexcept( test_parse() );
+}